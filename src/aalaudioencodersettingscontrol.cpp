@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "aalaudioencodersettingscontrol.h"
+
+// The microphone is read from PulseAudio at the rate and channel count the
+// encoder is set to, so that neither side has to convert the samples. The
+// default is what the microphones of the devices deliver.
+const QString AalAudioEncoderSettingsControl::DEFAULT_CODEC = QString("AAC");
+const int AalAudioEncoderSettingsControl::DEFAULT_SAMPLE_RATE = 48000;
+const int AalAudioEncoderSettingsControl::DEFAULT_CHANNEL_COUNT = 1;
+const int AalAudioEncoderSettingsControl::DEFAULT_BIT_RATE = 64000;
+
+namespace {
+// The sample rates both PulseAudio and the AAC encoder support
+const int SAMPLE_RATES[] = { 8000, 16000, 22050, 32000, 44100, 48000 };
+}
+
+/*!
+ * \brief AalAudioEncoderSettingsControl::AalAudioEncoderSettingsControl
+ * \param parent
+ */
+AalAudioEncoderSettingsControl::AalAudioEncoderSettingsControl(QObject *parent)
+    : QAudioEncoderSettingsControl(parent)
+{
+    resetAllSettings();
+}
+
+/*!
+ * \reimp
+ */
+QAudioEncoderSettings AalAudioEncoderSettingsControl::audioSettings() const
+{
+    return m_settings;
+}
+
+/*!
+ * \reimp
+ */
+QString AalAudioEncoderSettingsControl::codecDescription(const QString &codecName) const
+{
+    return codecName;
+}
+
+/*!
+ * \reimp
+ * Values that are not set, or not supported, are left as they are
+ */
+void AalAudioEncoderSettingsControl::setAudioSettings(const QAudioEncoderSettings &settings)
+{
+    if (supportedAudioCodecs().contains(settings.codec()))
+        m_settings.setCodec(settings.codec());
+
+    if (settings.bitRate() > 0)
+        m_settings.setBitRate(settings.bitRate());
+
+    if (supportedSampleRates(settings).contains(settings.sampleRate()))
+        m_settings.setSampleRate(settings.sampleRate());
+
+    if (supportedChannelCounts().contains(settings.channelCount()))
+        m_settings.setChannelCount(settings.channelCount());
+}
+
+/*!
+ * \reimp
+ */
+QStringList AalAudioEncoderSettingsControl::supportedAudioCodecs() const
+{
+    QStringList codecs;
+    codecs << DEFAULT_CODEC;
+    return codecs;
+}
+
+/*!
+ * \reimp
+ */
+QList<int> AalAudioEncoderSettingsControl::supportedSampleRates(const QAudioEncoderSettings &settings,
+                                                                bool *continuous) const
+{
+    Q_UNUSED(settings);
+    if (continuous)
+        *continuous = false;
+
+    QList<int> rates;
+    for (unsigned i = 0; i < sizeof(SAMPLE_RATES) / sizeof(SAMPLE_RATES[0]); ++i)
+        rates << SAMPLE_RATES[i];
+    return rates;
+}
+
+/*!
+ * \brief AalAudioEncoderSettingsControl::supportedChannelCounts returns the
+ * channel counts audio can be recorded with: mono or stereo
+ */
+QList<int> AalAudioEncoderSettingsControl::supportedChannelCounts() const
+{
+    QList<int> counts;
+    counts << 1 << 2;
+    return counts;
+}
+
+/*!
+ * \brief AalAudioEncoderSettingsControl::resetAllSettings
+ */
+void AalAudioEncoderSettingsControl::resetAllSettings()
+{
+    m_settings.setCodec(DEFAULT_CODEC);
+    m_settings.setBitRate(DEFAULT_BIT_RATE);
+    m_settings.setSampleRate(DEFAULT_SAMPLE_RATE);
+    m_settings.setChannelCount(DEFAULT_CHANNEL_COUNT);
+}
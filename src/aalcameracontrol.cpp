@@ -17,7 +17,10 @@
 #include "aalcameracontrol.h"
 #include "aalcameraservice.h"
 #include "aalmediarecordercontrol.h"
+#include "cameraproperties.h"
+#include "haleventqueue.h"
 
+#include <QDebug>
 #include <QtGui/QGuiApplication>
 
 #include <hybris/camera/camera_compatibility_layer.h>
@@ -28,12 +31,24 @@ AalCameraControl::AalCameraControl(AalCameraService *service, QObject *parent)
     m_state(QCamera::UnloadedState),
     m_status(QCamera::UnloadedStatus),
     m_captureMode(QCamera::CaptureStillImage),
-    m_restoreStateWhenApplicationActive(false)
+    m_restoreStateWhenApplicationActive(false),
+    m_resumeWarm(false),
+    m_resumeLatency(-1)
 {
+    // How long the camera stays connected while the application is in the
+    // background, so that coming back quickly doesn't reconnect it
+    m_standbyTimer.setSingleShot(true);
+    m_standbyTimer.setInterval(CameraProperties::intValue("aal.camera.standby_timeout", 5000));
+    connect(&m_standbyTimer, &QTimer::timeout, this, &AalCameraControl::releaseCamera);
+
     QGuiApplication* application = qobject_cast<QGuiApplication*>(QGuiApplication::instance());
     m_previousApplicationState = application->applicationState();
     connect(application, &QGuiApplication::applicationStateChanged,
             this, &AalCameraControl::onApplicationStateChanged);
+    connect(m_service, &AalCameraService::cameraConnected,
+            this, &AalCameraControl::onCameraConnected);
+    connect(m_service, &AalCameraService::previewStarted,
+            this, &AalCameraControl::onPreviewStarted);
 }
 
 AalCameraControl::~AalCameraControl()
@@ -51,47 +66,114 @@ void AalCameraControl::setState(QCamera::State state)
     // override it when the application is active with the value before the app
     // is suppended.
     m_restoreStateWhenApplicationActive = false;
+    m_standbyTimer.stop();
 
     doSetState(state);
 }
 
+/*!
+ * \brief AalCameraControl::doSetState changes the state right away, the status
+ * follows once the camera is actually connected and the viewfinder running.
+ * Connecting happens on the camera thread, see onCameraConnected().
+ */
 void AalCameraControl::doSetState(QCamera::State state)
 {
     if (m_state == state)
         return;
 
-    if (state == QCamera::ActiveState) {
-        bool ok = m_service->connectCamera();
-        if (!ok) {
-            Q_EMIT error(QCamera::ServiceMissingError, QLatin1String("Unable to connect to camera"));
-            return;
-        }
-        if (m_captureMode == QCamera::CaptureStillImage) {
-            m_service->enablePhotoMode();
-        } else {
-            m_service->enableVideoMode();
-        }
-        Q_EMIT captureModeChanged(m_captureMode);
-        m_service->startPreview();
-    } else if (state == QCamera::LoadedState) {
-        if (m_state == QCamera::UnloadedState) {
-            bool ok = m_service->connectCamera();
-            if (!ok) {
-                Q_EMIT error(QCamera::ServiceMissingError, QLatin1String("Unable to connect to camera"));
-                return;
-            }
-        } else {
-            m_service->stopPreview();
-        }
-    } else if (state == QCamera::UnloadedState) {
+    m_state = state;
+
+    if (state == QCamera::UnloadedState) {
         m_service->disconnectCamera();
+        setStatus(QCamera::UnloadedStatus);
+    } else if (!m_service->androidControl()) {
+        if (m_status != QCamera::LoadingStatus) {
+            setStatus(QCamera::LoadingStatus);
+            m_service->connectCameraAsync();
+        }
+    } else if (state == QCamera::ActiveState) {
+        startViewfinder();
+    } else {
+        m_service->stopPreview();
+        setStatus(QCamera::LoadedStatus);
     }
 
-    m_state = state;
     Q_EMIT stateChanged(m_state);
     m_service->updateCaptureReady();
 }
 
+/*!
+ * \brief AalCameraControl::reconnect connects to the camera again after it was
+ * disconnected to switch to another device. The statuses and the capture mode
+ * follow as when loading the camera, see onCameraConnected().
+ */
+void AalCameraControl::reconnect()
+{
+    if (m_state == QCamera::UnloadedState)
+        return;
+
+    setStatus(QCamera::LoadingStatus);
+    m_service->connectCameraAsync();
+    m_service->updateCaptureReady();
+}
+
+void AalCameraControl::setStatus(QCamera::Status status)
+{
+    if (m_status == status)
+        return;
+
+    m_status = status;
+    Q_EMIT statusChanged(m_status);
+}
+
+void AalCameraControl::startViewfinder()
+{
+    if (m_captureMode == QCamera::CaptureStillImage) {
+        m_service->enablePhotoMode();
+    } else {
+        m_service->enableVideoMode();
+    }
+    Q_EMIT captureModeChanged(m_captureMode);
+
+    setStatus(QCamera::StartingStatus);
+    m_service->startPreview();
+}
+
+void AalCameraControl::onCameraConnected(bool success)
+{
+    // The state was changed while connecting
+    if (m_status != QCamera::LoadingStatus)
+        return;
+
+    if (!success) {
+        m_state = QCamera::UnloadedState;
+        setStatus(QCamera::UnloadedStatus);
+        Q_EMIT stateChanged(m_state);
+        Q_EMIT error(QCamera::ServiceMissingError, QLatin1String("Unable to connect to camera"));
+        return;
+    }
+
+    setStatus(QCamera::LoadedStatus);
+    if (m_state == QCamera::ActiveState) {
+        startViewfinder();
+    }
+    m_service->updateCaptureReady();
+}
+
+void AalCameraControl::onPreviewStarted()
+{
+    if (m_state == QCamera::ActiveState && m_status == QCamera::StartingStatus) {
+        setStatus(QCamera::ActiveStatus);
+
+        if (m_resumeTimer.isValid()) {
+            m_resumeLatency = m_resumeTimer.elapsed();
+            m_resumeTimer.invalidate();
+            qDebug() << "Viewfinder resumed in" << m_resumeLatency << "ms"
+                     << (m_resumeWarm ? "from standby" : "after reconnecting");
+        }
+    }
+}
+
 QCamera::Status AalCameraControl::status() const
 {
     return m_status;
@@ -140,25 +222,63 @@ void AalCameraControl::init(CameraControl *control, CameraControlListener *liste
     listener->on_msg_error_cb = &AalCameraControl::errorCB;
 }
 
+/*!
+ * \brief AalCameraControl::resumeLatency returns how long it took, in ms, from
+ * the application becoming active again until the viewfinder was running, or
+ * -1 if the camera was not resumed yet
+ */
+int AalCameraControl::resumeLatency() const
+{
+    return m_resumeLatency;
+}
+
 void AalCameraControl::onApplicationStateChanged()
 {
     QGuiApplication* application = qobject_cast<QGuiApplication*>(QGuiApplication::instance());
-    Qt::ApplicationState applicationState = application->applicationState();
+    setApplicationState(application->applicationState());
+}
 
+/*!
+ * \brief AalCameraControl::setApplicationState puts the camera in standby when
+ * the application leaves the foreground: the preview is stopped, but the
+ * camera stays connected until the standby timeout expires. Coming back
+ * before that only restarts the preview.
+ */
+void AalCameraControl::setApplicationState(Qt::ApplicationState applicationState)
+{
     if (applicationState == Qt::ApplicationActive) {
+        m_standbyTimer.stop();
         if (m_restoreStateWhenApplicationActive) {
+            // Only a viewfinder coming back has a resume latency to measure
+            if (m_cameraStateWhenApplicationActive == QCamera::ActiveState) {
+                m_resumeWarm = m_service->androidControl() != 0;
+                m_resumeTimer.start();
+            }
             doSetState(m_cameraStateWhenApplicationActive);
         }
     } else if (m_previousApplicationState == Qt::ApplicationActive) {
         m_cameraStateWhenApplicationActive = m_state;
         m_restoreStateWhenApplicationActive = true;
-        m_service->mediaRecorderControl()->setState(QMediaRecorder::StoppedState);
-        doSetState(QCamera::UnloadedState);
+        if (m_service->isRecording()) {
+            m_service->mediaRecorderControl()->setState(QMediaRecorder::StoppedState);
+        }
+
+        if (m_state != QCamera::UnloadedState && m_standbyTimer.interval() > 0) {
+            doSetState(QCamera::LoadedState);
+            m_standbyTimer.start();
+        } else {
+            doSetState(QCamera::UnloadedState);
+        }
     }
 
     m_previousApplicationState = applicationState;
 }
 
+void AalCameraControl::releaseCamera()
+{
+    doSetState(QCamera::UnloadedState);
+}
+
 void AalCameraControl::handleError()
 {
     Q_EMIT error(QCamera::CameraError, QLatin1String("Unknown error in camera"));
@@ -166,7 +286,5 @@ void AalCameraControl::handleError()
 
 void AalCameraControl::errorCB(void *context)
 {
-    Q_UNUSED(context);
-    QMetaObject::invokeMethod(AalCameraService::instance()->cameraControl(),
-                              "handleError", Qt::QueuedConnection);
+    static_cast<AalCameraService*>(context)->halEvents()->post(HalEventQueue::ErrorEvent);
 }
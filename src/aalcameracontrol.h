@@ -18,6 +18,8 @@
 #define AALCAMERACONTROL_H
 
 #include <QCameraControl>
+#include <QElapsedTimer>
+#include <QTimer>
 
 class AalCameraService;
 struct CameraControl;
@@ -41,6 +43,9 @@ public:
 
     bool canChangeProperty(PropertyChangeType changeType, QCamera::Status status) const;
 
+    int resumeLatency() const;
+    void reconnect();
+
     static void errorCB(void* context);
 
 public Q_SLOTS:
@@ -58,11 +63,22 @@ private:
     bool m_restoreStateWhenApplicationActive;
     QCamera::State m_cameraStateWhenApplicationActive;
     Qt::ApplicationState m_previousApplicationState;
+    QTimer m_standbyTimer;
+    QElapsedTimer m_resumeTimer;
+    bool m_resumeWarm;
+    int m_resumeLatency;
 
     // Used as a slot but not declared as such to avoid problems with unit tests
     void onApplicationStateChanged();
+    void setApplicationState(Qt::ApplicationState applicationState);
+    void releaseCamera();
     // Used to bypass m_restoreStateWhenApplicationActive
     void doSetState(QCamera::State state);
+    void setStatus(QCamera::Status status);
+    void startViewfinder();
+    // Used as slots, connected to AalCameraService signals
+    void onCameraConnected(bool success);
+    void onPreviewStarted();
 };
 
 #endif
@@ -17,6 +17,7 @@
 #include "aalcameraexposurecontrol.h"
 #include "aalcameracontrol.h"
 #include "aalcameraservice.h"
+#include "halstatistics.h"
 
 #include <hybris/camera/camera_compatibility_layer.h>
 #include <hybris/camera/camera_compatibility_layer_capabilities.h>
@@ -40,22 +41,19 @@ AalCameraExposureControl::AalCameraExposureControl(AalCameraService *service, QO
 
 void AalCameraExposureControl::init(CameraControl *control, CameraControlListener *listener)
 {
+    Q_UNUSED(control);
     Q_UNUSED(listener);
 
     m_supportedExposureModes.clear();
-    android_camera_enumerate_supported_scene_modes(control, &AalCameraExposureControl::supportedSceneModesCallback, this);
+    Q_FOREACH (int sceneMode, m_service->capabilities().sceneModes) {
+        m_supportedExposureModes << m_androidToQtExposureModes[static_cast<SceneMode>(sceneMode)];
+    }
 
     setValue(QCameraExposureControl::ExposureMode, m_requestedExposureMode);
 
     Q_EMIT parameterRangeChanged(QCameraExposureControl::ExposureMode);
 }
 
-void AalCameraExposureControl::supportedSceneModesCallback(void *context, SceneMode sceneMode)
-{
-    AalCameraExposureControl *self = (AalCameraExposureControl*)context;
-    self->m_supportedExposureModes << self->m_androidToQtExposureModes[sceneMode];
-}
-
 bool AalCameraExposureControl::setValue(ExposureParameter parameter, const QVariant& value)
 {
     if (!value.isValid()) {
@@ -70,7 +68,10 @@ bool AalCameraExposureControl::setValue(ExposureParameter parameter, const QVari
 
         if (m_service->androidControl() != NULL && m_supportedExposureModes.contains(m_requestedExposureMode)) {
             SceneMode sceneMode = m_androidToQtExposureModes.key(m_requestedExposureMode);
-            android_camera_set_scene_mode(m_service->androidControl(), sceneMode);
+            m_service->setCameraParameter(AalCameraService::SceneModeParameter,
+                                          [sceneMode](CameraControl *cc) {
+                AAL_HAL_CALL(android_camera_set_scene_mode(cc, sceneMode));
+            });
             m_actualExposureMode = m_requestedExposureMode;
             Q_EMIT actualValueChanged(QCameraExposureControl::ExposureMode);
             return true;
@@ -132,6 +133,8 @@ QVariantList AalCameraExposureControl::supportedParameterRange(ExposureParameter
         *continuous = false;
     }
 
+    m_service->ensureDeferredInit();
+
     if (parameter == QCameraExposureControl::ExposureMode) {
         QVariantList supported;
         Q_FOREACH(QCameraExposure::ExposureMode mode, m_supportedExposureModes) {
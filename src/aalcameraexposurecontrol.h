@@ -39,8 +39,6 @@ public:
     bool isParameterSupported(ExposureParameter parameter) const;
     QVariantList supportedParameterRange(ExposureParameter parameter, bool *continuous) const;
 
-    static void supportedSceneModesCallback(void *context, SceneMode sceneMode);
-
 private:
     QMap<SceneMode, QCameraExposure::ExposureMode> m_androidToQtExposureModes;
     AalCameraService *m_service;
@@ -17,6 +17,7 @@
 #include "aalcameraflashcontrol.h"
 #include "aalcameracontrol.h"
 #include "aalcameraservice.h"
+#include "halstatistics.h"
 
 #include <QDebug>
 
@@ -37,6 +38,7 @@ QCameraExposure::FlashModes AalCameraFlashControl::flashMode() const
 
 bool AalCameraFlashControl::isFlashModeSupported(QCameraExposure::FlashModes mode) const
 {
+    m_service->ensureDeferredInit();
     return m_supportedModes.isEmpty() || m_supportedModes.contains(mode);
 }
 
@@ -47,23 +49,32 @@ bool AalCameraFlashControl::isFlashReady() const
 
 void AalCameraFlashControl::setFlashMode(QCameraExposure::FlashModes mode)
 {
-    if (mode == m_currentMode || !isFlashModeSupported(mode))
+    // The mode is applied by init() if the flash is not set up yet
+    if (mode == m_currentMode || (!m_supportedModes.isEmpty() && !m_supportedModes.contains(mode)))
         return;
 
     FlashMode fmode = qt2Android(mode);
     m_currentMode = mode;
 
     if (m_service->androidControl()) {
-        android_camera_set_flash_mode(m_service->androidControl(), fmode);
+        m_service->setCameraParameter(AalCameraService::FlashModeParameter,
+                                      [fmode](CameraControl *cc) {
+            AAL_HAL_CALL(android_camera_set_flash_mode(cc, fmode));
+        });
     }
 }
 
 void AalCameraFlashControl::init(CameraControl *control)
 {
-    querySupportedFlashModes(control);
+    Q_UNUSED(control);
+
+    querySupportedFlashModes();
 
     FlashMode mode = qt2Android(m_currentMode);
-    android_camera_set_flash_mode(control, mode);
+    m_service->setCameraParameter(AalCameraService::FlashModeParameter,
+                                  [mode](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_set_flash_mode(cc, mode));
+    });
 
     Q_EMIT flashReady(true);
 }
@@ -103,16 +114,12 @@ QCameraExposure::FlashModes AalCameraFlashControl::android2Qt(FlashMode mode)
  * \brief AalCameraFlashControl::querySupportedFlashModes gets the supported
  * flash modes for the current camera
  */
-void AalCameraFlashControl::querySupportedFlashModes(CameraControl *control)
+void AalCameraFlashControl::querySupportedFlashModes()
 {
     m_supportedModes.clear();
 
-    android_camera_enumerate_supported_flash_modes(control, &AalCameraFlashControl::supportedFlashModesCallback, this);
-}
-
-void AalCameraFlashControl::supportedFlashModesCallback(void *context, FlashMode flashMode)
-{
-    AalCameraFlashControl *self = (AalCameraFlashControl*)context;
-    self->m_supportedModes << self->android2Qt(flashMode);
+    Q_FOREACH (int flashMode, m_service->capabilities().flashModes) {
+        m_supportedModes << android2Qt(static_cast<FlashMode>(flashMode));
+    }
 }
 
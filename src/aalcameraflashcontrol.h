@@ -37,15 +37,13 @@ public:
     bool isFlashReady() const;
     void setFlashMode(QCameraExposure::FlashModes mode);
 
-    static void supportedFlashModesCallback(void *context, FlashMode flashMode);
-
 public Q_SLOTS:
     void init(CameraControl *control);
 
 private:
     FlashMode qt2Android(QCameraExposure::FlashModes mode);
     QCameraExposure::FlashModes android2Qt(FlashMode mode);
-    void querySupportedFlashModes(CameraControl *control);
+    void querySupportedFlashModes();
 
     AalCameraService *m_service;
     QCameraExposure::FlashModes m_currentMode;
@@ -17,6 +17,8 @@
 #include "aalcamerafocuscontrol.h"
 #include "aalcameracontrol.h"
 #include "aalcameraservice.h"
+#include "haleventqueue.h"
+#include "halstatistics.h"
 
 #include <QDebug>
 #include <QTimer>
@@ -90,8 +92,14 @@ void AalCameraFocusControl::setCustomFocusPoint(const QPointF &point)
     Q_EMIT customFocusPointChanged(m_focusPoint);
 
     if (m_service->androidControl()) {
-        android_camera_set_metering_region(m_service->androidControl(), &meteringRegion);
-        android_camera_set_focus_region(m_service->androidControl(), &m_focusRegion);
+        FocusRegion focusRegion = m_focusRegion;
+        m_service->setCameraParameter(AalCameraService::FocusRegionParameter,
+                                      [meteringRegion, focusRegion](CameraControl *cc) {
+            MeteringRegion metering = meteringRegion;
+            FocusRegion focus = focusRegion;
+            AAL_HAL_CALL(android_camera_set_metering_region(cc, &metering));
+            AAL_HAL_CALL(android_camera_set_focus_region(cc, &focus));
+        });
         startFocus();
     }
 }
@@ -106,7 +114,10 @@ void AalCameraFocusControl::setFocusMode(QCameraFocus::FocusModes mode)
     AutoFocusMode focusMode = qt2Android(mode);
     m_focusMode = mode;
     if (m_service->androidControl()) {
-        android_camera_set_auto_focus_mode(m_service->androidControl(), focusMode);
+        m_service->setCameraParameter(AalCameraService::FocusModeParameter,
+                                      [focusMode](CameraControl *cc) {
+            AAL_HAL_CALL(android_camera_set_auto_focus_mode(cc, focusMode));
+        });
     }
 
     Q_EMIT focusModeChanged(m_focusMode);
@@ -123,10 +134,13 @@ void AalCameraFocusControl::setFocusPointMode(QCameraFocus::FocusPointMode mode)
 
 void AalCameraFocusControl::focusCB(void *context)
 {
-    Q_UNUSED(context);
-    AalCameraService::instance()->focusControl()->m_focusRunning = false;
-    QMetaObject::invokeMethod(AalCameraService::instance(),
-                              "updateCaptureReady", Qt::QueuedConnection);
+    static_cast<AalCameraService*>(context)->halEvents()->post(HalEventQueue::FocusEvent);
+}
+
+void AalCameraFocusControl::onFocusDone()
+{
+    m_focusRunning = false;
+    m_service->updateCaptureReady();
 }
 
 bool AalCameraFocusControl::isFocusBusy() const
@@ -152,10 +166,14 @@ void AalCameraFocusControl::enableVideoMode()
 
 void AalCameraFocusControl::init(CameraControl *control, CameraControlListener *listener)
 {
+    Q_UNUSED(control);
     listener->on_msg_focus_cb = &AalCameraFocusControl::focusCB;
 
     AutoFocusMode mode = qt2Android(m_focusMode);
-    android_camera_set_auto_focus_mode(control, mode);
+    m_service->setCameraParameter(AalCameraService::FocusModeParameter,
+                                  [mode](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_set_auto_focus_mode(cc, mode));
+    });
     m_focusRunning = false;
     m_service->updateCaptureReady();
 }
@@ -165,9 +183,14 @@ void AalCameraFocusControl::startFocus()
     if (!m_service->androidControl())
         return;
 
+    // The focus callback is only set up by init()
+    m_service->ensureDeferredInit();
     m_focusRunning = true;
     m_service->updateCaptureReady();
-    android_camera_start_autofocus(m_service->androidControl());
+    // Runs on the camera thread after the focus mode and region
+    m_service->sendCameraCommand([](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_start_autofocus(cc));
+    });
 }
 
 AutoFocusMode AalCameraFocusControl::qt2Android(QCameraFocus::FocusModes mode)
@@ -51,6 +51,9 @@ public Q_SLOTS:
     void init(CameraControl *control, CameraControlListener *listener);
     void startFocus();
 
+private Q_SLOTS:
+    void onFocusDone();
+
 private:
     AutoFocusMode qt2Android(QCameraFocus::FocusModes mode);
     QCameraFocus::FocusModes android2Qt(AutoFocusMode mode);
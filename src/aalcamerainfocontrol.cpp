@@ -16,7 +16,7 @@
 
 #include "aalcamerainfocontrol.h"
 
-#include <QCameraInfo>
+#include "cameradeviceregistry.h"
 
 AalCameraInfoControl::AalCameraInfoControl(QObject *parent) : QCameraInfoControl(parent)
 {
@@ -24,10 +24,10 @@ AalCameraInfoControl::AalCameraInfoControl(QObject *parent) : QCameraInfoControl
 
 QCamera::Position AalCameraInfoControl::cameraPosition(const QString &deviceName) const
 {
-    return QCameraInfo(deviceName.toLatin1()).position();
+    return CameraDeviceRegistry::position(CameraDeviceRegistry::indexOf(deviceName.toLatin1()));
 }
 
 int AalCameraInfoControl::cameraOrientation(const QString &deviceName) const
 {
-    return QCameraInfo(deviceName.toLatin1()).orientation();
+    return CameraDeviceRegistry::orientation(CameraDeviceRegistry::indexOf(deviceName.toLatin1()));
 }
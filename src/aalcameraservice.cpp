@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "aalaudioencodersettingscontrol.h"
 #include "aalcameracontrol.h"
 #include "aalcameraflashcontrol.h"
 #include "aalcamerafocuscontrol.h"
@@ -31,43 +32,100 @@
 #include "storagemanager.h"
 #include "aalcameraexposurecontrol.h"
 #include "rotationhandler.h"
+#include "framerategovernor.h"
+#include "cameraworker.h"
+#include "haleventqueue.h"
+#include "cameraproperties.h"
+#include "startuptimeline.h"
+#include "halstatistics.h"
+#include "tracebuffer.h"
 
 #include <hybris/camera/camera_compatibility_layer.h>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <cmath>
 
-AalCameraService *AalCameraService::m_service = 0;
-
 AalCameraService::AalCameraService(QObject *parent):
     QMediaService(parent),
+    m_audioEncoderControl(0),
+    m_imageCaptureControl(0),
+    m_mediaRecorderControl(0),
+    m_metadataWriter(0),
+    m_videoEncoderControl(0),
+    m_exposureControl(0),
     m_androidControl(0),
-    m_androidListener(0)
+    m_androidListener(0),
+    m_connectPending(false),
+    m_connectId(0),
+    m_deferredInitPending(false),
+    m_rotationHandler(0),
+    m_transactionDepth(0),
+    m_stagedPreviewRestart(false),
+    m_prewarmAfterCommit(false)
 {
-    m_service = this;
+    m_cameraWorker = new CameraWorker;
+    m_cameraWorker->moveToThread(&m_cameraThread);
+    connect(m_cameraWorker, &CameraWorker::connectFinished, this, [this](int connectId) {
+        // Ignore connections that were already taken over or discarded
+        if (m_connectPending && connectId == m_connectId) {
+            Q_EMIT cameraConnected(finishConnect());
+        }
+    });
+    connect(m_cameraWorker, &CameraWorker::previewStarted, this, &AalCameraService::previewStarted);
+    m_cameraThread.start();
+    StartupTimeline::mark("service: camera thread");
 
     m_storageManager = new StorageManager;
+    m_capabilityCache = new CameraCapabilityCache;
     m_cameraControl = new AalCameraControl(this);
     m_flashControl = new AalCameraFlashControl(this);
     m_focusControl = new AalCameraFocusControl(this);
     m_zoomControl = new AalCameraZoomControl(this);
-    m_imageCaptureControl = new AalImageCaptureControl(this);
+    StartupTimeline::mark("service: camera, flash, focus and zoom controls");
     m_imageEncoderControl = new AalImageEncoderControl(this);
-    m_mediaRecorderControl = new AalMediaRecorderControl(this);
-    m_metadataWriter = new AalMetaDataWriterControl(this);
     m_deviceSelectControl = new AalVideoDeviceSelectorControl(this);
-    m_videoEncoderControl = new AalVideoEncoderSettingsControl(this);
     m_videoOutput = new AalVideoRendererControl(this);
     m_viewfinderControl = new AalViewfinderSettingsControl(this);
-    m_exposureControl = new AalCameraExposureControl(this);
     m_infoControl = new AalCameraInfoControl(this);
-    m_rotationHandler = new RotationHandler(this);
+    StartupTimeline::mark("service: other controls");
+
+    m_halEvents = new HalEventQueue;
+    connect(m_halEvents, SIGNAL(previewFrame()), m_videoOutput, SLOT(updateViewfinderFrame()));
+    connect(m_halEvents, SIGNAL(focusDone()), m_focusControl, SLOT(onFocusDone()));
+    connect(m_halEvents, SIGNAL(error()), m_cameraControl, SLOT(handleError()));
+
+    // Queued, so that the first frame is shown before the rest is set up
+    connect(m_videoOutput, &AalVideoRendererControl::firstFramePresented,
+            this, &AalCameraService::ensureDeferredInit, Qt::QueuedConnection);
+
+    m_frameRateGovernor = new FrameRateGovernor(this);
+    connect(m_cameraControl, SIGNAL(stateChanged(QCamera::State)),
+            m_frameRateGovernor, SLOT(cameraStateChanged(QCamera::State)));
+    connect(m_cameraControl, SIGNAL(captureModeChanged(QCamera::CaptureModes)),
+            m_frameRateGovernor, SLOT(notifyActivity()));
+    connect(m_zoomControl, SIGNAL(currentDigitalZoomChanged(qreal)),
+            m_frameRateGovernor, SLOT(notifyActivity()));
+    StartupTimeline::mark("service: frame rate governor");
+
+    // The orientation sensor is only needed once there is a viewfinder to
+    // capture from, so don't let it delay the start of the camera
+    connect(m_cameraControl, &AalCameraControl::statusChanged, this, [this](QCamera::Status status) {
+        if (status == QCamera::ActiveStatus) {
+            rotationHandler();
+        }
+    });
 }
 
 AalCameraService::~AalCameraService()
 {
     disconnectCamera();
     m_cameraControl->setState(QCamera::UnloadedState);
+    m_cameraWorker->waitForIdle();
+    m_cameraThread.quit();
+    m_cameraThread.wait();
+    delete m_cameraWorker;
+    delete m_audioEncoderControl;
     delete m_cameraControl;
     delete m_flashControl;
     delete m_focusControl;
@@ -83,13 +141,27 @@ AalCameraService::~AalCameraService()
     delete m_exposureControl;
     delete m_infoControl;
     if (m_androidControl)
-        android_camera_delete(m_androidControl);
+        AAL_HAL_CALL(android_camera_delete(m_androidControl));
     delete m_storageManager;
+    delete m_capabilityCache;
     delete m_rotationHandler;
+    delete m_frameRateGovernor;
+    delete m_halEvents;
+
+#ifdef AAL_HAL_INSTRUMENTATION
+    qDebug().noquote() << HalStatistics::dump();
+#endif
+
+    QString traceFile = CameraProperties::stringValue("aal.camera.trace_file");
+    if (TraceBuffer::isEnabled() && !traceFile.isEmpty())
+        TraceBuffer::save(traceFile);
 }
 
 QMediaControl *AalCameraService::requestControl(const char *name)
 {
+    if (qstrcmp(name, QAudioEncoderSettingsControl_iid) == 0)
+        return audioEncoderControl();
+
     if (qstrcmp(name, QCameraControl_iid) == 0)
         return m_cameraControl;
 
@@ -100,16 +172,16 @@ QMediaControl *AalCameraService::requestControl(const char *name)
         return m_focusControl;
 
     if (qstrcmp(name, QCameraImageCaptureControl_iid) == 0)
-        return m_imageCaptureControl;
+        return imageCaptureControl();
 
     if (qstrcmp(name, QImageEncoderControl_iid) == 0)
         return m_imageEncoderControl;
 
     if (qstrcmp(name, QMediaRecorderControl_iid) == 0)
-        return m_mediaRecorderControl;
+        return mediaRecorderControl();
 
     if (qstrcmp(name, QMetaDataWriterControl_iid) == 0)
-        return m_metadataWriter;
+        return metadataWriterControl();
 
     if (qstrcmp(name, QCameraZoomControl_iid) == 0)
         return m_zoomControl;
@@ -118,7 +190,7 @@ QMediaControl *AalCameraService::requestControl(const char *name)
         return m_deviceSelectControl;
 
     if (qstrcmp(name, QVideoEncoderSettingsControl_iid) == 0)
-        return m_videoEncoderControl;
+        return videoEncoderControl();
 
     if (qstrcmp(name, QVideoRendererControl_iid) == 0)
         return m_videoOutput;
@@ -127,7 +199,7 @@ QMediaControl *AalCameraService::requestControl(const char *name)
         return m_viewfinderControl;
 
     if (qstrcmp(name, QCameraExposureControl_iid) == 0)
-        return m_exposureControl;
+        return exposureControl();
 
     if (qstrcmp(name, QCameraInfoControl_iid) == 0)
         return m_infoControl;
@@ -140,6 +212,104 @@ void AalCameraService::releaseControl(QMediaControl *control)
     Q_UNUSED(control);
 }
 
+AalAudioEncoderSettingsControl *AalCameraService::audioEncoderControl()
+{
+    if (!m_audioEncoderControl) {
+        QElapsedTimer timer;
+        timer.start();
+        m_audioEncoderControl = new AalAudioEncoderSettingsControl(this);
+        recordConstructionTime(QAudioEncoderSettingsControl_iid, timer);
+    }
+    return m_audioEncoderControl;
+}
+
+AalImageCaptureControl *AalCameraService::imageCaptureControl()
+{
+    if (!m_imageCaptureControl) {
+        QElapsedTimer timer;
+        timer.start();
+        m_imageCaptureControl = new AalImageCaptureControl(this);
+        connect(m_imageCaptureControl, SIGNAL(readyForCaptureChanged(bool)),
+                m_frameRateGovernor, SLOT(notifyActivity()));
+        connect(m_halEvents, SIGNAL(shutter()), m_imageCaptureControl, SLOT(shutter()));
+        connect(m_halEvents, SIGNAL(compressedImage(QByteArray)),
+                m_imageCaptureControl, SLOT(saveJpeg(QByteArray)));
+        if (m_androidControl && !m_deferredInitPending) {
+            m_imageCaptureControl->init(m_androidControl, m_androidListener);
+        }
+        recordConstructionTime(QCameraImageCaptureControl_iid, timer);
+        updateCaptureReady();
+    }
+    return m_imageCaptureControl;
+}
+
+AalMediaRecorderControl *AalCameraService::mediaRecorderControl()
+{
+    if (!m_mediaRecorderControl) {
+        QElapsedTimer timer;
+        timer.start();
+        m_mediaRecorderControl = new AalMediaRecorderControl(this);
+        recordConstructionTime(QMediaRecorderControl_iid, timer);
+    }
+    return m_mediaRecorderControl;
+}
+
+AalMetaDataWriterControl *AalCameraService::metadataWriterControl()
+{
+    if (!m_metadataWriter) {
+        QElapsedTimer timer;
+        timer.start();
+        m_metadataWriter = new AalMetaDataWriterControl(this);
+        recordConstructionTime(QMetaDataWriterControl_iid, timer);
+    }
+    return m_metadataWriter;
+}
+
+AalVideoEncoderSettingsControl *AalCameraService::videoEncoderControl()
+{
+    if (!m_videoEncoderControl) {
+        QElapsedTimer timer;
+        timer.start();
+        m_videoEncoderControl = new AalVideoEncoderSettingsControl(this);
+        if (m_androidControl) {
+            m_videoEncoderControl->init(m_androidControl, m_androidListener);
+        }
+        recordConstructionTime(QVideoEncoderSettingsControl_iid, timer);
+    }
+    return m_videoEncoderControl;
+}
+
+AalCameraExposureControl *AalCameraService::exposureControl()
+{
+    if (!m_exposureControl) {
+        QElapsedTimer timer;
+        timer.start();
+        m_exposureControl = new AalCameraExposureControl(this);
+        if (m_androidControl && !m_deferredInitPending) {
+            m_exposureControl->init(m_androidControl, m_androidListener);
+        }
+        recordConstructionTime(QCameraExposureControl_iid, timer);
+    }
+    return m_exposureControl;
+}
+
+/*!
+ * \brief AalCameraService::constructionTime returns how long it took to build
+ * a control constructed on first use
+ * \param name interface name of the control, as passed to requestControl()
+ * \return the time in ns, or -1 if the control was not constructed yet
+ */
+qint64 AalCameraService::constructionTime(const char *name) const
+{
+    return m_constructionTimes.value(QByteArray(name), -1);
+}
+
+void AalCameraService::recordConstructionTime(const char *name, const QElapsedTimer &timer)
+{
+    m_constructionTimes.insert(QByteArray(name), timer.nsecsElapsed());
+    StartupTimeline::mark(QStringLiteral("service: %1").arg(QLatin1String(name)));
+}
+
 CameraControl *AalCameraService::androidControl()
 {
     return m_androidControl;
@@ -152,36 +322,81 @@ StorageManager *AalCameraService::storageManager()
 
 RotationHandler *AalCameraService::rotationHandler()
 {
+    if (!m_rotationHandler) {
+        m_rotationHandler = new RotationHandler(this);
+        StartupTimeline::mark("service: rotation handler (orientation sensor)");
+    }
     return m_rotationHandler;
 }
 
+FrameRateGovernor *AalCameraService::frameRateGovernor()
+{
+    return m_frameRateGovernor;
+}
+
 bool AalCameraService::connectCamera()
 {
     if (m_androidControl)
         return true;
 
-    m_androidListener = new CameraControlListener;
-    memset(m_androidListener, 0, sizeof(*m_androidListener));
+    connectCameraAsync();
+    m_cameraWorker->waitForIdle();
+    return finishConnect();
+}
+
+/*!
+ * \brief AalCameraService::connectCameraAsync connects to the camera on the
+ * camera thread, and emits cameraConnected() when done
+ */
+void AalCameraService::connectCameraAsync()
+{
+    if (m_androidControl || m_connectPending)
+        return;
+
+    m_connectPending = true;
 
     // if there is only one camera fallback directly to the ID of whatever device we have
+    int deviceId = -1;
+    CameraType device = BACK_FACING_CAMERA_TYPE;
     if (m_deviceSelectControl->deviceCount() == 1) {
-        m_androidControl = android_camera_connect_by_id(m_deviceSelectControl->selectedDevice(), m_androidListener);
-    } else {
-        CameraType device = BACK_FACING_CAMERA_TYPE;
-        if (!isBackCameraUsed()) {
-            device = FRONT_FACING_CAMERA_TYPE;
-        }
-
-        m_androidControl = android_camera_connect_to(device, m_androidListener);
+        deviceId = m_deviceSelectControl->selectedDevice();
+    } else if (!isBackCameraUsed()) {
+        device = FRONT_FACING_CAMERA_TYPE;
     }
 
-    if (!m_androidControl) {
-        delete m_androidListener;
-        m_androidListener = 0;
+    // The capabilities are probed on the camera thread too, as querying the
+    // HAL for them is slow when they are not cached yet
+    CameraCapabilityCache *capabilityCache = m_capabilityCache;
+    int selectedDevice = m_deviceSelectControl->selectedDevice();
+    m_connectId = m_cameraWorker->connectCamera(deviceId, device,
+                                                [capabilityCache, selectedDevice](CameraControl *control) {
+        return capabilityCache->capabilities(selectedDevice, control);
+    });
+}
+
+/*!
+ * \brief AalCameraService::finishConnect takes over the camera connected on
+ * the camera thread and initializes the controls for it
+ * \return true if the camera is connected
+ */
+bool AalCameraService::finishConnect()
+{
+    m_connectPending = false;
+
+    CameraControl *control = 0;
+    CameraControlListener *listener = 0;
+    CameraCapabilities capabilities;
+    if (!m_cameraWorker->takeConnection(m_connectId, &control, &listener, &capabilities))
+        return m_androidControl != 0;
+
+    if (!control)
         return false;
-    }
 
-    m_androidListener->context = m_androidControl;
+    m_androidControl = control;
+    m_androidListener = listener;
+    // The HAL callbacks find the service, and through it their control, in the context
+    m_androidListener->context = this;
+    m_capabilities = capabilities;
     initControls(m_androidControl, m_androidListener);
 
     return true;
@@ -189,21 +404,31 @@ bool AalCameraService::connectCamera()
 
 void AalCameraService::disconnectCamera()
 {
-    if (m_imageCaptureControl->isCaptureRunning()) {
+    if (m_imageCaptureControl && m_imageCaptureControl->isCaptureRunning()) {
         m_imageCaptureControl->cancelCapture();
     }
 
+    // The camera has to be locked again before it is disconnected
+    if (m_mediaRecorderControl) {
+        m_mediaRecorderControl->waitForFinalization();
+        m_mediaRecorderControl->releasePrewarmed();
+    }
+
     stopPreview();
 
-    if (m_androidControl) {
-        android_camera_disconnect(m_androidControl);
-        m_androidControl = 0;
+    if (m_connectPending) {
+        m_connectPending = false;
+        m_cameraWorker->discardConnection(m_connectId);
     }
 
-    if (m_androidListener) {
-        delete m_androidListener;
+    if (m_androidControl) {
+        m_cameraWorker->disconnectCamera(m_androidControl, m_androidListener);
+        m_androidControl = 0;
         m_androidListener = 0;
     }
+    m_deferredInitPending = false;
+
+    m_capabilities = CameraCapabilities();
 }
 
 void AalCameraService::startPreview()
@@ -242,24 +467,44 @@ bool AalCameraService::isBackCameraUsed() const
 }
 
 /*!
- * \brief AalCameraService::enablePhotoMode sets all controls into photo mode
+ * \brief AalCameraService::enablePhotoMode sets all controls into photo mode.
+ * Before the deferred part of the initialization is done, the switch is left
+ * to it.
  */
 void AalCameraService::enablePhotoMode()
 {
-    m_flashControl->init(m_service->androidControl());
+    if (m_deferredInitPending)
+        return;
+
+    beginParameterTransaction();
+    m_flashControl->init(m_androidControl);
     m_imageEncoderControl->enablePhotoMode();
     m_focusControl->enablePhotoMode();
     m_viewfinderControl->setAspectRatio(m_imageEncoderControl->getAspectRatio());
+    commitParameterTransaction();
+
+    if (m_mediaRecorderControl)
+        m_mediaRecorderControl->releasePrewarmed();
 }
 
 /*!
- * \brief AalCameraService::enableVideoMode sets all controls into video mode
+ * \brief AalCameraService::enableVideoMode sets all controls into video mode.
+ * Before the deferred part of the initialization is done, the switch is left
+ * to it.
  */
 void AalCameraService::enableVideoMode()
 {
-    m_flashControl->init(m_service->androidControl());
+    if (m_deferredInitPending)
+        return;
+
+    beginParameterTransaction();
+    m_flashControl->init(m_androidControl);
     m_focusControl->enableVideoMode();
-    m_viewfinderControl->setAspectRatio(m_videoEncoderControl->getAspectRatio());
+    m_viewfinderControl->setAspectRatio(videoEncoderControl()->getAspectRatio());
+    // The recorder is prepared with the video mode parameters, so only once
+    // they are applied, if aal.camera.prewarm_recorder is set
+    m_prewarmAfterCommit = true;
+    commitParameterTransaction();
 }
 
 /*!
@@ -269,11 +514,119 @@ void AalCameraService::enableVideoMode()
  */
 bool AalCameraService::isRecording() const
 {
-    return m_mediaRecorderControl->state() != QMediaRecorder::StoppedState;
+    return m_mediaRecorderControl && m_mediaRecorderControl->state() != QMediaRecorder::StoppedState;
+}
+
+/*!
+ * \brief AalCameraService::beginParameterTransaction starts staging camera
+ * parameters instead of sending them to the camera one by one. Transactions
+ * can be nested, the parameters are applied when the outermost one is
+ * committed.
+ */
+void AalCameraService::beginParameterTransaction()
+{
+    ++m_transactionDepth;
+}
+
+/*!
+ * \brief AalCameraService::commitParameterTransaction applies all the parameters
+ * staged since beginParameterTransaction(), restarting the preview at most once,
+ * then sends the staged commands and pre-warms the recorder if enableVideoMode()
+ * asked for it
+ */
+void AalCameraService::commitParameterTransaction()
+{
+    Q_ASSERT(m_transactionDepth > 0);
+    if (--m_transactionDepth > 0)
+        return;
+
+    QList<StagedParameter> parameters;
+    parameters.swap(m_stagedParameters);
+    bool needsPreviewRestart = m_stagedPreviewRestart;
+    m_stagedPreviewRestart = false;
+    QList<ParameterSetter> commands;
+    commands.swap(m_stagedCommands);
+
+    if (m_androidControl && !parameters.isEmpty()) {
+        bool restartPreview = needsPreviewRestart && isPreviewStarted();
+        if (restartPreview) {
+            stopPreview();
+        }
+
+        // The preview is stopped and started on the camera thread, so the
+        // parameters are always applied there too, in the order they were staged
+        CameraControl *control = m_androidControl;
+        m_cameraWorker->post([parameters, control]() {
+            Q_FOREACH (const StagedParameter &parameter, parameters) {
+                parameter.second(control);
+            }
+        });
+
+        if (restartPreview) {
+            startPreview();
+        }
+    }
+
+    if (m_androidControl && !commands.isEmpty()) {
+        CameraControl *control = m_androidControl;
+        m_cameraWorker->post([commands, control]() {
+            Q_FOREACH (const ParameterSetter &command, commands) {
+                command(control);
+            }
+        });
+    }
+
+    if (m_prewarmAfterCommit) {
+        m_prewarmAfterCommit = false;
+        if (m_androidControl)
+            mediaRecorderControl()->prewarm();
+    }
+}
+
+/*!
+ * \brief AalCameraService::setCameraParameter sends a parameter to the camera,
+ * or stages it if a transaction is running. Staging the same parameter again
+ * drops the previous value, so only the last one reaches the camera.
+ * The parameters are applied on the camera thread.
+ * \param parameter which parameter is set
+ * \param setter function setting the parameter on the camera
+ * \param needsPreviewRestart true if the preview has to be stopped while the
+ * parameter is changed
+ */
+void AalCameraService::setCameraParameter(CameraParameter parameter, const ParameterSetter &setter,
+                                          bool needsPreviewRestart)
+{
+    beginParameterTransaction();
+    for (int i = 0; i < m_stagedParameters.size(); ++i) {
+        if (m_stagedParameters.at(i).first == parameter) {
+            m_stagedParameters.removeAt(i);
+            break;
+        }
+    }
+    m_stagedParameters.append(qMakePair(parameter, setter));
+    m_stagedPreviewRestart = m_stagedPreviewRestart || needsPreviewRestart;
+    commitParameterTransaction();
+}
+
+/*!
+ * \brief AalCameraService::sendCameraCommand sends a one-shot command, like
+ * starting the auto focus or taking a picture, to the camera. The command runs
+ * on the camera thread after all the parameters sent before it, so it is not
+ * needed to wait for them. Inside a transaction it is sent on commit.
+ * \param command function running the command on the camera
+ */
+void AalCameraService::sendCameraCommand(const ParameterSetter &command)
+{
+    beginParameterTransaction();
+    m_stagedCommands.append(command);
+    commitParameterTransaction();
 }
 
 void AalCameraService::updateCaptureReady()
 {
+    if (!m_imageCaptureControl)
+        return;
+
     bool ready = true;
 
     if (!(m_cameraControl->state() == QCamera::ActiveState))
@@ -289,39 +642,85 @@ void AalCameraService::updateCaptureReady()
 }
 
 /*!
- * \brief AalCameraService::initControls initialize all the controls for a newly
- * connected camera
+ * \brief AalCameraService::initControls initialize the controls needed to show
+ * the viewfinder of a newly connected camera. The other controls are set up
+ * by ensureDeferredInit() once the first frame is presented.
  * \param camControl
  * \param listener
  */
 void AalCameraService::initControls(CameraControl *camControl, CameraControlListener *listener)
 {
+    beginParameterTransaction();
     m_cameraControl->init(camControl, listener);
+    StartupTimeline::mark("initControls: camera");
     m_videoOutput->init(camControl, listener);
+    StartupTimeline::mark("initControls: video output");
     m_viewfinderControl->init(camControl, listener);
+    StartupTimeline::mark("initControls: viewfinder");
+
+    // The viewfinder size follows the aspect ratio of the picture or video size
     m_imageEncoderControl->init(camControl);
-    m_imageCaptureControl->init(camControl, listener);
-    m_flashControl->init(camControl);
-    m_focusControl->init(camControl, listener);
-    m_zoomControl->init(camControl, listener);
-    m_videoEncoderControl->init(camControl, listener);
-    m_exposureControl->init(camControl, listener);
+    StartupTimeline::mark("initControls: image encoder");
+    if (m_videoEncoderControl) {
+        m_videoEncoderControl->init(camControl, listener);
+        StartupTimeline::mark("initControls: video encoder");
+    }
+    if (m_cameraControl->captureMode() == QCamera::CaptureStillImage) {
+        m_viewfinderControl->setAspectRatio(m_imageEncoderControl->getAspectRatio());
+    } else {
+        m_viewfinderControl->setAspectRatio(videoEncoderControl()->getAspectRatio());
+    }
+    commitParameterTransaction();
+    StartupTimeline::mark("initControls: apply parameters");
+
+    m_deferredInitPending = true;
+}
+
+/*!
+ * \brief AalCameraService::ensureDeferredInit initializes the controls that are
+ * not needed to show the viewfinder, and applies the capture mode. It runs
+ * after the first viewfinder frame, or earlier when one of these controls is
+ * used before that.
+ */
+void AalCameraService::ensureDeferredInit()
+{
+    if (!m_deferredInitPending || !m_androidControl)
+        return;
+
+    // Cleared first, the controls may end up here again while being set up
+    m_deferredInitPending = false;
+
+    beginParameterTransaction();
+    if (m_imageCaptureControl) {
+        m_imageCaptureControl->init(m_androidControl, m_androidListener);
+    }
+    m_focusControl->init(m_androidControl, m_androidListener);
+    m_zoomControl->init(m_androidControl, m_androidListener);
+    if (m_exposureControl) {
+        m_exposureControl->init(m_androidControl, m_androidListener);
+    }
+
+    // Also initializes the flash
+    if (m_cameraControl->captureMode() == QCamera::CaptureStillImage) {
+        enablePhotoMode();
+    } else {
+        enableVideoMode();
+    }
+    commitParameterTransaction();
 }
 
 QSize AalCameraService::selectSizeWithAspectRatio(const QList<QSize> &sizes, float targetAspectRatio) const
 {
     QSize selectedSize;
     long selectedPixelCount = 0;
-    const float EPSILON = 0.02;
 
     if (!sizes.empty()) {
         // Loop over all sizes until we find the highest one that matches targetAspectRatio.
         QList<QSize>::const_iterator it = sizes.begin();
         while (it != sizes.end()) {
             QSize size = *it;
-            const float aspectRatio = (float)size.width() / (float)size.height();
             const long pixelCount = (long)size.width() * (long)size.height();
-            if (fabs(aspectRatio - targetAspectRatio) < EPSILON && pixelCount > selectedPixelCount) {
+            if (aspectRatioMatches(size, targetAspectRatio) && pixelCount > selectedPixelCount) {
                 selectedSize = size;
                 selectedPixelCount = pixelCount;
             }
@@ -331,3 +730,17 @@ QSize AalCameraService::selectSizeWithAspectRatio(const QList<QSize> &sizes, flo
 
     return selectedSize;
 }
+
+/*!
+ * \brief AalCameraService::aspectRatioMatches returns true if the aspect ratio
+ * of \a size is the same as \a targetAspectRatio, give or take rounding
+ */
+bool AalCameraService::aspectRatioMatches(const QSize &size, float targetAspectRatio) const
+{
+    const float EPSILON = 0.02;
+    if (size.height() <= 0)
+        return false;
+
+    const float aspectRatio = (float)size.width() / (float)size.height();
+    return fabs(aspectRatio - targetAspectRatio) < EPSILON;
+}
@@ -17,10 +17,20 @@
 #ifndef AALCAMERASERVICE_H
 #define AALCAMERASERVICE_H
 
+#include "cameracapabilitycache.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
 #include <QMediaService>
+#include <QPair>
 #include <QSize>
+#include <QThread>
 #include <QtMultimedia/QCamera>
 
+#include <functional>
+
+class AalAudioEncoderSettingsControl;
 class AalCameraControl;
 class AalCameraFlashControl;
 class AalCameraFocusControl;
@@ -36,17 +46,37 @@ class AalViewfinderSettingsControl;
 class AalCameraExposureControl;
 class AalCameraInfoControl;
 class QCameraControl;
+class QElapsedTimer;
 
 struct CameraControl;
 struct CameraControlListener;
 
 class StorageManager;
 class RotationHandler;
+class FrameRateGovernor;
+class CameraWorker;
+class HalEventQueue;
 
 class AalCameraService : public QMediaService
 {
 Q_OBJECT
 public:
+    /// Camera parameters that can be staged in a parameter transaction
+    enum CameraParameter {
+        PreviewSizeParameter,
+        PreviewFrameRateParameter,
+        PictureSizeParameter,
+        ThumbnailSizeParameter,
+        JpegQualityParameter,
+        FlashModeParameter,
+        FocusModeParameter,
+        SceneModeParameter,
+        FocusRegionParameter,
+        ZoomParameter,
+        RotationParameter
+    };
+    typedef std::function<void(CameraControl*)> ParameterSetter;
+
     AalCameraService(QObject *parent = 0);
     ~AalCameraService();
 
@@ -57,23 +87,32 @@ public:
     AalCameraFlashControl *flashControl() const { return m_flashControl; }
     AalCameraFocusControl *focusControl() const { return m_focusControl; }
     AalCameraZoomControl *zoomControl() const { return m_zoomControl; }
-    AalImageCaptureControl *imageCaptureControl() const { return m_imageCaptureControl; }
     AalImageEncoderControl *imageEncoderControl() const { return m_imageEncoderControl; }
-    AalMediaRecorderControl *mediaRecorderControl() const { return m_mediaRecorderControl; }
-    AalMetaDataWriterControl *metadataWriterControl() const { return m_metadataWriter; }
     AalVideoDeviceSelectorControl *deviceSelector() const { return m_deviceSelectControl; }
-    AalVideoEncoderSettingsControl *videoEncoderControl() const { return m_videoEncoderControl; }
     AalVideoRendererControl *videoOutputControl() const { return m_videoOutput; }
     AalViewfinderSettingsControl *viewfinderControl() const { return m_viewfinderControl; }
-    AalCameraExposureControl *exposureControl() const { return m_exposureControl; }
     AalCameraInfoControl *infoControl() const { return m_infoControl; }
 
+    // Constructed on first use
+    AalAudioEncoderSettingsControl *audioEncoderControl();
+    AalImageCaptureControl *imageCaptureControl();
+    AalMediaRecorderControl *mediaRecorderControl();
+    AalMetaDataWriterControl *metadataWriterControl();
+    AalVideoEncoderSettingsControl *videoEncoderControl();
+    AalCameraExposureControl *exposureControl();
+    qint64 constructionTime(const char *name) const;
+
     CameraControl *androidControl();
+    const CameraCapabilities &capabilities() const { return m_capabilities; }
 
     StorageManager *storageManager();
     RotationHandler *rotationHandler();
+    FrameRateGovernor *frameRateGovernor();
+    CameraWorker *cameraWorker() const { return m_cameraWorker; }
+    HalEventQueue *halEvents() const { return m_halEvents; }
 
     bool connectCamera();
+    void connectCameraAsync();
     void disconnectCamera();
     void startPreview();
     void stopPreview();
@@ -84,20 +123,31 @@ public:
 
     void enablePhotoMode();
     void enableVideoMode();
+    void ensureDeferredInit();
 
     bool isRecording() const;
+
+    void beginParameterTransaction();
+    void commitParameterTransaction();
+    void setCameraParameter(CameraParameter parameter, const ParameterSetter &setter,
+                            bool needsPreviewRestart = false);
+    void sendCameraCommand(const ParameterSetter &command);
     QSize selectSizeWithAspectRatio(const QList<QSize> &sizes, float targetAspectRatio) const;
+    bool aspectRatioMatches(const QSize &size, float targetAspectRatio) const;
 
-    static AalCameraService *instance() { return m_service; }
+Q_SIGNALS:
+    void cameraConnected(bool success);
+    void previewStarted();
 
 public Q_SLOTS:
     void updateCaptureReady();
 
 private:
+    bool finishConnect();
     void initControls(CameraControl *camControl, CameraControlListener *listener);
+    void recordConstructionTime(const char *name, const QElapsedTimer &timer);
 
-    static AalCameraService *m_service;
-
+    AalAudioEncoderSettingsControl *m_audioEncoderControl;
     AalCameraControl *m_cameraControl;
     AalCameraFlashControl *m_flashControl;
     AalCameraFocusControl *m_focusControl;
@@ -115,9 +165,26 @@ private:
 
     CameraControl *m_androidControl;
     CameraControlListener *m_androidListener;
+    CameraCapabilityCache *m_capabilityCache;
+    CameraCapabilities m_capabilities;
+    CameraWorker *m_cameraWorker;
+    HalEventQueue *m_halEvents;
+    QThread m_cameraThread;
+    bool m_connectPending;
+    int m_connectId;
+    bool m_deferredInitPending;
 
     StorageManager *m_storageManager;
     RotationHandler *m_rotationHandler;
+    FrameRateGovernor *m_frameRateGovernor;
+    QMap<QByteArray, qint64> m_constructionTimes;
+
+    typedef QPair<CameraParameter, ParameterSetter> StagedParameter;
+    int m_transactionDepth;
+    QList<StagedParameter> m_stagedParameters;
+    QList<ParameterSetter> m_stagedCommands;
+    bool m_stagedPreviewRestart;
+    bool m_prewarmAfterCommit;
 };
 
 #endif
@@ -16,26 +16,26 @@
 
 #include "aalcameraserviceplugin.h"
 #include "aalcameraservice.h"
+#include "cameradeviceregistry.h"
+#include "startuptimeline.h"
 
 #include <QByteArray>
 #include <QDebug>
 #include <QMetaType>
 #include <qgl.h>
 
-#include <hybris/properties/properties.h>
-#include <hybris/camera/camera_compatibility_layer.h>
-#include <hybris/camera/camera_compatibility_layer_capabilities.h>
-
-
 AalServicePlugin::AalServicePlugin()
 {
 }
 
 QMediaService* AalServicePlugin::create(QString const& key)
 {
-    if (key == QLatin1String(Q_MEDIASERVICE_CAMERA))
-        return new AalCameraService;
-    else
+    if (key == QLatin1String(Q_MEDIASERVICE_CAMERA)) {
+        StartupTimeline::start();
+        AalCameraService *service = new AalCameraService;
+        StartupTimeline::mark("plugin: create");
+        return service;
+    } else
         qWarning() << "Key not supported:" << key;
 
     return 0;
@@ -54,12 +54,8 @@ QList<QByteArray> AalServicePlugin::devices(const QByteArray &service) const
         return deviceList;
     }
 
-    // Devices are identified in android only by their index, so we do the same
-    int cameras = android_camera_get_number_of_devices();
-    for (int deviceId = 0; deviceId < cameras; deviceId++) {
-        QString camera("%1");
-        camera = camera.arg(deviceId);
-        deviceList.append(camera.toLatin1());
+    for (int deviceId = 0; deviceId < CameraDeviceRegistry::count(); deviceId++) {
+        deviceList.append(CameraDeviceRegistry::deviceName(deviceId));
     }
 
     return deviceList;
@@ -71,82 +67,20 @@ QString AalServicePlugin::deviceDescription(const QByteArray &service, const QBy
         return QString();
     }
 
-    // Android does not provice a descriptive identifier for devices, so we just
-    // send back the index plus some useful human readable information about position.
-    bool ok;
-    int deviceID = device.toInt(&ok, 10);
-    if (!ok || deviceID >= android_camera_get_number_of_devices()) {
+    int deviceID = CameraDeviceRegistry::indexOf(device);
+    if (deviceID == -1) {
         qWarning() << "Requested description for invalid device ID:" << device;
         return QString();
-    } else {
-        QCamera::Position position = cameraPosition(device);
-        return QString("Camera %1%2").arg(QLatin1String(device))
-                                     .arg(position == QCamera::FrontFace ? " Front facing" :
-                                          (position == QCamera::BackFace ? " Back facing" : ""));
-    }
-}
-
-int AalServicePlugin::getCameraOrientationOverride(const QString deviceID) const {
-    QByteArray propertyName = QString("aal.camera.orientations.%1").arg(deviceID).toLocal8Bit();
-
-    char orientationStr[PROP_VALUE_MAX];
-    property_get(propertyName.data(), orientationStr, "");
-
-    bool ok;
-    int orientation = QString(orientationStr).toInt(&ok, /* base */ 10);
-    if (!ok) {
-        orientation = -1;
     }
-
-    return orientation;
+    return CameraDeviceRegistry::description(deviceID);
 }
 
 int AalServicePlugin::cameraOrientation(const QByteArray & device) const
 {
-    // Check for the override
-    int override = getCameraOrientationOverride(device);
-    if (override != -1) {
-        return override;
-    }
-
-    int facing;
-    int orientation;
-
-    bool ok;
-    int deviceID = device.toInt(&ok, 10);
-    if (!ok) {
-        return 0;
-    }
-
-    int result = android_camera_get_device_info(deviceID, &facing, &orientation);
-    if (result != 0) {
-        return 0;
-    }
-
-    // Android's orientation means differently compared to QT's orientation.
-    // On Android, it means "the angle that the camera image needs to be
-    // rotated", but on QT, it means "the physical orientation of the camera
-    // sensor". So, the value will have to be inverted.
-
-    return (360 - orientation) % 360;
+    return CameraDeviceRegistry::orientation(CameraDeviceRegistry::indexOf(device));
 }
 
 QCamera::Position AalServicePlugin::cameraPosition(const QByteArray & device) const
 {
-    int facing;
-    int orientation;
-
-    bool ok;
-    int deviceID = device.toInt(&ok, 10);
-    if (!ok) {
-        return QCamera::UnspecifiedPosition;
-    }
-
-    int result = android_camera_get_device_info(deviceID, &facing, &orientation);
-    if (result != 0) {
-        return QCamera::UnspecifiedPosition;
-    } else {
-        return facing == BACK_FACING_CAMERA_TYPE ? QCamera::BackFace :
-                                                   QCamera::FrontFace;
-    }
+    return CameraDeviceRegistry::position(CameraDeviceRegistry::indexOf(device));
 }
@@ -17,6 +17,7 @@
 #include "aalcamerazoomcontrol.h"
 #include "aalcameracontrol.h"
 #include "aalcameraservice.h"
+#include "halstatistics.h"
 
 #include <QDebug>
 
@@ -44,6 +45,7 @@ qreal AalCameraZoomControl::currentOpticalZoom() const
 
 qreal AalCameraZoomControl::maximumDigitalZoom() const
 {
+    m_service->ensureDeferredInit();
     return (qreal)m_maximumDigitalZoom;
 }
 
@@ -69,6 +71,7 @@ void AalCameraZoomControl::zoomTo(qreal optical, qreal digital)
     if (!m_service->androidControl())
         return;
 
+    m_service->ensureDeferredInit();
     if (digital < 0.0 || digital > m_maximumDigitalZoom) {
         qWarning() << "Invalid zoom value:" << digital;
         return;
@@ -79,7 +82,10 @@ void AalCameraZoomControl::zoomTo(qreal optical, qreal digital)
     if (m_pendingZoom == m_currentDigitalZoom)
         return;
 
-    android_camera_set_zoom(m_service->androidControl(), m_pendingZoom);
+    int zoom = m_pendingZoom;
+    m_service->setCameraParameter(AalCameraService::ZoomParameter, [zoom](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_set_zoom(cc, zoom));
+    });
     m_currentDigitalZoom = m_pendingZoom;
     Q_EMIT currentDigitalZoomChanged(m_currentDigitalZoom);
 }
@@ -108,10 +114,11 @@ void AalCameraZoomControl::resetZoom()
         Q_EMIT currentDigitalZoomChanged(m_currentDigitalZoom);
     }
 
-    android_camera_set_zoom(m_service->androidControl(), m_currentDigitalZoom);
+    m_service->setCameraParameter(AalCameraService::ZoomParameter, [](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_set_zoom(cc, 0));
+    });
 
-    int maxValue = 1;
-    android_camera_get_max_zoom(m_service->androidControl(), &maxValue);
+    int maxValue = m_service->capabilities().maxZoom;
     if (maxValue < 0) {
         return;
     }
@@ -20,8 +20,11 @@
 #include "aalmetadatawritercontrol.h"
 #include "aalvideorenderercontrol.h"
 #include "aalviewfindersettingscontrol.h"
+#include "haleventqueue.h"
 #include "storagemanager.h"
 #include "rotationhandler.h"
+#include "halstatistics.h"
+#include "tracebuffer.h"
 
 #include <hybris/camera/camera_compatibility_layer.h>
 #include <hybris/camera/camera_compatibility_layer_capabilities.h>
@@ -48,11 +51,9 @@ AalImageCaptureControl::AalImageCaptureControl(AalCameraService *service, QObjec
     m_targetFileName(),
     m_captureCancelled(false),
     m_screenAspectRatio(0.0),
-    m_audioPlayer(new QMediaPlayer(this))
+    m_audioPlayer(0)
 {
     m_galleryPath = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
-    m_audioPlayer->setMedia(QUrl::fromLocalFile("/system/media/audio/ui/camera_click.ogg"));
-    m_audioPlayer->setAudioRole(QAudio::NotificationRole);
 
     QObject::connect(&m_storageManager, &StorageManager::previewReady,
                      this, &AalImageCaptureControl::imageCaptured);
@@ -70,6 +71,7 @@ bool AalImageCaptureControl::isReadyForCapture() const
 
 int AalImageCaptureControl::capture(const QString &fileName)
 {
+    TraceScope trace("capture: request");
     m_lastRequestId++;
     if (!m_ready || !m_service->androidControl()) {
         emit error(m_lastRequestId, QCameraImageCapture::NotReadyError,
@@ -77,14 +79,20 @@ int AalImageCaptureControl::capture(const QString &fileName)
         return m_lastRequestId;
     }
 
+    m_service->ensureDeferredInit();
     m_targetFileName = fileName;
     m_captureCancelled = false;
 
     RotationHandler *rotationHandler = m_service->rotationHandler();
     int rotation = rotationHandler->calculateRotation();
-    android_camera_set_rotation(m_service->androidControl(), rotation);
+    m_service->setCameraParameter(AalCameraService::RotationParameter, [rotation](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_set_rotation(cc, rotation));
+    });
 
-    android_camera_take_snapshot(m_service->androidControl());
+    // Runs on the camera thread after the flash mode, picture size and rotation
+    m_service->sendCameraCommand([](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_take_snapshot(cc));
+    });
 
     m_service->updateCaptureReady();
 
@@ -99,22 +107,20 @@ void AalImageCaptureControl::cancelCapture()
 
 void AalImageCaptureControl::shutterCB(void *context)
 {
-    Q_UNUSED(context);
-    QMetaObject::invokeMethod(AalCameraService::instance()->imageCaptureControl(),
-                              "shutter", Qt::QueuedConnection);
+    TraceBuffer::instant("hal: shutter");
+    static_cast<AalCameraService*>(context)->halEvents()->post(HalEventQueue::ShutterEvent);
 }
 
 void AalImageCaptureControl::saveJpegCB(void *data, uint32_t data_size, void *context)
 {
-    Q_UNUSED(context);
+    TraceScope trace("hal: compressed image");
 
     // Copy the data buffer so that it is safe to pass it off to another thread,
     // since it will be destroyed once this function returns
     QByteArray dataCopy((const char*)data, data_size);
 
-    QMetaObject::invokeMethod(AalCameraService::instance()->imageCaptureControl(),
-                              "saveJpeg", Qt::QueuedConnection,
-                              Q_ARG(QByteArray, dataCopy));
+    static_cast<AalCameraService*>(context)->halEvents()->post(HalEventQueue::CompressedImageEvent,
+                                                               dataCopy);
 }
 
 void AalImageCaptureControl::init(CameraControl *control, CameraControlListener *listener)
@@ -125,6 +131,23 @@ void AalImageCaptureControl::init(CameraControl *control, CameraControlListener
     listener->on_data_compressed_image_cb = &AalImageCaptureControl::saveJpegCB;
 
     connect(m_service->videoOutputControl(), SIGNAL(previewReady()), this, SLOT(onPreviewReady()));
+
+    loadShutterSound();
+}
+
+/*!
+ * \brief AalImageCaptureControl::loadShutterSound prepares the shutter sound, so
+ * that the first capture does not wait for the media player. It is called once
+ * the viewfinder is up, to not slow down the start of the camera.
+ */
+void AalImageCaptureControl::loadShutterSound()
+{
+    if (m_audioPlayer || !m_settings.value("playShutterSound", true).toBool())
+        return;
+
+    m_audioPlayer = new QMediaPlayer(this);
+    m_audioPlayer->setMedia(QUrl::fromLocalFile("/system/media/audio/ui/camera_click.ogg"));
+    m_audioPlayer->setAudioRole(QAudio::NotificationRole);
 }
 
 void AalImageCaptureControl::setReady(bool ready)
@@ -142,8 +165,9 @@ bool AalImageCaptureControl::isCaptureRunning() const
 
 void AalImageCaptureControl::shutter()
 {
+    TraceBuffer::instant("capture: shutter");
     bool playShutterSound = m_settings.value("playShutterSound", true).toBool();
-    if (playShutterSound) {
+    if (playShutterSound && m_audioPlayer) {
         m_audioPlayer->play();
     }
     Q_EMIT imageExposed(m_lastRequestId);
@@ -151,6 +175,8 @@ void AalImageCaptureControl::shutter()
 
 void AalImageCaptureControl::saveJpeg(const QByteArray& data)
 {
+    TraceScope trace("capture: dispatch save");
+
     if (m_captureCancelled) {
         m_captureCancelled = false;
         return;
@@ -171,9 +197,9 @@ void AalImageCaptureControl::saveJpeg(const QByteArray& data)
     QSize resolution = viewfinder->viewfinderParameter(QCameraViewfinderSettingsControl::Resolution).toSize();
 
     // Restart the viewfinder and notify that the camera is ready to capture again
-    if (m_service->androidControl()) {
-        android_camera_start_preview(m_service->androidControl());
-    }
+    m_service->sendCameraCommand([](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_start_preview(cc));
+    });
     m_service->updateCaptureReady();
 
     DiskWriteWatcher* watcher = new DiskWriteWatcher(this);
@@ -187,6 +213,7 @@ void AalImageCaptureControl::saveJpeg(const QByteArray& data)
 
 void AalImageCaptureControl::onImageFileSaved()
 {
+    TraceBuffer::instant("capture: saved");
     DiskWriteWatcher* watcher = static_cast<DiskWriteWatcher*>(sender());
 
     if (m_pendingSaveOperations.contains(watcher)) {
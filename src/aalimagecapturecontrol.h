@@ -64,6 +64,7 @@ private Q_SLOTS:
     void saveJpeg(const QByteArray& data);
 
 private:
+    void loadShutterSound();
     bool updateJpegMetadata(void* data, uint32_t dataSize, QTemporaryFile* destination);
 
     AalCameraService *m_service;
@@ -20,6 +20,7 @@
 #include "aalvideoencodersettingscontrol.h"
 #include "aalimagecapturecontrol.h"
 #include "aalcameraservice.h"
+#include "halstatistics.h"
 
 #include <hybris/camera/camera_compatibility_layer_capabilities.h>
 
@@ -58,7 +59,10 @@ void AalImageEncoderControl::setImageSettings(const QImageEncoderSettings &setti
         m_encoderSettings.setQuality(settings.quality());
         if (m_service->androidControl()) {
             int jpegQuality = qtEncodingQualityToJpegQuality(settings.quality());
-            android_camera_set_jpeg_quality(m_service->androidControl(), jpegQuality);
+            m_service->setCameraParameter(AalCameraService::JpegQualityParameter,
+                                          [jpegQuality](CameraControl *cc) {
+                AAL_HAL_CALL(android_camera_set_jpeg_quality(cc, jpegQuality));
+            });
         }
 
         // codec
@@ -109,12 +113,12 @@ void AalImageEncoderControl::init(CameraControl *control)
     Q_ASSERT(control != NULL);
 
     if (m_availableSizes.isEmpty()) {
-        android_camera_enumerate_supported_picture_sizes(control, &AalImageEncoderControl::getPictureSizeCb, this);
-        android_camera_enumerate_supported_thumbnail_sizes(control, &AalImageEncoderControl::getThumbnailSizeCb, this);
+        m_availableSizes = m_service->capabilities().pictureSizes;
+        m_availableThumbnailSizes = m_service->capabilities().thumbnailSizes;
     }
 
     int jpegQuality;
-    android_camera_get_jpeg_quality(control, &jpegQuality);
+    AAL_HAL_CALL(android_camera_get_jpeg_quality(control, &jpegQuality));
     m_encoderSettings.setQuality(jpegQualityToQtEncodingQuality(jpegQuality));
 
     if (m_availableSizes.empty()) {
@@ -182,11 +186,28 @@ bool AalImageEncoderControl::setSize(const QSize &size)
         qWarning() << "(AalImageEncoderControl::setSize) ** Image and thumbnail aspect ratios are different. Thumbnails will look wrong!";
     }
 
-    android_camera_set_picture_size(cc, m_currentSize.width(), m_currentSize.height());
-    android_camera_set_thumbnail_size(cc, m_currentThumbnailSize.width(), m_currentThumbnailSize.height());
+    applyPictureSize();
     return true;
 }
 
+/*!
+ * \brief AalImageEncoderControl::applyPictureSize sends the current picture and
+ * thumbnail sizes to the camera
+ */
+void AalImageEncoderControl::applyPictureSize()
+{
+    QSize pictureSize = m_currentSize;
+    QSize thumbnailSize = m_currentThumbnailSize;
+    m_service->setCameraParameter(AalCameraService::PictureSizeParameter,
+                                  [pictureSize](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_set_picture_size(cc, pictureSize.width(), pictureSize.height()));
+    });
+    m_service->setCameraParameter(AalCameraService::ThumbnailSizeParameter,
+                                  [thumbnailSize](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_set_thumbnail_size(cc, thumbnailSize.width(), thumbnailSize.height()));
+    });
+}
+
 void AalImageEncoderControl::resetAllSettings()
 {
     m_availableSizes.clear();
@@ -204,41 +225,9 @@ void AalImageEncoderControl::enablePhotoMode()
     if (!cc || !m_currentSize.isValid()) {
         return;
     }
-    android_camera_set_picture_size(cc, m_currentSize.width(), m_currentSize.height());
-    android_camera_set_thumbnail_size(cc, m_currentThumbnailSize.width(), m_currentThumbnailSize.height());
-}
-
-void AalImageEncoderControl::getPictureSizeCb(void *ctx, int width, int height)
-{
-    if (ctx != NULL)
-    {
-        AalImageEncoderControl *self = static_cast<AalImageEncoderControl *>(ctx);
-        self->getPictureSize(width, height);
-    }
-    else
-        qWarning() << "ctx is NULL, cannot get supported camera resolutions." << endl;
+    applyPictureSize();
 }
 
-void AalImageEncoderControl::getThumbnailSizeCb(void *ctx, int width, int height)
-{
-    if (ctx != NULL)
-    {
-        AalImageEncoderControl *self = static_cast<AalImageEncoderControl *>(ctx);
-        self->getThumbnailSize(width, height);
-    }
-    else
-        qWarning() << "ctx is NULL, cannot get supported thumbnail resolutions." << endl;
-}
-
-void AalImageEncoderControl::getPictureSize(int width, int height)
-{
-    m_availableSizes.append(QSize(width, height));
-}
-
-void AalImageEncoderControl::getThumbnailSize(int width, int height)
-{
-    m_availableThumbnailSizes.append(QSize(width, height));
-}
 
 
 QMultimedia::EncodingQuality AalImageEncoderControl::jpegQualityToQtEncodingQuality(int jpegQuality)
@@ -44,9 +44,6 @@ public:
 
     void enablePhotoMode();
 
-    static void getPictureSizeCb(void *ctx, int width, int height);
-    static void getThumbnailSizeCb(void *ctx, int width, int height);
-
 private:
     AalCameraService *m_service;
     QList<QSize> m_availableSizes;
@@ -56,8 +53,7 @@ private:
     QImageEncoderSettings m_encoderSettings;
 
     bool setSize(const QSize &size);
-    void getPictureSize(int width, int height);
-    void getThumbnailSize(int width, int height);
+    void applyPictureSize();
     QMultimedia::EncodingQuality jpegQualityToQtEncodingQuality(int jpegQuality);
     int qtEncodingQualityToJpegQuality(QMultimedia::EncodingQuality quality);
 };
@@ -15,18 +15,30 @@
  */
 
 #include "aalmediarecordercontrol.h"
+#include "aalaudioencodersettingscontrol.h"
+#include "aalcameracontrol.h"
 #include "aalcameraservice.h"
 #include "aalmetadatawritercontrol.h"
 #include "aalvideoencodersettingscontrol.h"
 #include "aalviewfindersettingscontrol.h"
 #include "audiocapture.h"
+#include "cameraproperties.h"
+#include "cameraworker.h"
 #include "storagemanager.h"
+#include "recordingwriter.h"
 #include "rotationhandler.h"
+#include "segmentring.h"
+#include "streamrelay.h"
+#include "halstatistics.h"
+#include "tracebuffer.h"
 
+#include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrent>
 
 #include <hybris/camera/camera_compatibility_layer.h>
 #include <hybris/camera/camera_compatibility_layer_capabilities.h>
@@ -36,6 +48,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 const int AalMediaRecorderControl::RECORDER_GENERAL_ERROR;
 const int AalMediaRecorderControl::RECORDER_NOT_AVAILABLE_ERROR;
@@ -46,9 +61,13 @@ const int AalMediaRecorderControl::DURATION_UPDATE_INTERVAL;
 const QLatin1String AalMediaRecorderControl::PARAM_AUDIO_BITRATE = QLatin1String("audio-param-encoding-bitrate");
 const QLatin1String AalMediaRecorderControl::PARAM_AUDIO_CHANNELS = QLatin1String("audio-param-number-of-channels");
 const QLatin1String AalMediaRecorderControl::PARAM_AUTIO_SAMPLING = QLatin1String("audio-param-sampling-rate");
+const QLatin1String AalMediaRecorderControl::PARAM_I_FRAMES_INTERVAL = QLatin1String("video-param-i-frames-interval");
 const QLatin1String AalMediaRecorderControl::PARAM_LATITUDE = QLatin1String("param-geotag-latitude");
 const QLatin1String AalMediaRecorderControl::PARAM_LONGITUDE = QLatin1String("param-geotag-longitude");
 const QLatin1String AalMediaRecorderControl::PARAM_ORIENTATION = QLatin1String("video-param-rotation-angle-degrees");
+const QLatin1String AalMediaRecorderControl::PARAM_TIME_LAPSE_ENABLE = QLatin1String("time-lapse-enable");
+const QLatin1String AalMediaRecorderControl::PARAM_TIME_LAPSE_FPS = QLatin1String("time-lapse-fps");
+const QLatin1String AalMediaRecorderControl::PARAM_TIME_LAPSE_INTERVAL = QLatin1String("time-between-time-lapse-frame-capture");
 const QLatin1String AalMediaRecorderControl::PARAM_VIDEO_BITRATE = QLatin1String("video-param-encoding-bitrate");
 /*!
  * \brief AalMediaRecorderControl::AalMediaRecorderControl
@@ -61,12 +80,43 @@ AalMediaRecorderControl::AalMediaRecorderControl(AalCameraService *service, QObj
     m_mediaRecorder(0),
     m_audioCapture(0),
     m_outfd(-1),
+    m_outputReserved(false),
+    m_writer(0),
     m_duration(0),
     m_currentState(QMediaRecorder::StoppedState),
     m_currentStatus(QMediaRecorder::UnloadedStatus),
     m_recordingTimer(0),
-    m_audioCaptureAvailable(false)
+    m_audioCaptureThread(0),
+    m_audioCaptureAvailable(false),
+    m_prewarmPending(false),
+    m_prewarmed(false),
+    m_prewarmFd(-1),
+    m_prewarmResult(0),
+    m_prewarmId(0),
+    m_prewarmCancelled(false),
+    m_startAfterPrewarm(false),
+    m_segments(0),
+    m_segmentStart(0),
+    m_nextPending(false),
+    m_nextFd(-1),
+    m_nextReserved(false),
+    m_streamFd(-1),
+    m_streamTee(false),
+    m_relay(0),
+    m_timeLapseInterval(0)
 {
+    m_prewarmEnabled = CameraProperties::boolValue("aal.camera.prewarm_recorder", false);
+    m_writeBehindEnabled = CameraProperties::boolValue("aal.camera.write_behind", false);
+    m_writeBehindChunk = qint64(CameraProperties::intValue("aal.camera.write_behind_chunk", 1024)) * 1024;
+    m_preallocation = qint64(CameraProperties::intValue("aal.camera.preallocate", 64)) * 1024 * 1024;
+    m_loopEnabled = CameraProperties::boolValue("aal.camera.loop_recording", false);
+    m_segmentDuration = qint64(CameraProperties::intValue("aal.camera.loop_segment_duration", 300)) * 1000;
+    m_segmentSize = qint64(CameraProperties::intValue("aal.camera.loop_segment_size", 0)) * 1024 * 1024;
+    m_maxSegments = CameraProperties::intValue("aal.camera.loop_segments", 10);
+    m_loopBudget = qint64(CameraProperties::intValue("aal.camera.loop_budget", 0)) * 1024 * 1024;
+    m_streamBacklog = CameraProperties::intValue("aal.camera.stream_backlog", 512) * 1024;
+    m_streamKeyFrameInterval = CameraProperties::intValue("aal.camera.stream_keyframe_interval", 1);
+    m_timeLapseInterval = qMax(0, CameraProperties::intValue("aal.camera.time_lapse_interval", 0));
 }
 
 /*!
@@ -75,6 +125,8 @@ AalMediaRecorderControl::AalMediaRecorderControl(AalCameraService *service, QObj
 AalMediaRecorderControl::~AalMediaRecorderControl()
 {
     delete m_recordingTimer;
+    releaseNextSegment();
+    delete m_writer;
     if (m_outfd != -1)
     {
         int err = close(m_outfd);
@@ -82,9 +134,13 @@ AalMediaRecorderControl::~AalMediaRecorderControl()
             qWarning() << "Failed to close recording output file descriptor (errno: "
                 << errno << ")";
     }
+    delete m_relay;
+    if (m_streamFd >= 0)
+        close(m_streamFd);
+    waitForFinalization();
+    releasePrewarmed();
     deleteRecorder();
-    m_audioCaptureThread.quit();
-    m_audioCaptureThread.wait();
+    delete m_segments;
 }
 
 /*!
@@ -100,6 +156,8 @@ void AalMediaRecorderControl::applySettings()
  */
 qint64 AalMediaRecorderControl::duration() const
 {
+    if (m_currentState == QMediaRecorder::RecordingState && m_recordingClock.isValid())
+        return m_recordingClock.elapsed();
     return m_duration;
 }
 
@@ -164,71 +222,404 @@ void AalMediaRecorderControl::startAudioCaptureThread()
 {
     qDebug() << "Starting microphone reader/writer thread";
     // Start the microphone read/write thread
-    m_audioCaptureThread.start();
+    if (m_audioCaptureThread)
+        m_audioCaptureThread->start();
     Q_EMIT audioCaptureThreadStarted();
 }
 
 /*!
- * \brief AalMediaRecorderControl::init makes sure the mediarecorder is
- * initialized
+ * \brief AalMediaRecorderControl::initRecorder makes sure the mediarecorder and the
+ * microphone reader are initialized. It does not emit anything, so that it can
+ * run in the background for a pre-warmed recorder.
+ * \param settings the settings the recorder is to be prepared with
+ * \param errorMessage set to the error to report, if any, on failure
  */
-bool AalMediaRecorderControl::initRecorder()
+bool AalMediaRecorderControl::initRecorder(const RecorderSettings &settings, QString *errorMessage)
 {
     if (m_mediaRecorder == 0) {
-        m_mediaRecorder = android_media_new_recorder();
+        m_mediaRecorder = AAL_HAL_CALL(android_media_new_recorder());
         if (m_mediaRecorder == 0) {
             qWarning() << "Unable to create new media recorder";
-            Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "Unable to create new media recorder");
+            *errorMessage = QLatin1String("Unable to create new media recorder");
             return false;
         }
 
-        int audioInitError = initAudioCapture();
-        if (audioInitError == 0) {
-            m_audioCaptureAvailable = true;
-        } else {
-            m_audioCaptureAvailable = false;
-            if (audioInitError == AudioCapture::AUDIO_CAPTURE_TIMEOUT_ERROR) {
-                deleteRecorder();
-                return false;
-            }
-        }
+        AAL_HAL_CALL(android_recorder_set_error_cb(m_mediaRecorder, &AalMediaRecorderControl::errorCB, this));
+        AAL_HAL_CALL(android_camera_unlock(m_service->androidControl()));
+    }
 
-        android_recorder_set_error_cb(m_mediaRecorder, &AalMediaRecorderControl::errorCB, this);
-        android_camera_unlock(m_service->androidControl());
+    // The microphone reader does not survive a recording, a recycled recorder
+    // needs a new one. A time-lapse has no sound.
+    if (m_audioCapture == 0 && settings.captureInterval == 0) {
+        int audioInitError = initAudioCapture(settings);
+        m_audioCaptureAvailable = (audioInitError == 0);
+        if (audioInitError == AudioCapture::AUDIO_CAPTURE_TIMEOUT_ERROR)
+            return false;
     }
 
     return true;
 }
 
+/*!
+ * \brief AalMediaRecorderControl::configureRecorder takes an initialized
+ * recorder to the prepared state, writing to outfd, with audio if withAudio
+ * \return 0 on success, the error code otherwise, with the error in errorMessage
+ */
+int AalMediaRecorderControl::configureRecorder(MediaRecorderWrapper *recorder,
+                                               const RecorderSettings &settings, int outfd,
+                                               bool withAudio, QString *errorMessage)
+{
+    int ret;
+    if (settings.captureInterval > 0)
+        withAudio = false;
+    ret = AAL_HAL_CALL(android_recorder_setCamera(recorder, m_service->androidControl()));
+    if (ret < 0) {
+        *errorMessage = QLatin1String("android_recorder_setCamera() failed\n");
+        return RECORDER_INITIALIZATION_ERROR;
+    }
+    // state initial / idle
+    if (withAudio) {
+        ret = AAL_HAL_CALL(android_recorder_setAudioSource(recorder, ANDROID_AUDIO_SOURCE_CAMCORDER));
+        if (ret < 0) {
+            *errorMessage = QLatin1String("android_recorder_setAudioSource() failed");
+            return RECORDER_INITIALIZATION_ERROR;
+        }
+
+    }
+    ret = AAL_HAL_CALL(android_recorder_setVideoSource(recorder, ANDROID_VIDEO_SOURCE_CAMERA));
+    if (ret < 0) {
+        *errorMessage = QLatin1String("android_recorder_setVideoSource() failed");
+        return RECORDER_INITIALIZATION_ERROR;
+    }
+    // state initialized
+    ret = AAL_HAL_CALL(android_recorder_setOutputFormat(recorder, OutputFormat(settings.outputFormat)));
+    if (ret < 0) {
+        *errorMessage = QLatin1String("android_recorder_setOutputFormat() failed");
+        return RECORDER_INITIALIZATION_ERROR;
+    }
+    // state DataSourceConfigured
+    if (withAudio) {
+        ret = AAL_HAL_CALL(android_recorder_setAudioEncoder(recorder, ANDROID_AUDIO_ENCODER_AAC));
+        if (ret < 0) {
+            *errorMessage = QLatin1String("android_recorder_setAudioEncoder() failed");
+            return RECORDER_INITIALIZATION_ERROR;
+        }
+    }
+    // FIXME set codec from settings
+    ret = AAL_HAL_CALL(android_recorder_setVideoEncoder(recorder, ANDROID_VIDEO_ENCODER_H264));
+    if (ret < 0) {
+        *errorMessage = QLatin1String("android_recorder_setVideoEncoder() failed");
+        return RECORDER_INITIALIZATION_ERROR;
+    }
+
+    ret = AAL_HAL_CALL(android_recorder_setOutputFile(recorder, outfd));
+    if (ret < 0) {
+        *errorMessage = QLatin1String("android_recorder_setOutputFile() failed");
+        return RECORDER_INITIALIZATION_ERROR;
+    }
+
+    ret = AAL_HAL_CALL(android_recorder_setVideoSize(recorder, settings.resolution.width(),
+                                                     settings.resolution.height()));
+    if (ret < 0) {
+        *errorMessage = QLatin1String("android_recorder_setVideoSize() failed");
+        return RECORDER_INITIALIZATION_ERROR;
+    }
+    ret = AAL_HAL_CALL(android_recorder_setVideoFrameRate(recorder, settings.frameRate));
+    if (ret < 0) {
+        *errorMessage = QLatin1String("android_recorder_setVideoFrameRate() failed");
+        return RECORDER_INITIALIZATION_ERROR;
+    }
+
+    setParameter(recorder, PARAM_VIDEO_BITRATE, settings.videoBitRate);
+    if (withAudio) {
+        // The same format the microphone is read in, see initAudioCapture()
+        setParameter(recorder, PARAM_AUDIO_BITRATE, settings.audioBitRate);
+        setParameter(recorder, PARAM_AUDIO_CHANNELS, settings.audioChannelCount);
+        setParameter(recorder, PARAM_AUTIO_SAMPLING, settings.audioSampleRate);
+    }
+
+    setParameter(recorder, PARAM_ORIENTATION, settings.rotation);
+    if (settings.keyFrameInterval > 0)
+        setParameter(recorder, PARAM_I_FRAMES_INTERVAL, settings.keyFrameInterval);
+    if (settings.captureInterval > 0) {
+        // The camera source drops the frames between captures, so only the
+        // kept ones are encoded, and they are played back at the frame rate.
+        // Older recorders take the interval (us), newer ones the capture rate.
+        setParameter(recorder, PARAM_TIME_LAPSE_ENABLE, 1);
+        setParameter(recorder, PARAM_TIME_LAPSE_INTERVAL, settings.captureInterval * 1000);
+        setParameter(recorder, PARAM_TIME_LAPSE_FPS, 1000.0 / settings.captureInterval);
+    }
+
+    ret = AAL_HAL_CALL(android_recorder_prepare(recorder));
+    if (ret < 0) {
+        *errorMessage = QLatin1String("android_recorder_prepare() failed");
+        return RECORDER_INITIALIZATION_ERROR;
+    }
+
+    return 0;
+}
+
+bool AalMediaRecorderControl::RecorderSettings::operator==(const RecorderSettings &other) const
+{
+    return resolution == other.resolution && qFuzzyCompare(frameRate, other.frameRate) &&
+           videoBitRate == other.videoBitRate && rotation == other.rotation &&
+           outputFormat == other.outputFormat && keyFrameInterval == other.keyFrameInterval &&
+           captureInterval == other.captureInterval && audioBitRate == other.audioBitRate &&
+           audioSampleRate == other.audioSampleRate && audioChannelCount == other.audioChannelCount;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::currentSettings returns the settings the
+ * next recording is to be made with
+ */
+AalMediaRecorderControl::RecorderSettings AalMediaRecorderControl::currentSettings() const
+{
+    QVideoEncoderSettings videoSettings = m_service->videoEncoderControl()->videoSettings();
+    QAudioEncoderSettings audioSettings = m_service->audioEncoderControl()->audioSettings();
+
+    RecorderSettings settings;
+    settings.resolution = videoSettings.resolution();
+    settings.frameRate = videoSettings.frameRate();
+    settings.videoBitRate = videoSettings.bitRate();
+    settings.rotation = m_service->rotationHandler()->calculateRotation();
+    settings.audioBitRate = audioSettings.bitRate();
+    settings.audioSampleRate = audioSettings.sampleRate();
+    settings.audioChannelCount = audioSettings.channelCount();
+    if (m_streamFd >= 0) {
+        // Streams are read while they are written: frequent key frames let a
+        // consumer start, or recover from dropped data, quickly
+        settings.outputFormat = ANDROID_OUTPUT_FORMAT_MPEG2TS;
+        settings.keyFrameInterval = m_streamKeyFrameInterval;
+    } else {
+        settings.outputFormat = ANDROID_OUTPUT_FORMAT_MPEG_4;
+        settings.captureInterval = captureInterval();
+    }
+    return settings;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::captureInterval returns the time-lapse
+ * interval the next recording is made with, 0 if it is not a time-lapse
+ */
+int AalMediaRecorderControl::captureInterval() const
+{
+    return m_streamFd >= 0 ? 0 : m_timeLapseInterval;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::outputFileName returns the file the next
+ * recording is to be written to
+ */
+QString AalMediaRecorderControl::outputFileName() const
+{
+    QString fileName = m_outputLocation.path();
+    QFileInfo fileInfo = QFileInfo(fileName);
+    if (fileName.isEmpty()) {
+        fileName = m_service->storageManager()->nextVideoFileName();
+    } else if (fileInfo.isDir()) {
+        fileName = m_service->storageManager()->nextVideoFileName(fileName);
+    }
+    return fileName;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::prewarm creates and prepares a recorder on
+ * the camera thread, so that starting a recording only needs to pick the output
+ * file and start it. The recorder writes to a hidden file next to the
+ * recordings, which is renamed when the recording starts.
+ * This is only done if aal.camera.prewarm_recorder is set, as the camera stays
+ * unlocked for the recorder meanwhile.
+ */
+void AalMediaRecorderControl::prewarm()
+{
+    if (!canPrewarm())
+        return;
+
+    QString directory = QFileInfo(outputFileName()).absolutePath();
+    QByteArray fileName = QFile::encodeName(directory + QLatin1String("/.recording-XXXXXX"));
+    int fd = mkstemp(fileName.data());
+    if (fd < 0) {
+        qWarning() << "Failed to create a file to pre-warm the media recorder in" << directory
+                   << ":" << strerror(errno);
+        // A recycled recorder is not kept without its preparation
+        deleteRecorder();
+        return;
+    }
+    fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    m_prewarmFile = fileName;
+    m_prewarmFd = fd;
+    m_prewarmSettings = currentSettings();
+    m_prewarmPending = true;
+
+    // Queued behind the preview restarts and the camera parameters, which the
+    // recorder must not race
+    RecorderSettings settings = m_prewarmSettings;
+    const int prewarmId = ++m_prewarmId;
+    m_service->cameraWorker()->post([this, settings, fd, prewarmId]() {
+        m_prewarmResult = prewarmRecorder(settings, fd);
+        QMetaObject::invokeMethod(this, "onPrewarmFinished", Qt::QueuedConnection,
+                                  Q_ARG(int, prewarmId));
+    });
+}
+
+/*!
+ * \brief AalMediaRecorderControl::canPrewarm returns whether a recorder can be
+ * pre-warmed now: pre-warming is on, no recording owns the recorder and the
+ * recording goes to a file
+ */
+bool AalMediaRecorderControl::canPrewarm() const
+{
+    return m_prewarmEnabled && !m_prewarmPending && !m_prewarmed && m_streamFd < 0 &&
+           m_currentStatus == QMediaRecorder::UnloadedStatus && m_service->androidControl();
+}
+
+/*!
+ * \brief AalMediaRecorderControl::prewarmRecorder runs on the camera thread and
+ * prepares the recorder; nothing else touches it until finishPrewarm()
+ */
+int AalMediaRecorderControl::prewarmRecorder(const RecorderSettings &settings, int outfd)
+{
+    TraceScope trace("recorder: prewarm");
+
+    QString errorMessage;
+    if (!initRecorder(settings, &errorMessage))
+        return RECORDER_NOT_AVAILABLE_ERROR;
+
+    int ret = configureRecorder(m_mediaRecorder, settings, outfd, m_audioCaptureAvailable, &errorMessage);
+    if (ret < 0)
+        qWarning() << "Failed to pre-warm the media recorder:" << errorMessage;
+    return ret;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::onPrewarmFinished takes the pre-warmed
+ * recorder over once the camera thread is done with it, and starts the
+ * recording that was asked for meanwhile, if any
+ * \param prewarmId tells the pre-warm apart from the ones given up since
+ */
+void AalMediaRecorderControl::onPrewarmFinished(int prewarmId)
+{
+    if (prewarmId != m_prewarmId)
+        return;
+
+    finishPrewarm();
+    if (!m_startAfterPrewarm)
+        return;
+
+    m_startAfterPrewarm = false;
+    if (startRecorder() < 0) {
+        m_service->videoEncoderControl()->lockViewfinderFrameRate(false);
+        m_currentState = QMediaRecorder::StoppedState;
+        Q_EMIT stateChanged(m_currentState);
+    }
+}
+
+/*!
+ * \brief AalMediaRecorderControl::finishPrewarm takes the result of the
+ * preparation of the recorder over, once the camera thread is done with it
+ */
+void AalMediaRecorderControl::finishPrewarm()
+{
+    if (!m_prewarmPending)
+        return;
+
+    m_prewarmPending = false;
+    if (m_prewarmResult == 0 && !m_prewarmCancelled) {
+        m_prewarmed = true;
+        return;
+    }
+
+    // A recording started now will set the recorder up from scratch
+    m_prewarmCancelled = false;
+    closePrewarmFile();
+    deleteRecorder();
+}
+
+/*!
+ * \brief AalMediaRecorderControl::releasePrewarmed releases the recorder kept
+ * between recordings, pre-warmed or not, and locks the camera again. A
+ * recorder still being prepared is released once the camera thread is done
+ * with it.
+ */
+void AalMediaRecorderControl::releasePrewarmed()
+{
+    if (m_prewarmPending) {
+        if (!m_startAfterPrewarm)
+            m_prewarmCancelled = true;
+        return;
+    }
+
+    // A recording, or its start, owns the recorder otherwise
+    if (m_currentStatus != QMediaRecorder::UnloadedStatus)
+        return;
+
+    m_prewarmed = false;
+    closePrewarmFile();
+    deleteRecorder();
+}
+
+void AalMediaRecorderControl::closePrewarmFile()
+{
+    if (m_prewarmFd >= 0) {
+        close(m_prewarmFd);
+        m_prewarmFd = -1;
+    }
+    if (!m_prewarmFile.isEmpty()) {
+        unlink(m_prewarmFile.constData());
+        m_prewarmFile.clear();
+    }
+}
+
 /*!
  * \brief AalMediaRecorderControl::deleteRecorder releases all resources and
  * deletes the MediaRecorder
  */
 void AalMediaRecorderControl::deleteRecorder()
 {
+    TraceScope trace("recorder: release");
     deleteAudioCapture();
 
     if (m_mediaRecorder == 0)
         return;
 
-    android_recorder_release(m_mediaRecorder);
+    releaseRecorder(m_mediaRecorder, true);
     m_mediaRecorder = 0;
-    android_camera_lock(m_service->androidControl());
     setStatus(QMediaRecorder::UnloadedStatus);
 }
 
-int AalMediaRecorderControl::initAudioCapture()
+/*!
+ * \brief AalMediaRecorderControl::releaseRecorder releases a recorder on the
+ * camera thread, after the camera jobs queued before
+ * \param lockCamera whether to lock the camera again afterwards; it is only
+ * done while the camera is connected
+ */
+void AalMediaRecorderControl::releaseRecorder(MediaRecorderWrapper *recorder, bool lockCamera)
+{
+    CameraControl *control = lockCamera ? m_service->androidControl() : 0;
+    m_service->cameraWorker()->post([recorder, control]() {
+        AAL_HAL_CALL(android_recorder_release(recorder));
+        if (control)
+            AAL_HAL_CALL(android_camera_lock(control));
+    });
+}
+
+int AalMediaRecorderControl::initAudioCapture(const RecorderSettings &settings)
 {
     // setting up audio recording; m_audioCapture is executed within the m_workerThread affinity
     m_audioCapture = new AudioCapture(m_mediaRecorder);
-    int audioInitError = m_audioCapture->setupMicrophoneStream();
+    int audioInitError = m_audioCapture->setupMicrophoneStream(settings.audioSampleRate,
+                                                               settings.audioChannelCount);
     if (audioInitError != 0)
     {
         qWarning() << "Failed to setup PulseAudio microphone recording stream";
         delete m_audioCapture;
         m_audioCapture = 0;
     } else {
-        m_audioCapture->moveToThread(&m_audioCaptureThread);
+        // Each recording has its own thread, as the previous one may still be
+        // finalizing when the next one starts
+        m_audioCaptureThread = new QThread;
+        m_audioCapture->moveToThread(m_audioCaptureThread);
 
         // startWorkerThread signal comes from an Android layer callback that resides down in
         // the AudioRecordHybris class
@@ -246,22 +637,24 @@ void AalMediaRecorderControl::deleteAudioCapture()
         return;
 
     m_audioCapture->stopCapture();
-    m_audioCaptureThread.quit();
-    m_audioCaptureThread.wait();
+    m_audioCaptureThread->quit();
+    m_audioCaptureThread->wait();
 
     delete m_audioCapture;
     m_audioCapture = 0;
+    delete m_audioCaptureThread;
+    m_audioCaptureThread = 0;
     m_audioCaptureAvailable = false;
 }
 
 /*!
  * \brief AalMediaRecorderControl::errorCB handles errors from the android layer
- * \param context
+ * \param context the AalMediaRecorderControl owning the recorder
  */
 void AalMediaRecorderControl::errorCB(void *context)
 {
-    Q_UNUSED(context);
-    QMetaObject::invokeMethod(AalCameraService::instance()->mediaRecorderControl(),
+    TraceBuffer::instant("hal: recorder error");
+    QMetaObject::invokeMethod(static_cast<AalMediaRecorderControl*>(context),
                               "handleError", Qt::QueuedConnection);
 }
 
@@ -275,6 +668,90 @@ AudioCapture *AalMediaRecorderControl::audioCapture() const
     return m_audioCapture;
 }
 
+/*!
+ * \brief AalMediaRecorderControl::recordingWriter returns the write-back
+ * manager of the current recording, with its buffer occupancy and stall time,
+ * or 0 if write-behind is off or nothing is recorded
+ */
+RecordingWriter *AalMediaRecorderControl::recordingWriter() const
+{
+    return m_writer;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::segments returns the segments of the
+ * current or last loop recording, with the gaps between them, or 0 if loop
+ * recording is off
+ */
+SegmentRing *AalMediaRecorderControl::segments() const
+{
+    return m_segments;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::setStreamOutput makes the next recordings
+ * stream MPEG-TS to fd, e.g. a Unix socket or a pipe to a local consumer,
+ * instead of writing an MP4 file. If the consumer does not keep up, data is
+ * dropped rather than stalling the encoder.
+ * \param fd the consumer, which is duplicated and set to non-blocking mode;
+ * -1 to go back to recording files
+ * \param tee whether to write the stream to the output location as well
+ */
+bool AalMediaRecorderControl::setStreamOutput(int fd, bool tee)
+{
+    if (m_streamFd >= 0) {
+        close(m_streamFd);
+        m_streamFd = -1;
+    }
+    m_streamTee = tee;
+    if (fd < 0)
+        return true;
+
+    m_streamFd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (m_streamFd < 0) {
+        qWarning() << "Invalid stream output:" << strerror(errno);
+        return false;
+    }
+    fcntl(m_streamFd, F_SETFL, fcntl(m_streamFd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::streamRelay returns the relay of the
+ * current streamed recording, with its drop statistics, or 0 if nothing is
+ * streamed
+ */
+StreamRelay *AalMediaRecorderControl::streamRelay() const
+{
+    return m_relay;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::timeLapseInterval returns the time between
+ * the frames captured for a time-lapse recording, in ms, 0 if recordings are
+ * made at the full frame rate
+ */
+int AalMediaRecorderControl::timeLapseInterval() const
+{
+    return m_timeLapseInterval;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::setTimeLapseInterval makes the following
+ * recordings capture a frame every msec ms, and play them back at the video
+ * frame rate. The encoder only gets the captured frames, and the recording has
+ * no sound. 0 records at the full frame rate again.
+ * Streams are always recorded at the full frame rate.
+ */
+void AalMediaRecorderControl::setTimeLapseInterval(int msec)
+{
+    if (m_currentState != QMediaRecorder::StoppedState) {
+        qWarning() << "Can't change the time-lapse interval while recording";
+        return;
+    }
+    m_timeLapseInterval = qMax(0, msec);
+}
+
 /*!
  * \reimp
  */
@@ -294,11 +771,18 @@ void AalMediaRecorderControl::setState(QMediaRecorder::State state)
 
     switch (state) {
     case QMediaRecorder::RecordingState: {
-        startRecording();
+        // The viewfinder runs at the recording frame rate, or as slow as it
+        // can for a time-lapse; it is set before the recorder takes the
+        // camera over
+        const int interval = captureInterval();
+        m_service->videoEncoderControl()->lockViewfinderFrameRate(true, interval > 0 ? 1000.0 / interval : 0);
+        if (startRecording() < 0)
+            m_service->videoEncoderControl()->lockViewfinderFrameRate(false);
         break;
     }
     case QMediaRecorder::StoppedState: {
         stopRecording();
+        m_service->videoEncoderControl()->lockViewfinderFrameRate(false);
         break;
     }
     case QMediaRecorder::PausedState: {
@@ -317,10 +801,19 @@ void AalMediaRecorderControl::setVolume(qreal gain)
     qDebug() << Q_FUNC_INFO << " is not used";
 }
 
+/*!
+ * \brief AalMediaRecorderControl::updateDuration publishes the duration, taken
+ * from a monotonic clock so that it does not drift when the timer is late,
+ * and the telemetry of the recording
+ */
 void AalMediaRecorderControl::updateDuration()
 {
-    m_duration += DURATION_UPDATE_INTERVAL;
+    m_duration = m_recordingClock.elapsed();
     Q_EMIT durationChanged(m_duration);
+    updateTelemetry();
+
+    if (m_segments != 0 && m_currentStatus == QMediaRecorder::RecordingStatus && segmentFull())
+        rollOver();
 }
 
 /*!
@@ -350,156 +843,133 @@ void AalMediaRecorderControl::setStatus(QMediaRecorder::Status status)
  */
 int AalMediaRecorderControl::startRecording()
 {
+    TraceScope trace("recorder: start");
+
     if (m_service->androidControl() == 0) {
         Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "No camera connection");
         return RECORDER_INITIALIZATION_ERROR;
     }
 
-    if (m_currentStatus != QMediaRecorder::UnloadedStatus) {
+    // A new recording can start while the previous one is finalized
+    if (m_currentStatus != QMediaRecorder::UnloadedStatus &&
+        m_currentStatus != QMediaRecorder::FinalizingStatus) {
         qWarning() << "Can't start a recording while another one is in progess";
         return RECORDER_NOT_AVAILABLE_ERROR;
     }
 
+    m_service->ensureDeferredInit();
     setStatus(QMediaRecorder::LoadingStatus);
 
     m_duration = 0;
     Q_EMIT durationChanged(m_duration);
 
-    if (!initRecorder()) {
-        setStatus(QMediaRecorder::UnloadedStatus);
-        return RECORDER_NOT_AVAILABLE_ERROR;
+    if (m_prewarmPending) {
+        // The recorder being pre-warmed is taken over once the camera thread
+        // is done with it, see onPrewarmFinished()
+        m_startAfterPrewarm = true;
+        m_currentState = QMediaRecorder::RecordingState;
+        Q_EMIT stateChanged(m_currentState);
+        return 0;
     }
 
-    QVideoEncoderSettings videoSettings = m_service->videoEncoderControl()->videoSettings();
+    return startRecorder();
+}
 
-    int ret;
-    ret = android_recorder_setCamera(m_mediaRecorder, m_service->androidControl());
-    if (ret < 0) {
-        deleteRecorder();
-        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_setCamera() failed\n");
-        return RECORDER_INITIALIZATION_ERROR;
+/*!
+ * \brief AalMediaRecorderControl::startRecorder sets the recorder up, unless
+ * it was pre-warmed, and starts it
+ */
+int AalMediaRecorderControl::startRecorder()
+{
+    const bool streaming = m_streamFd >= 0;
+    QString fileName = outputFileName();
+    delete m_segments;
+    m_segments = 0;
+    if (m_loopEnabled && !streaming) {
+        m_segments = new SegmentRing(fileName, m_maxSegments, m_loopBudget);
+        qint64 freedSize;
+        fileName = m_segments->nextSegment(&freedSize);
+        m_segmentStart = 0;
     }
-    // state initial / idle
-    if (m_audioCaptureAvailable) {
-        ret = android_recorder_setAudioSource(m_mediaRecorder, ANDROID_AUDIO_SOURCE_CAMCORDER);
-        if (ret < 0) {
+    if (!streaming || m_streamTee)
+        Q_EMIT actualLocationChanged(QUrl(fileName));
+
+    if (m_prewarmed) {
+        m_prewarmed = false;
+        // The pre-warmed recorder can be used if it was prepared with the
+        // current settings and its file can be moved to the requested place
+        if (!streaming && m_prewarmSettings == currentSettings() &&
+            rename(m_prewarmFile.constData(), QFile::encodeName(fileName).constData()) == 0) {
+            m_outfd = m_prewarmFd;
+            m_outputReserved = false;
+            m_prewarmFd = -1;
+            m_prewarmFile.clear();
+        } else {
+            closePrewarmFile();
+            AAL_HAL_CALL(android_recorder_reset(m_mediaRecorder));
+        }
+    }
+
+    if (m_outfd < 0) {
+        const RecorderSettings settings = currentSettings();
+        QString errorMessage;
+        if (!initRecorder(settings, &errorMessage)) {
             deleteRecorder();
-            Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_setAudioSource() failed");
-            return RECORDER_INITIALIZATION_ERROR;
+            if (!errorMessage.isEmpty())
+                Q_EMIT error(RECORDER_INITIALIZATION_ERROR, errorMessage);
+            setStatus(QMediaRecorder::UnloadedStatus);
+            return RECORDER_NOT_AVAILABLE_ERROR;
         }
 
-    }
-    ret = android_recorder_setVideoSource(m_mediaRecorder, ANDROID_VIDEO_SOURCE_CAMERA);
-    if (ret < 0) {
-        deleteRecorder();
-        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_setVideoSource() failed");
-        return RECORDER_INITIALIZATION_ERROR;
-    }
-    // state initialized
-    ret = android_recorder_setOutputFormat(m_mediaRecorder, ANDROID_OUTPUT_FORMAT_MPEG_4);
-    if (ret < 0) {
-        deleteRecorder();
-        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_setOutputFormat() failed");
-        return RECORDER_INITIALIZATION_ERROR;
-    }
-    // state DataSourceConfigured
-    if (m_audioCaptureAvailable) {
-        ret = android_recorder_setAudioEncoder(m_mediaRecorder, ANDROID_AUDIO_ENCODER_AAC);
-        if (ret < 0) {
+        if (streaming)
+            m_outfd = openStream(fileName);
+        else
+            m_outfd = openOutputFile(fileName, 0, &m_outputReserved);
+        if (m_outfd < 0) {
             deleteRecorder();
-            Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_setAudioEncoder() failed");
+            Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "Could not open file for video recording");
             return RECORDER_INITIALIZATION_ERROR;
         }
-    }
-    // FIXME set codec from settings
-    ret = android_recorder_setVideoEncoder(m_mediaRecorder, ANDROID_VIDEO_ENCODER_H264);
-    if (ret < 0) {
-        deleteRecorder();
-        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_setVideoEncoder() failed");
-        return RECORDER_INITIALIZATION_ERROR;
-    }
-
-    QString fileName = m_outputLocation.path();
-    QFileInfo fileInfo = QFileInfo(fileName);
-    if (fileName.isEmpty()) {
-        fileName = m_service->storageManager()->nextVideoFileName();
-    } else if (fileInfo.isDir()) {
-        fileName = m_service->storageManager()->nextVideoFileName(fileName);
-    }
-    Q_EMIT actualLocationChanged(QUrl(fileName));
 
-    m_outfd = open(fileName.toLocal8Bit().data(), O_WRONLY | O_CREAT,
-              S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-    if (m_outfd < 0) {
-        deleteRecorder();
-        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "Could not open file for video recording");
-        return RECORDER_INITIALIZATION_ERROR;
-    }
-    ret = android_recorder_setOutputFile(m_mediaRecorder, m_outfd);
-    if (ret < 0) {
-        close(m_outfd);
-        m_outfd = -1;
-        deleteRecorder();
-        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_setOutputFile() failed");
-        return RECORDER_INITIALIZATION_ERROR;
-    }
-
-    QSize resolution = videoSettings.resolution();
-    ret = android_recorder_setVideoSize(m_mediaRecorder, resolution.width(), resolution.height());
-    if (ret < 0) {
-        close(m_outfd);
-        m_outfd = -1;
-        deleteRecorder();
-        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_setVideoSize() failed");
-        return RECORDER_INITIALIZATION_ERROR;
-    }
-    ret = android_recorder_setVideoFrameRate(m_mediaRecorder, videoSettings.frameRate());
-    if (ret < 0) {
-        close(m_outfd);
-        m_outfd = -1;
-        deleteRecorder();
-        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_setVideoFrameRate() failed");
-        return RECORDER_INITIALIZATION_ERROR;
+        int ret = configureRecorder(m_mediaRecorder, settings, m_outfd, m_audioCaptureAvailable,
+                                    &errorMessage);
+        if (ret < 0) {
+            closeOutput();
+            deleteRecorder();
+            Q_EMIT error(ret, errorMessage);
+            return ret;
+        }
     }
 
-    setParameter(PARAM_VIDEO_BITRATE, videoSettings.bitRate());
-    // FIXME get data from a new AalAudioEncoderSettingsControl
-    setParameter(PARAM_AUDIO_BITRATE, 48000);
-    setParameter(PARAM_AUDIO_CHANNELS, 2);
-    setParameter(PARAM_AUTIO_SAMPLING, 96000);
-
-    int rotation = m_service->rotationHandler()->calculateRotation();
-    setParameter(PARAM_ORIENTATION, rotation);
-
     if (m_service->metadataWriterControl()) {
         // FIXME: what metadata can be supported?
         m_service->metadataWriterControl()->clearAllMetaData();
     }
 
-    ret = android_recorder_prepare(m_mediaRecorder);
-    if (ret < 0) {
-        close(m_outfd);
-        m_outfd = -1;
-        deleteRecorder();
-        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_prepare() failed");
-        return RECORDER_INITIALIZATION_ERROR;
-    }
-
     setStatus(QMediaRecorder::LoadedStatus);
     setStatus(QMediaRecorder::StartingStatus);
 
+    if (m_relay != 0)
+        m_relay->start();
+
     // state prepared
-    ret = android_recorder_start(m_mediaRecorder);
+    int ret = AAL_HAL_CALL(android_recorder_start(m_mediaRecorder));
     if (ret < 0) {
-        close(m_outfd);
-        m_outfd = -1;
+        closeOutput();
         deleteRecorder();
         Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_start() failed");
         return RECORDER_INITIALIZATION_ERROR;
     }
 
-    m_currentState = QMediaRecorder::RecordingState;
-    Q_EMIT stateChanged(m_currentState);
+    m_recordingClock.start();
+    startTelemetry();
+    if (m_relay == 0)
+        startWriter();
+
+    if (m_currentState != QMediaRecorder::RecordingState) {
+        m_currentState = QMediaRecorder::RecordingState;
+        Q_EMIT stateChanged(m_currentState);
+    }
 
     setStatus(QMediaRecorder::RecordingStatus);
 
@@ -512,15 +982,335 @@ int AalMediaRecorderControl::startRecording()
     }
     m_recordingTimer->start();
 
+    prepareNextSegment();
+
     return 0;
 }
 
+/*!
+ * \brief AalMediaRecorderControl::openOutputFile opens a file to record to
+ * \param reserveSize how much space to reserve for the recording, as freed by
+ * the dropped loop recording segments
+ * \param reserved set to whether space was reserved, and has to be given back
+ * if the recording does not use it
+ */
+int AalMediaRecorderControl::openOutputFile(const QString &fileName, qint64 reserveSize, bool *reserved)
+{
+    int fd = open(QFile::encodeName(fileName).constData(), O_WRONLY | O_CREAT | O_TRUNC,
+                  S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    *reserved = fd >= 0 && reserveSize > 0 &&
+                fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, reserveSize) == 0;
+    return fd;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::openStream sets up the relay of a streamed
+ * recording, which also writes the stream to fileName if tee is on
+ * \return the write end of the pipe the recorder is to write to
+ */
+int AalMediaRecorderControl::openStream(const QString &fileName)
+{
+    int tee = -1;
+    if (m_streamTee) {
+        bool reserved;
+        tee = openOutputFile(fileName, 0, &reserved);
+        if (tee < 0)
+            return -1;
+    }
+
+    int output = fcntl(m_streamFd, F_DUPFD_CLOEXEC, 0);
+    int fds[2];
+    if (output < 0 || pipe2(fds, O_CLOEXEC) < 0) {
+        qWarning() << "Failed to set up the stream:" << strerror(errno);
+        if (output >= 0)
+            close(output);
+        if (tee >= 0)
+            close(tee);
+        return -1;
+    }
+    // Some slack for the encoder while the relay is not scheduled
+    fcntl(fds[1], F_SETPIPE_SZ, 1024 * 1024);
+
+    m_relay = new StreamRelay(fds[0], output, tee, m_streamBacklog);
+    return fds[1];
+}
+
+/*!
+ * \brief AalMediaRecorderControl::closeOutput closes the output of a
+ * recording that failed to start
+ */
+void AalMediaRecorderControl::closeOutput()
+{
+    close(m_outfd);
+    m_outfd = -1;
+    delete m_relay;
+    m_relay = 0;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::startTelemetry starts following the output
+ * of the recording, anew for each loop recording segment
+ */
+void AalMediaRecorderControl::startTelemetry()
+{
+    const RecorderSettings settings = currentSettings();
+    const bool withAudio = m_audioCaptureAvailable && settings.captureInterval == 0;
+    m_telemetry.start(m_recordingClock.elapsed(), withAudio ? settings.audioBitRate : 0);
+    Q_EMIT telemetryChanged();
+}
+
+/*!
+ * \brief AalMediaRecorderControl::updateTelemetry samples the size of the
+ * output, and for a file the time it was last written to
+ */
+void AalMediaRecorderControl::updateTelemetry()
+{
+    if (m_relay != 0) {
+        m_telemetry.update(m_recordingClock.elapsed(), m_relay->bytesReceived());
+    } else {
+        struct stat info;
+        if (m_outfd < 0 || fstat(m_outfd, &info) < 0)
+            return;
+        qint64 modified = qint64(info.st_mtim.tv_sec) * 1000 + info.st_mtim.tv_nsec / 1000000;
+        qint64 idle = qMax(qint64(0), QDateTime::currentMSecsSinceEpoch() - modified);
+        m_telemetry.update(m_recordingClock.elapsed(), info.st_size, idle);
+    }
+    Q_EMIT telemetryChanged();
+}
+
+/*!
+ * \brief AalMediaRecorderControl::bytesWritten returns how much the current
+ * output, or the last one, holds
+ */
+qint64 AalMediaRecorderControl::bytesWritten() const
+{
+    return m_telemetry.bytesWritten();
+}
+
+/*!
+ * \brief AalMediaRecorderControl::bitRate returns the bit rate achieved over
+ * the last second, in bit/s
+ */
+int AalMediaRecorderControl::bitRate() const
+{
+    return m_telemetry.bitRate();
+}
+
+int AalMediaRecorderControl::videoBitRate() const
+{
+    return m_telemetry.videoBitRate();
+}
+
+int AalMediaRecorderControl::audioBitRate() const
+{
+    return m_telemetry.audioBitRate();
+}
+
+/*!
+ * \brief AalMediaRecorderControl::timeSinceLastWrite returns how long, in ms,
+ * nothing was written to the output; a growing value means the recording
+ * stalls
+ */
+qint64 AalMediaRecorderControl::timeSinceLastWrite() const
+{
+    return m_telemetry.timeSinceLastWrite();
+}
+
+/*!
+ * \brief AalMediaRecorderControl::audioLatency returns how long ago, in us,
+ * the microphone data last passed to the recorder was captured; 0 without
+ * sound
+ */
+qint64 AalMediaRecorderControl::audioLatency() const
+{
+    return m_audioCapture != 0 ? m_audioCapture->latency() : 0;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::startWriter starts managing the write-back
+ * of the file being recorded, if write-behind is on
+ */
+void AalMediaRecorderControl::startWriter()
+{
+    if (!m_writeBehindEnabled)
+        return;
+
+    m_writer = new RecordingWriter(m_outfd, m_writeBehindChunk, m_preallocation);
+    m_writer->start();
+}
+
+/*!
+ * \brief AalMediaRecorderControl::prepareSegmentRecorder runs in the background
+ * and creates and prepares the recorder of the next loop recording segment,
+ * while the current one keeps recording
+ * \return the prepared recorder, 0 on failure
+ */
+MediaRecorderWrapper *AalMediaRecorderControl::prepareSegmentRecorder(const RecorderSettings &settings,
+                                                                      int outfd, bool withAudio)
+{
+    TraceScope trace("recorder: prepare segment");
+
+    MediaRecorderWrapper *recorder = AAL_HAL_CALL(android_media_new_recorder());
+    if (recorder == 0) {
+        qWarning() << "Unable to create the media recorder of the next segment";
+        return 0;
+    }
+    AAL_HAL_CALL(android_recorder_set_error_cb(recorder, &AalMediaRecorderControl::errorCB, this));
+
+    QString errorMessage;
+    if (configureRecorder(recorder, settings, outfd, withAudio, &errorMessage) < 0) {
+        qWarning() << "Failed to prepare the next segment:" << errorMessage;
+        AAL_HAL_CALL(android_recorder_release(recorder));
+        return 0;
+    }
+    return recorder;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::prepareNextSegment picks the file of the next
+ * loop recording segment and prepares a second recorder for it in the
+ * background, so that rolling over only needs to start it
+ */
+void AalMediaRecorderControl::prepareNextSegment()
+{
+    if (m_segments == 0 || m_nextPending || m_mediaRecorder == 0)
+        return;
+
+    qint64 freedSize;
+    m_nextSegment = m_segments->nextSegment(&freedSize);
+    m_nextFd = openOutputFile(m_nextSegment, freedSize, &m_nextReserved);
+    if (m_nextFd < 0) {
+        qWarning() << "Could not open the next segment" << m_nextSegment << ":" << strerror(errno);
+        m_segments->discard(m_nextSegment);
+        m_nextSegment.clear();
+        return;
+    }
+
+    m_nextPending = true;
+    m_nextWatcher.setFuture(QtConcurrent::run(this, &AalMediaRecorderControl::prepareSegmentRecorder,
+                                              currentSettings(), m_nextFd, m_audioCaptureAvailable));
+}
+
+/*!
+ * \brief AalMediaRecorderControl::releaseNextSegment drops the next loop
+ * recording segment, with its recorder, when the recording stops
+ */
+void AalMediaRecorderControl::releaseNextSegment()
+{
+    if (m_nextPending) {
+        m_nextWatcher.waitForFinished();
+        m_nextPending = false;
+        if (m_nextWatcher.result() != 0)
+            AAL_HAL_CALL(android_recorder_release(m_nextWatcher.result()));
+    }
+    if (m_nextFd >= 0) {
+        close(m_nextFd);
+        m_nextFd = -1;
+    }
+    if (!m_nextSegment.isEmpty()) {
+        m_segments->discard(m_nextSegment);
+        m_nextSegment.clear();
+    }
+}
+
+/*!
+ * \brief AalMediaRecorderControl::segmentFull returns whether the current loop
+ * recording segment reached its duration or size
+ */
+bool AalMediaRecorderControl::segmentFull() const
+{
+    if (m_segmentDuration > 0 && m_duration - m_segmentStart >= m_segmentDuration)
+        return true;
+
+    struct stat info;
+    return m_segmentSize > 0 && fstat(m_outfd, &info) == 0 && info.st_size >= m_segmentSize;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::rollOver hands the current loop recording
+ * segment over to its finalization and starts the recorder prepared for the
+ * next one. The gap between the segments is measured from the moment the
+ * current one is done to the start of the next one; as the current recorder
+ * only stops in the background, the actual gap is shorter.
+ */
+void AalMediaRecorderControl::rollOver()
+{
+    TraceScope trace("recorder: roll over");
+    QElapsedTimer gap;
+    gap.start();
+
+    if (!m_nextPending) {
+        prepareNextSegment();
+        return;
+    }
+
+    m_nextWatcher.waitForFinished();
+    m_nextPending = false;
+    MediaRecorderWrapper *next = m_nextWatcher.result();
+    if (next == 0) {
+        // Keep recording to the current segment, and try again
+        releaseNextSegment();
+        prepareNextSegment();
+        return;
+    }
+
+    // Both microphone readers would write to the same named pipe, so the one
+    // of the current segment stops before the next recorder starts. Its end of
+    // the pipe is closed, so the current recorder does not wait for more sound
+    // while it stops.
+    bool withAudio = m_audioCaptureAvailable;
+    deleteAudioCapture();
+    finalize(takeRecording());
+
+    QString fileName = m_nextSegment;
+    m_mediaRecorder = next;
+    m_outfd = m_nextFd;
+    m_outputReserved = m_nextReserved;
+    m_nextFd = -1;
+    m_nextSegment.clear();
+    if (withAudio)
+        m_audioCaptureAvailable = (initAudioCapture(currentSettings()) == 0);
+
+    int ret = AAL_HAL_CALL(android_recorder_start(m_mediaRecorder));
+    if (ret < 0) {
+        close(m_outfd);
+        m_outfd = -1;
+        deleteRecorder();
+        m_recordingTimer->stop();
+        m_service->videoEncoderControl()->lockViewfinderFrameRate(false);
+        m_currentState = QMediaRecorder::StoppedState;
+        Q_EMIT stateChanged(m_currentState);
+        Q_EMIT error(RECORDER_INITIALIZATION_ERROR, "android_recorder_start() failed");
+        return;
+    }
+
+    m_segments->recordGap(gap.nsecsElapsed());
+    qDebug() << "Loop recording continues in" << fileName << "after a gap of"
+             << m_segments->lastGap() / 1000 << "us";
+    startWriter();
+    m_segmentStart = m_duration;
+    startTelemetry();
+    Q_EMIT actualLocationChanged(QUrl(fileName));
+
+    prepareNextSegment();
+}
+
 /*!
  * \brief AalMediaRecorderControl::stopRecording
  */
 void AalMediaRecorderControl::stopRecording()
 {
+    TraceScope trace("recorder: stop");
     qDebug() << __PRETTY_FUNCTION__;
+    if (m_startAfterPrewarm) {
+        // It never started; the pre-warmed recorder is kept for the next one
+        m_startAfterPrewarm = false;
+        setStatus(QMediaRecorder::UnloadedStatus);
+        m_currentState = QMediaRecorder::StoppedState;
+        Q_EMIT stateChanged(m_currentState);
+        return;
+    }
+
     if (m_mediaRecorder == 0) {
         qWarning() << "Can't stop recording properly, m_mediaRecorder is NULL";
         return;
@@ -531,51 +1321,224 @@ void AalMediaRecorderControl::stopRecording()
         return;
     }
 
+    releaseNextSegment();
+    if (m_segments != 0) {
+        qDebug() << "Loop recording kept" << m_segments->segments().size() << "segments, with"
+                 << m_segments->gapCount() << "gaps of" << m_segments->averageGap() / 1000
+                 << "us on average and" << m_segments->maximumGap() / 1000 << "us at most";
+    }
+
     setStatus(QMediaRecorder::FinalizingStatus);
     m_recordingTimer->stop();
+    updateTelemetry();
+    m_duration = m_recordingClock.elapsed();
+    m_recordingClock.invalidate();
+    Q_EMIT durationChanged(m_duration);
 
-    int result = android_recorder_stop(m_mediaRecorder);
-    if (result < 0) {
-        Q_EMIT error(RECORDER_GENERAL_ERROR, "Cannot stop video recording");
-        return;
-    }
+    // Finalizing the file can take seconds for long clips. It is done in the
+    // background, so that the camera can go on and even start the next
+    // recording meanwhile.
+    finalize(takeRecording());
+
+    m_currentState = QMediaRecorder::StoppedState;
+    Q_EMIT stateChanged(m_currentState);
+}
+
+/*!
+ * \brief AalMediaRecorderControl::takeRecording hands the recorder, the
+ * microphone reader and the file of the current recording over, to be
+ * finalized
+ */
+AalMediaRecorderControl::FinishedRecording AalMediaRecorderControl::takeRecording()
+{
+    FinishedRecording recording;
+    recording.recorder = m_mediaRecorder;
+    recording.audioCapture = m_audioCapture;
+    recording.audioCaptureThread = m_audioCaptureThread;
+    recording.writer = m_writer;
+    recording.relay = m_relay;
+    recording.outfd = m_outfd;
+    recording.reserved = m_outputReserved;
+    if (m_audioCapture != 0)
+        disconnect(this, SIGNAL(audioCaptureThreadStarted()), m_audioCapture, SLOT(run()));
+    m_mediaRecorder = 0;
+    m_audioCapture = 0;
+    m_audioCaptureThread = 0;
+    m_audioCaptureAvailable = false;
+    m_writer = 0;
+    m_relay = 0;
+    m_outfd = -1;
+    m_outputReserved = false;
+    return recording;
+}
+
+/*!
+ * \brief AalMediaRecorderControl::finalize finalizes a recording in the
+ * background
+ */
+void AalMediaRecorderControl::finalize(const FinishedRecording &recording)
+{
+    FinalizeWatcher *watcher = new FinalizeWatcher(this);
+    connect(watcher, SIGNAL(finished()), this, SLOT(onRecordingFinalized()));
+    m_finalizeWatchers.append(watcher);
+    watcher->setFuture(QtConcurrent::run(&AalMediaRecorderControl::finalizeRecording, recording));
+}
+
+/*!
+ * \brief AalMediaRecorderControl::finalizeRecording runs in the background:
+ * it stops the recorder, which finalizes the file, and the microphone reader
+ */
+AalMediaRecorderControl::FinishedRecording AalMediaRecorderControl::finalizeRecording(FinishedRecording recording)
+{
+    TraceScope trace("recorder: finalize");
+
+    recording.result = AAL_HAL_CALL(android_recorder_stop(recording.recorder));
 
     // Stop microphone reader/writer loop
     // NOTE: This must come after the android_recorder_stop call, otherwise the
     // RecordThread instance will block the MPEG4Writer pthread_join when trying to
     // cleanly stop recording.
-    if (m_audioCapture != 0) {
-        m_audioCapture->stopCapture();
+    if (recording.audioCapture != 0) {
+        recording.audioCapture->stopCapture();
+        recording.audioCaptureThread->quit();
+        recording.audioCaptureThread->wait();
+        qDebug() << "Audio captured with a latency of up to"
+                 << recording.audioCapture->maximumLatency() / 1000 << "ms and"
+                 << recording.audioCapture->underruns() << "underruns";
     }
 
-    android_recorder_reset(m_mediaRecorder);
+    AAL_HAL_CALL(android_recorder_reset(recording.recorder));
+
+    if (recording.writer != 0) {
+        recording.writer->finish();
+        qDebug() << "Recording written:" << recording.writer->fileSize() << "bytes,"
+                 << "at most" << recording.writer->maximumBufferedBytes() << "bytes buffered,"
+                 << "stalled for" << recording.writer->stallTime() / 1000000 << "ms";
+    }
+
+    // Give back the space reserved for a loop recording segment it did not use
+    struct stat info;
+    if (recording.reserved && fstat(recording.outfd, &info) == 0 &&
+        ftruncate(recording.outfd, info.st_size) < 0) {
+        qWarning() << "Failed to release the space reserved for the segment:" << strerror(errno);
+    }
 
-    int err = close(m_outfd);
+    int err = close(recording.outfd);
     if (err < 0)
         qWarning() << "Failed to close recording output file descriptor (errno: "
             << errno << ")";
-    m_outfd = -1;
+    recording.outfd = -1;
+
+    // The relay forwards what is left in the pipe and ends
+    if (recording.relay != 0) {
+        recording.relay->wait();
+        qDebug() << "Stream relayed:" << recording.relay->bytesForwarded() << "bytes,"
+                 << recording.relay->bytesDropped() << "bytes dropped in"
+                 << recording.relay->dropEvents() << "drops,"
+                 << recording.relay->teeBytesDropped() << "bytes not written to the file";
+    }
 
-    m_currentState = QMediaRecorder::StoppedState;
-    Q_EMIT stateChanged(m_currentState);
+    return recording;
+}
 
-    deleteRecorder();
+void AalMediaRecorderControl::onRecordingFinalized()
+{
+    finishFinalization(static_cast<FinalizeWatcher*>(sender()), false);
+}
+
+/*!
+ * \brief AalMediaRecorderControl::finishFinalization cleans up after a
+ * finalized recording. Its recorder is kept to be prepared again if
+ * pre-warming is on, the camera is still in video mode and no other recording
+ * took over; otherwise it is released and the camera is locked again.
+ * \param watcher the watcher of the finalized recording
+ * \param cameraGoingAway true if the camera is about to be disconnected
+ */
+void AalMediaRecorderControl::finishFinalization(FinalizeWatcher *watcher, bool cameraGoingAway)
+{
+    if (!m_finalizeWatchers.removeOne(watcher))
+        return;
+
+    FinishedRecording recording = watcher->result();
+    delete watcher;
+
+    delete recording.audioCapture;
+    delete recording.audioCaptureThread;
+    delete recording.writer;
+    delete recording.relay;
+
+    if (recording.result < 0)
+        Q_EMIT error(RECORDER_GENERAL_ERROR, "Cannot stop video recording");
+
+    if (m_finalizeWatchers.isEmpty() && m_currentStatus == QMediaRecorder::FinalizingStatus)
+        setStatus(QMediaRecorder::UnloadedStatus);
+
+    // The recorder is only kept if it is prepared again right away
+    const bool stayInVideoMode = !cameraGoingAway &&
+            m_service->cameraControl()->captureMode() == QCamera::CaptureVideo;
+    if (stayInVideoMode && m_mediaRecorder == 0 && canPrewarm()) {
+        m_mediaRecorder = recording.recorder;
+        prewarm();
+    } else {
+        // The camera stays unlocked for the recording that took over, if any
+        releaseRecorder(recording.recorder, m_mediaRecorder == 0 && !m_prewarmPending);
+    }
+}
+
+/*!
+ * \brief AalMediaRecorderControl::waitForFinalization blocks until the
+ * recordings being finalized and the recorder being pre-warmed are done, as
+ * needed before the camera goes away
+ */
+void AalMediaRecorderControl::waitForFinalization()
+{
+    while (!m_finalizeWatchers.isEmpty()) {
+        FinalizeWatcher *watcher = m_finalizeWatchers.first();
+        watcher->waitForFinished();
+        finishFinalization(watcher, true);
+    }
+
+    if (m_prewarmPending) {
+        m_service->cameraWorker()->waitForIdle();
+        ++m_prewarmId;
+        finishPrewarm();
+        if (m_startAfterPrewarm) {
+            m_startAfterPrewarm = false;
+            setStatus(QMediaRecorder::UnloadedStatus);
+            m_service->videoEncoderControl()->lockViewfinderFrameRate(false);
+            m_currentState = QMediaRecorder::StoppedState;
+            Q_EMIT stateChanged(m_currentState);
+        }
+    }
 }
 
 /*!
  * \brief AalMediaRecorderControl::setParameter convenient function to set parameters
+ * \param recorder the recorder to set the parameter on
  * \param parameter Name of the parameter
  * \param value value to set
  */
-void AalMediaRecorderControl::setParameter(const QString &parameter, int value)
+void AalMediaRecorderControl::setParameter(MediaRecorderWrapper *recorder, const QString &parameter, int value)
 {
-    Q_ASSERT(m_mediaRecorder);
+    Q_ASSERT(recorder);
     QString param =  parameter + QChar('=') + QString::number(value);
-    android_recorder_setParameters(m_mediaRecorder, param.toLocal8Bit().data());
+    AAL_HAL_CALL(android_recorder_setParameters(recorder, param.toLocal8Bit().data()));
+}
+
+/*!
+ * \brief AalMediaRecorderControl::setParameter sets a parameter that takes a
+ * decimal number
+ */
+void AalMediaRecorderControl::setParameter(MediaRecorderWrapper *recorder, const QString &parameter, qreal value)
+{
+    Q_ASSERT(recorder);
+    QString param =  parameter + QChar('=') + QString::number(value, 'f', 6);
+    AAL_HAL_CALL(android_recorder_setParameters(recorder, param.toLocal8Bit().data()));
 }
 
 void AalMediaRecorderControl::recorderReadAudioCallback(void *context)
 {
+    TraceBuffer::instant("hal: audio reader ready");
     AalMediaRecorderControl *thiz = static_cast<AalMediaRecorderControl*>(context);
     if (thiz != NULL) {
         thiz->startAudioCaptureThread();
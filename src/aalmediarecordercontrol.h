@@ -17,7 +17,10 @@
 #ifndef AALMEDIARECORDERCONTROL_H
 #define AALMEDIARECORDERCONTROL_H
 
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QLatin1String>
+#include <QList>
 #include <QMediaRecorderControl>
 #include <QSize>
 #include <QUrl>
@@ -25,6 +28,8 @@
 
 #include <stdint.h>
 
+#include "recordingtelemetry.h"
+
 class AalCameraService;
 struct CameraControl;
 struct CameraControlListener;
@@ -32,10 +37,20 @@ struct MediaRecorderWrapper;
 class AudioCapture;
 class QThread;
 class QTimer;
+class RecordingWriter;
+class SegmentRing;
+class StreamRelay;
 
 class AalMediaRecorderControl : public QMediaRecorderControl
 {
 Q_OBJECT
+    Q_PROPERTY(qint64 bytesWritten READ bytesWritten NOTIFY telemetryChanged)
+    Q_PROPERTY(int bitRate READ bitRate NOTIFY telemetryChanged)
+    Q_PROPERTY(int videoBitRate READ videoBitRate NOTIFY telemetryChanged)
+    Q_PROPERTY(int audioBitRate READ audioBitRate NOTIFY telemetryChanged)
+    Q_PROPERTY(qint64 timeSinceLastWrite READ timeSinceLastWrite NOTIFY telemetryChanged)
+    Q_PROPERTY(qint64 audioLatency READ audioLatency NOTIFY telemetryChanged)
+    Q_PROPERTY(int timeLapseInterval READ timeLapseInterval WRITE setTimeLapseInterval)
 public:
     AalMediaRecorderControl(AalCameraService *service, QObject *parent = 0);
     ~AalMediaRecorderControl();
@@ -54,6 +69,23 @@ public:
     void init(CameraControl *control, CameraControlListener *listener);
     MediaRecorderWrapper* mediaRecorder() const;
     AudioCapture *audioCapture() const;
+    RecordingWriter *recordingWriter() const;
+    SegmentRing *segments() const;
+    bool setStreamOutput(int fd, bool tee = false);
+    StreamRelay *streamRelay() const;
+    int timeLapseInterval() const;
+    void setTimeLapseInterval(int msec);
+
+    qint64 bytesWritten() const;
+    int bitRate() const;
+    int videoBitRate() const;
+    int audioBitRate() const;
+    qint64 timeSinceLastWrite() const;
+    qint64 audioLatency() const;
+
+    void prewarm();
+    void releasePrewarmed();
+    void waitForFinalization();
 
 public Q_SLOTS:
     virtual void setMuted(bool muted);
@@ -63,33 +95,147 @@ public Q_SLOTS:
 
 signals:
     void audioCaptureThreadStarted();
+    void telemetryChanged();
 
 private Q_SLOTS:
     virtual void updateDuration();
     void handleError();
     void deleteAudioCapture();
+    void onPrewarmFinished(int prewarmId);
+    void onRecordingFinalized();
 
 private:
-    bool initRecorder();
+    /*!
+     * \brief RecorderSettings are the settings a recorder is prepared with
+     */
+    class RecorderSettings
+    {
+    public:
+        RecorderSettings() : frameRate(0), videoBitRate(0), rotation(0), outputFormat(0), keyFrameInterval(0),
+                             captureInterval(0), audioBitRate(0), audioSampleRate(0), audioChannelCount(0) {}
+        bool operator==(const RecorderSettings &other) const;
+
+        QSize resolution;
+        qreal frameRate;
+        int videoBitRate;
+        int rotation;
+        int outputFormat;
+        int keyFrameInterval;
+        int captureInterval;
+        int audioBitRate;
+        int audioSampleRate;
+        int audioChannelCount;
+    };
+
+    /*!
+     * \brief FinishedRecording is what a stopped recording hands over to its
+     * finalization in the background
+     */
+    class FinishedRecording
+    {
+    public:
+        FinishedRecording() : recorder(0), audioCapture(0), audioCaptureThread(0), writer(0), relay(0),
+                              outfd(-1), reserved(false), result(0) {}
+
+        MediaRecorderWrapper *recorder;
+        AudioCapture *audioCapture;
+        QThread *audioCaptureThread;
+        RecordingWriter *writer;
+        StreamRelay *relay;
+        int outfd;
+        bool reserved;
+        int result;
+    };
+    typedef QFutureWatcher<FinishedRecording> FinalizeWatcher;
+
+    bool initRecorder(const RecorderSettings &settings, QString *errorMessage);
+    int configureRecorder(MediaRecorderWrapper *recorder, const RecorderSettings &settings, int outfd,
+                          bool withAudio, QString *errorMessage);
+    RecorderSettings currentSettings() const;
+    int captureInterval() const;
+    QString outputFileName() const;
+    bool canPrewarm() const;
+    int prewarmRecorder(const RecorderSettings &settings, int outfd);
+    void finishPrewarm();
+    void closePrewarmFile();
+    int openOutputFile(const QString &fileName, qint64 reserveSize, bool *reserved);
+    int openStream(const QString &fileName);
+    void closeOutput();
+    void startTelemetry();
+    void updateTelemetry();
+    void startWriter();
+    MediaRecorderWrapper *prepareSegmentRecorder(const RecorderSettings &settings, int outfd, bool withAudio);
+    void prepareNextSegment();
+    void releaseNextSegment();
+    bool segmentFull() const;
+    void rollOver();
+    FinishedRecording takeRecording();
+    void finalize(const FinishedRecording &recording);
+    static FinishedRecording finalizeRecording(FinishedRecording recording);
+    void finishFinalization(FinalizeWatcher *watcher, bool cameraGoingAway);
     void deleteRecorder();
-    int initAudioCapture();
+    void releaseRecorder(MediaRecorderWrapper *recorder, bool lockCamera);
+    int initAudioCapture(const RecorderSettings &settings);
     void setStatus(QMediaRecorder::Status status);
     int startRecording();
+    int startRecorder();
     void stopRecording();
-    void setParameter(const QString &parameter, int value);
+    void setParameter(MediaRecorderWrapper *recorder, const QString &parameter, int value);
+    void setParameter(MediaRecorderWrapper *recorder, const QString &parameter, qreal value);
     static void recorderReadAudioCallback(void *context);
 
     AalCameraService *m_service;
     MediaRecorderWrapper *m_mediaRecorder;
     AudioCapture *m_audioCapture;
     int m_outfd;
+    bool m_outputReserved;
+    RecordingWriter *m_writer;
     QUrl m_outputLocation;
     qint64 m_duration;
+    QElapsedTimer m_recordingClock;
+    RecordingTelemetry m_telemetry;
     QMediaRecorder::State m_currentState;
     QMediaRecorder::Status m_currentStatus;
     QTimer *m_recordingTimer;
-    QThread m_audioCaptureThread;
+    QThread *m_audioCaptureThread;
     bool m_audioCaptureAvailable;
+    QList<FinalizeWatcher*> m_finalizeWatchers;
+
+    bool m_prewarmEnabled;
+    bool m_prewarmPending;
+    bool m_prewarmed;
+    RecorderSettings m_prewarmSettings;
+    QByteArray m_prewarmFile;
+    int m_prewarmFd;
+    int m_prewarmResult;
+    int m_prewarmId;
+    bool m_prewarmCancelled;
+    bool m_startAfterPrewarm;
+
+    bool m_writeBehindEnabled;
+    qint64 m_writeBehindChunk;
+    qint64 m_preallocation;
+
+    bool m_loopEnabled;
+    qint64 m_segmentDuration;
+    qint64 m_segmentSize;
+    int m_maxSegments;
+    qint64 m_loopBudget;
+    SegmentRing *m_segments;
+    qint64 m_segmentStart;
+    QFutureWatcher<MediaRecorderWrapper*> m_nextWatcher;
+    bool m_nextPending;
+    QString m_nextSegment;
+    int m_nextFd;
+    bool m_nextReserved;
+
+    int m_streamFd;
+    bool m_streamTee;
+    int m_streamBacklog;
+    int m_streamKeyFrameInterval;
+    StreamRelay *m_relay;
+
+    int m_timeLapseInterval;
 
     static const int RECORDER_GENERAL_ERROR = -1;
     static const int RECORDER_NOT_AVAILABLE_ERROR = -2;
@@ -100,9 +246,13 @@ private:
     static const QLatin1String PARAM_AUDIO_BITRATE;
     static const QLatin1String PARAM_AUDIO_CHANNELS;
     static const QLatin1String PARAM_AUTIO_SAMPLING;
+    static const QLatin1String PARAM_I_FRAMES_INTERVAL;
     static const QLatin1String PARAM_LATITUDE;
     static const QLatin1String PARAM_LONGITUDE;
     static const QLatin1String PARAM_ORIENTATION;
+    static const QLatin1String PARAM_TIME_LAPSE_ENABLE;
+    static const QLatin1String PARAM_TIME_LAPSE_FPS;
+    static const QLatin1String PARAM_TIME_LAPSE_INTERVAL;
     static const QLatin1String PARAM_VIDEO_BITRATE;
 };
 
@@ -18,12 +18,10 @@
 #include "aalcameraservice.h"
 #include "aalcameracontrol.h"
 #include "aalimageencodercontrol.h"
-#include "aalvideoencodersettingscontrol.h"
 #include "aalviewfindersettingscontrol.h"
+#include "cameradeviceregistry.h"
 
 #include <QDebug>
-#include <QtMultimedia/QCamera>
-#include <QtMultimedia/QCameraInfo>
 
 #include <hybris/camera/camera_compatibility_layer_capabilities.h>
 
@@ -42,17 +40,17 @@ int AalVideoDeviceSelectorControl::defaultDevice() const
 
 int AalVideoDeviceSelectorControl::deviceCount() const
 {
-    return QCameraInfo::availableCameras().count();
+    return CameraDeviceRegistry::count();
 }
 
 QString AalVideoDeviceSelectorControl::deviceDescription(int index) const
 {
-    return QCameraInfo::availableCameras().value(index).description();
+    return CameraDeviceRegistry::description(index);
 }
 
 QString AalVideoDeviceSelectorControl::deviceName(int index) const
 {
-    return QCameraInfo::availableCameras().value(index).deviceName();
+    return QString::fromLatin1(CameraDeviceRegistry::deviceName(index));
 }
 
 int AalVideoDeviceSelectorControl::selectedDevice() const
@@ -73,19 +71,13 @@ void AalVideoDeviceSelectorControl::setSelectedDevice(int index)
     if (m_service->isRecording())
         return;
 
-    m_service->stopPreview();
     m_service->disconnectCamera();
     m_service->viewfinderControl()->resetAllSettings();
     m_service->imageEncoderControl()->resetAllSettings();
-    m_service->videoEncoderControl()->resetAllSettings();
+    // The video encoder control, if it was created, resets its settings when
+    // the new camera initializes it
     m_currentDevice = index;
-    QCamera::State state = m_service->cameraControl()->state();
-    if (state == QCamera::LoadedState) {
-        m_service->connectCamera();
-    } else if (state == QCamera::ActiveState) {
-        m_service->connectCamera();
-        m_service->startPreview();
-    }
+    m_service->cameraControl()->reconnect();
 
     Q_EMIT selectedDeviceChanged(m_currentDevice);
     Q_EMIT selectedDeviceChanged(deviceName(m_currentDevice));
@@ -22,6 +22,7 @@
 #include <hybris/camera/camera_compatibility_layer_capabilities.h>
 
 #include <QCamera>
+#include <QtMath>
 
 const QSize AalVideoEncoderSettingsControl::DEFAULT_SIZE = QSize(1280,720);
 const int AalVideoEncoderSettingsControl::DEFAULT_FPS = 30;
@@ -64,15 +65,22 @@ void AalVideoEncoderSettingsControl::setVideoSettings(const QVideoEncoderSetting
 
 /*!
  * \reimp
+ * The hybris camera layer only tells the camera's current preview frame rate
+ * range, not the ranges it supports. So the frame rates returned are the top
+ * of that range and the standard rates below it, or 15 and 30 fps when no
+ * range is known. High frame rate modes would need a query of all the ranges
+ * the HAL supports, which this layer does not have, so they are never listed.
  */
 QList<qreal> AalVideoEncoderSettingsControl::supportedFrameRates(const QVideoEncoderSettings &settings, bool *continuous) const
 {
     Q_UNUSED(settings);
-    Q_UNUSED(continuous);
-    // FIXME get data from android
-    QList<qreal> fps;
-    fps << 15 << 30;
-    return fps;
+    if (continuous)
+        *continuous = false;
+
+    if (m_frameRates.isEmpty())
+        querySupportedFrameRates();
+
+    return m_frameRates;
 }
 
 /*!
@@ -141,6 +149,19 @@ void AalVideoEncoderSettingsControl::init(CameraControl *control, CameraControlL
     if (m_availableSizes.isEmpty())
         querySupportedResolution();
 
+    if (m_frameRates.isEmpty())
+        querySupportedFrameRates();
+
+    if (!m_frameRates.contains(m_settings.frameRate()) && !m_frameRates.isEmpty()) {
+        // The highest frame rate up to the default one
+        qreal frameRate = m_frameRates.first();
+        Q_FOREACH (qreal fps, m_frameRates) {
+            if (fps <= DEFAULT_FPS)
+                frameRate = fps;
+        }
+        m_settings.setFrameRate(frameRate);
+    }
+
     if (!m_availableSizes.contains(m_settings.resolution()) && !m_availableSizes.empty()) {
         m_settings.setResolution(m_availableSizes[0]);
         if (m_service->cameraControl()->captureMode() == QCamera::CaptureVideo) {
@@ -155,6 +176,7 @@ void AalVideoEncoderSettingsControl::init(CameraControl *control, CameraControlL
 void AalVideoEncoderSettingsControl::resetAllSettings()
 {
     m_availableSizes.clear();
+    m_frameRates.clear();
 
     int videoBitRate = 7 * DEFAULT_SIZE.width() * DEFAULT_SIZE.height();
     m_settings.setBitRate(videoBitRate);
@@ -169,14 +191,10 @@ void AalVideoEncoderSettingsControl::resetAllSettings()
  */
 void AalVideoEncoderSettingsControl::querySupportedResolution() const
 {
-    CameraControl *cc = m_service->androidControl();
-    if (!cc)
+    if (!m_service->androidControl())
         return;
 
-
-    AalVideoEncoderSettingsControl *vSettings = const_cast<AalVideoEncoderSettingsControl*>(this);
-    android_camera_enumerate_supported_video_sizes(cc, &AalVideoEncoderSettingsControl::sizeCB,
-                                                   vSettings);
+    m_availableSizes = m_service->capabilities().videoSizes;
 
     if (m_availableSizes.isEmpty()) {
         // android devices where video and viewfinder are "linked", no sizes are returned
@@ -186,13 +204,38 @@ void AalVideoEncoderSettingsControl::querySupportedResolution() const
 }
 
 /*!
- * \brief AalVideoEncoderSettingsControl::sizeCB calback function to get the supported sizes
- * \param ctx pointer to the AalVideoEncoderSettingsControl object that requests the sizes
- * \param width
- * \param height
+ * \brief AalVideoEncoderSettingsControl::querySupportedFrameRates saves the
+ * standard frame rates within the camera's current preview frame rate range,
+ * and the top of that range, to the m_frameRates member. Without a camera or
+ * a range, 15 and 30 fps are used, as all cameras support them.
+ */
+void AalVideoEncoderSettingsControl::querySupportedFrameRates() const
+{
+    const int minFPS = m_service->androidControl() ? m_service->capabilities().minFPS : 0;
+    const int maxFPS = m_service->androidControl() ? m_service->capabilities().maxFPS : 0;
+    if (maxFPS <= 0) {
+        m_frameRates << 15 << 30;
+        return;
+    }
+
+    const int standardRates[] = { 15, 24, 30 };
+    for (unsigned i = 0; i < sizeof(standardRates) / sizeof(standardRates[0]); ++i) {
+        if (standardRates[i] >= minFPS && standardRates[i] < maxFPS)
+            m_frameRates << standardRates[i];
+    }
+    m_frameRates << maxFPS;
+}
+
+/*!
+ * \brief AalVideoEncoderSettingsControl::lockViewfinderFrameRate makes the
+ * viewfinder run at the recording frame rate, for the time of a recording.
+ * A time-lapse recording captures at captureRate, and the viewfinder runs as
+ * slow as the camera allows for it.
  */
-void AalVideoEncoderSettingsControl::sizeCB(void *ctx, int width, int height)
+void AalVideoEncoderSettingsControl::lockViewfinderFrameRate(bool lock, qreal captureRate)
 {
-    AalVideoEncoderSettingsControl *self = (AalVideoEncoderSettingsControl*)ctx;
-    self->m_availableSizes.append(QSize(width, height));
+    qreal frameRate = m_settings.frameRate();
+    if (captureRate > 0)
+        frameRate = qMin(frameRate, captureRate);
+    m_service->viewfinderControl()->setRecordingFrameRate(lock ? qMax(1, qCeil(frameRate)) : 0);
 }
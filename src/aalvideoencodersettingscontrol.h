@@ -40,15 +40,16 @@ public:
 
     void init(CameraControl *control, CameraControlListener *listener);
     void resetAllSettings();
-
-    static void sizeCB(void *ctx, int width, int height);
+    void lockViewfinderFrameRate(bool lock, qreal captureRate = 0);
 
 private:
     void querySupportedResolution() const;
+    void querySupportedFrameRates() const;
 
     AalCameraService *m_service;
     QVideoEncoderSettings m_settings;
     mutable QList<QSize> m_availableSizes;
+    mutable QList<qreal> m_frameRates;
 
     static const QSize DEFAULT_SIZE;
     static const int DEFAULT_FPS;
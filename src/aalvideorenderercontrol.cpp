@@ -17,6 +17,11 @@
 #include "aalvideorenderercontrol.h"
 #include "aalcameraservice.h"
 #include "aalviewfindersettingscontrol.h"
+#include "cameraworker.h"
+#include "haleventqueue.h"
+#include "startuptimeline.h"
+#include "halstatistics.h"
+#include "tracebuffer.h"
 
 #include <hybris/camera/camera_compatibility_layer.h>
 #include <hybris/camera/camera_compatibility_layer_capabilities.h>
@@ -71,7 +76,9 @@ AalVideoRendererControl::AalVideoRendererControl(AalCameraService *service, QObj
      m_service(service),
      m_viewFinderRunning(false),
      m_previewStarted(false),
-     m_textureId(0)
+     m_firstFramePresented(false),
+     m_textureId(0),
+     m_presentedFrames(0)
 {
     // Get notified when qtvideo-node creates a GL texture
     connect(SharedSignal::instance(), SIGNAL(textureCreated(unsigned int)), this, SLOT(onTextureCreated(unsigned int)));
@@ -105,6 +112,7 @@ void AalVideoRendererControl::init(CameraControl *control, CameraControlListener
 
 void AalVideoRendererControl::startPreview()
 {
+    TraceScope trace("preview: start");
     if (m_previewStarted) {
         return;
     }
@@ -113,11 +121,11 @@ void AalVideoRendererControl::startPreview()
         return;
     }
     m_previewStarted = true;
+    m_firstFramePresented = false;
+    StartupTimeline::mark("preview: start requested");
 
     if (m_textureId) {
-        CameraControl *cc = m_service->androidControl();
-        android_camera_set_preview_texture(cc, m_textureId);
-        android_camera_start_preview(cc);
+        m_service->cameraWorker()->startPreview(m_service->androidControl(), m_textureId);
     }
 
     // if no texture ID is set to the frame passed to ShaderVideoNode,
@@ -130,6 +138,7 @@ void AalVideoRendererControl::startPreview()
 
 void AalVideoRendererControl::stopPreview()
 {
+    TraceScope trace("preview: stop");
     if (!m_previewStarted) {
         return;
     }
@@ -146,10 +155,7 @@ void AalVideoRendererControl::stopPreview()
         m_surface->stop();
     }
 
-    CameraControl *cc = m_service->androidControl();
-    android_camera_stop_preview(cc);
-    // FIXME: missing android_camera_set_preview_size(QSize())
-    android_camera_set_preview_texture(cc, 0);
+    m_service->cameraWorker()->stopPreview(m_service->androidControl());
 
     m_previewStarted = false;
     m_service->updateCaptureReady();
@@ -160,8 +166,18 @@ bool AalVideoRendererControl::isPreviewStarted() const
     return m_previewStarted;
 }
 
+/*!
+ * \brief AalVideoRendererControl::presentedFrames returns how many viewfinder
+ * frames have been presented to the surface so far
+ */
+quint64 AalVideoRendererControl::presentedFrames() const
+{
+    return m_presentedFrames;
+}
+
 void AalVideoRendererControl::updateViewfinderFrame()
 {
+    TraceScope trace("preview: update frame");
     if (!m_service->viewfinderControl()) {
         qWarning() << "Can't draw video frame without a viewfinder settings control";
         return;
@@ -196,17 +212,30 @@ void AalVideoRendererControl::updateViewfinderFrame()
 
     if (m_surface->isActive()) {
         m_surface->present(frame);
+        ++m_presentedFrames;
+        // The first frame goes out without a texture, to have one created
+        if (m_textureId && !m_firstFramePresented) {
+            m_firstFramePresented = true;
+            StartupTimeline::finish("preview: first frame presented");
+            Q_EMIT firstFramePresented();
+        }
     }
 }
 
 void AalVideoRendererControl::onTextureCreated(GLuint textureID)
 {
     m_textureId = textureID;
+    StartupTimeline::mark("preview: texture created");
+    TraceBuffer::instant("preview: texture created");
     CameraControl *cc = m_service->androidControl();
     if (cc) {
-        android_camera_set_preview_texture(cc, m_textureId);
         if (m_textureId && m_previewStarted) {
-            android_camera_start_preview(cc);
+            m_service->cameraWorker()->startPreview(cc, m_textureId);
+        } else {
+            GLuint textureId = m_textureId;
+            m_service->cameraWorker()->post([cc, textureId]() {
+                AAL_HAL_CALL(android_camera_set_preview_texture(cc, textureId));
+            });
         }
     }
     m_service->updateCaptureReady();
@@ -220,10 +249,10 @@ void AalVideoRendererControl::onSnapshotTaken(QImage snapshotImage)
 
 void AalVideoRendererControl::updateViewfinderFrameCB(void* context)
 {
-    Q_UNUSED(context);
-    AalVideoRendererControl *self = AalCameraService::instance()->videoOutputControl();
-    if (self->m_previewStarted) {
-        QMetaObject::invokeMethod(self, "updateViewfinderFrame", Qt::QueuedConnection);
+    TraceBuffer::instant("hal: preview frame");
+    AalCameraService *service = static_cast<AalCameraService*>(context);
+    if (service->videoOutputControl()->m_previewStarted) {
+        service->halEvents()->post(HalEventQueue::PreviewFrameEvent);
     }
 }
 
@@ -41,6 +41,7 @@ public:
     void createPreview();
 
     bool isPreviewStarted() const;
+    quint64 presentedFrames() const;
 
 public Q_SLOTS:
     void init(CameraControl *control, CameraControlListener *listener);
@@ -50,6 +51,7 @@ public Q_SLOTS:
 Q_SIGNALS:
     void surfaceChanged(QAbstractVideoSurface *surface);
     void previewReady();
+    void firstFramePresented();
 
 private Q_SLOTS:
     void updateViewfinderFrame();
@@ -62,8 +64,10 @@ private:
 
     bool m_viewFinderRunning;
     bool m_previewStarted;
+    bool m_firstFramePresented;
     GLuint m_textureId;
     QImage m_preview;
+    quint64 m_presentedFrames;
 };
 
 #endif
@@ -17,8 +17,13 @@
 #include "aalviewfindersettingscontrol.h"
 #include "aalcameraservice.h"
 #include "aalvideorenderercontrol.h"
+#include "cameraproperties.h"
+#include "halstatistics.h"
 
 #include <QDebug>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QtMath>
 
 #include <hybris/camera/camera_compatibility_layer_capabilities.h>
 
@@ -29,8 +34,18 @@ AalViewfinderSettingsControl::AalViewfinderSettingsControl(AalCameraService *ser
       m_aspectRatio(0.0),
       m_currentFPS(30),
       m_minFPS(10),
-      m_maxFPS(30)
+      m_maxFPS(30),
+      m_requestedMinFPS(0),
+      m_requestedMaxFPS(0),
+      m_recordingFPS(0),
+      m_sizePolicy(OutputSizePolicy),
+      m_zoomHeadroom(1.0)
 {
+    QString policy = CameraProperties::stringValue("aal.camera.viewfinder.policy");
+    if (policy == QLatin1String("largest")) {
+        m_sizePolicy = LargestSizePolicy;
+    }
+    m_zoomHeadroom = qMax(qreal(1.0), CameraProperties::realValue("aal.camera.viewfinder.headroom", 1.0));
 }
 
 AalViewfinderSettingsControl::~AalViewfinderSettingsControl()
@@ -60,8 +75,12 @@ void AalViewfinderSettingsControl::setViewfinderParameter(ViewfinderParameter pa
         setSize(value.toSize());
         break;
     case QCameraViewfinderSettingsControl::MinimumFrameRate:
+        m_requestedMinFPS = qMax(0, qRound(value.toReal()));
+        setPreviewFrameRate(m_currentFPS);
+        break;
     case QCameraViewfinderSettingsControl::MaximumFrameRate:
-        qWarning() << "Camera framerate boundaries are set by the backend";
+        m_requestedMaxFPS = qMax(0, qRound(value.toReal()));
+        setPreviewFrameRate(m_currentFPS);
         break;
     default:
         break;
@@ -79,9 +98,9 @@ QVariant AalViewfinderSettingsControl::viewfinderParameter(ViewfinderParameter p
     case QCameraViewfinderSettingsControl::Resolution:
         return m_currentSize;
     case QCameraViewfinderSettingsControl::MinimumFrameRate:
-        return m_minFPS;
+        return minimumFrameRate();
     case QCameraViewfinderSettingsControl::MaximumFrameRate:
-        return m_maxFPS;
+        return maximumFrameRate();
     default:
         break;
     }
@@ -107,15 +126,20 @@ void AalViewfinderSettingsControl::setSize(const QSize &size)
     }
 
     m_currentSize = size;
+    applyPreviewSize();
+}
 
-    bool wasPreviewStarted = m_service->isPreviewStarted();
-    if (wasPreviewStarted) {
-        m_service->stopPreview();
-    }
-    android_camera_set_preview_size(cc, m_currentSize.width(), m_currentSize.height());
-    if (wasPreviewStarted) {
-        m_service->startPreview();
-    }
+/*!
+ * \brief AalViewfinderSettingsControl::applyPreviewSize sends the current size
+ * to the camera. The preview is restarted by the service if needed.
+ */
+void AalViewfinderSettingsControl::applyPreviewSize()
+{
+    QSize size = m_currentSize;
+    m_service->setCameraParameter(AalCameraService::PreviewSizeParameter,
+                                  [size](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_set_preview_size(cc, size.width(), size.height()));
+    }, true);
 }
 
 QSize AalViewfinderSettingsControl::currentSize() const
@@ -130,14 +154,8 @@ QSize AalViewfinderSettingsControl::currentSize() const
  */
 const QList<QSize> &AalViewfinderSettingsControl::supportedSizes() const
 {
-    if (m_availableSizes.isEmpty()) {
-        CameraControl *cc = m_service->androidControl();
-        if (cc) {
-            AalViewfinderSettingsControl *vfControl = const_cast<AalViewfinderSettingsControl*>(this);
-            android_camera_enumerate_supported_preview_sizes(cc,
-                                                             &AalViewfinderSettingsControl::sizeCB,
-                                                             vfControl);
-        }
+    if (m_availableSizes.isEmpty() && m_service->androidControl()) {
+        m_availableSizes = m_service->capabilities().previewSizes;
     }
 
     return m_availableSizes;
@@ -159,25 +177,187 @@ void AalViewfinderSettingsControl::setAspectRatio(float ratio)
     setSize(size);
 }
 
+AalViewfinderSettingsControl::SizePolicy AalViewfinderSettingsControl::sizePolicy() const
+{
+    return m_sizePolicy;
+}
+
+/*!
+ * \brief AalViewfinderSettingsControl::setSizePolicy sets how the viewfinder
+ * resolution is chosen among the sizes matching the aspect ratio
+ */
+void AalViewfinderSettingsControl::setSizePolicy(SizePolicy policy)
+{
+    if (policy == m_sizePolicy)
+        return;
+
+    m_sizePolicy = policy;
+    if (m_service->androidControl() && !m_availableSizes.isEmpty()) {
+        setSize(chooseOptimalSize(m_availableSizes));
+    }
+}
+
+QSize AalViewfinderSettingsControl::outputSize() const
+{
+    return m_outputSize;
+}
+
+/*!
+ * \brief AalViewfinderSettingsControl::setOutputSize sets the size in pixels of
+ * the surface the viewfinder is rendered to. If no size is set, the size of
+ * the primary screen is used instead.
+ */
+void AalViewfinderSettingsControl::setOutputSize(const QSize &size)
+{
+    if (size == m_outputSize)
+        return;
+
+    m_outputSize = size;
+    if (m_service->androidControl() && !m_availableSizes.isEmpty()) {
+        setSize(chooseOptimalSize(m_availableSizes));
+    }
+}
+
+qreal AalViewfinderSettingsControl::zoomHeadroom() const
+{
+    return m_zoomHeadroom;
+}
+
+/*!
+ * \brief AalViewfinderSettingsControl::setZoomHeadroom sets by which factor the
+ * viewfinder resolution may exceed the output size, so that digital zoom does
+ * not immediately upscale the preview. 1.0 means no headroom.
+ */
+void AalViewfinderSettingsControl::setZoomHeadroom(qreal headroom)
+{
+    headroom = qMax(qreal(1.0), headroom);
+    if (qFuzzyCompare(headroom, m_zoomHeadroom))
+        return;
+
+    m_zoomHeadroom = headroom;
+    if (m_service->androidControl() && !m_availableSizes.isEmpty()) {
+        setSize(chooseOptimalSize(m_availableSizes));
+    }
+}
+
+/*!
+ * \brief AalViewfinderSettingsControl::sizeLimit returns the landscape size
+ * the viewfinder resolution is capped to, or an invalid size if there is no cap
+ */
+QSize AalViewfinderSettingsControl::sizeLimit() const
+{
+    if (m_sizePolicy == LargestSizePolicy)
+        return QSize();
+
+    QSize size = m_outputSize.isValid() ? m_outputSize : screenSize();
+    if (!size.isValid() || size.isEmpty())
+        return QSize();
+
+    // Preview sizes are always reported in landscape
+    if (size.height() > size.width())
+        size.transpose();
+
+    return QSize(qCeil(size.width() * m_zoomHeadroom), qCeil(size.height() * m_zoomHeadroom));
+}
+
 void AalViewfinderSettingsControl::init(CameraControl *control, CameraControlListener *listener)
 {
+    Q_UNUSED(control);
     Q_UNUSED(listener);
 
     if (m_availableSizes.isEmpty()) {
-        android_camera_enumerate_supported_preview_sizes(control, &AalViewfinderSettingsControl::sizeCB, this);
+        m_availableSizes = m_service->capabilities().previewSizes;
     }
 
     // Choose optimal resolution based on the current camera's aspect ratio
     if (m_currentSize.isEmpty()) {
         m_currentSize = chooseOptimalSize(m_availableSizes);
     }
-    android_camera_set_preview_size(control, m_currentSize.width(), m_currentSize.height());
+    applyPreviewSize();
 
-    android_camera_get_preview_fps_range(control, &m_minFPS, &m_maxFPS);
-    m_minFPS /= 1000;
-    m_maxFPS /= 1000;
-    m_currentFPS = m_maxFPS;
-    android_camera_set_preview_fps(control, m_currentFPS);
+    m_minFPS = m_service->capabilities().minFPS;
+    m_maxFPS = m_service->capabilities().maxFPS;
+    m_currentFPS = maximumFrameRate();
+    applyPreviewFrameRate();
+}
+
+/*!
+ * \brief AalViewfinderSettingsControl::minimumFrameRate returns the lowest frame
+ * rate the viewfinder may run at: the requested minimum, within what the camera
+ * supports, or the frame rate of the recording while there is one
+ */
+int AalViewfinderSettingsControl::minimumFrameRate() const
+{
+    if (m_recordingFPS > 0)
+        return maximumFrameRate();
+
+    int minFPS = m_minFPS;
+    if (m_requestedMinFPS > 0)
+        minFPS = qMax(minFPS, m_requestedMinFPS);
+
+    return qMin(minFPS, maximumFrameRate());
+}
+
+/*!
+ * \brief AalViewfinderSettingsControl::maximumFrameRate returns the highest frame
+ * rate the viewfinder may run at: the requested maximum, within what the camera
+ * supports, or the frame rate of the recording while there is one
+ */
+int AalViewfinderSettingsControl::maximumFrameRate() const
+{
+    if (m_recordingFPS > 0)
+        return m_maxFPS > 0 ? qBound(m_minFPS, m_recordingFPS, m_maxFPS) : m_recordingFPS;
+
+    if (m_requestedMaxFPS > 0 && (m_maxFPS <= 0 || m_requestedMaxFPS < m_maxFPS))
+        return qMax(m_requestedMaxFPS, m_minFPS);
+
+    return m_maxFPS;
+}
+
+int AalViewfinderSettingsControl::previewFrameRate() const
+{
+    return m_currentFPS;
+}
+
+/*!
+ * \brief AalViewfinderSettingsControl::setPreviewFrameRate changes the frame rate
+ * of the running viewfinder, clamped to the allowed frame rate range
+ */
+void AalViewfinderSettingsControl::setPreviewFrameRate(int fps)
+{
+    fps = qBound(minimumFrameRate(), fps, maximumFrameRate());
+    if (fps == m_currentFPS)
+        return;
+
+    m_currentFPS = fps;
+    if (m_service->androidControl()) {
+        applyPreviewFrameRate();
+    }
+}
+
+int AalViewfinderSettingsControl::recordingFrameRate() const
+{
+    return m_recordingFPS;
+}
+
+/*!
+ * \brief AalViewfinderSettingsControl::setRecordingFrameRate pins the
+ * viewfinder to the frame rate of a recording, as the recorder takes its frames
+ * from the preview; 0 releases it
+ */
+void AalViewfinderSettingsControl::setRecordingFrameRate(int fps)
+{
+    m_recordingFPS = qMax(0, fps);
+    setPreviewFrameRate(maximumFrameRate());
+}
+
+void AalViewfinderSettingsControl::applyPreviewFrameRate()
+{
+    int fps = m_currentFPS;
+    m_service->setCameraParameter(AalCameraService::PreviewFrameRateParameter,
+                                  [fps](CameraControl *cc) {
+        AAL_HAL_CALL(android_camera_set_preview_fps(cc, fps));
+    });
 }
 
 /*! Resets all data, so a new init starts with a fresh start
@@ -197,22 +377,66 @@ void AalViewfinderSettingsControl::resetAllSettings()
     m_maxFPS = 0;
 }
 
-void AalViewfinderSettingsControl::sizeCB(void *ctx, int width, int height)
-{
-    AalViewfinderSettingsControl *self = (AalViewfinderSettingsControl*)ctx;
-    self->m_availableSizes.append(QSize(width, height));
-}
-
 QSize AalViewfinderSettingsControl::chooseOptimalSize(const QList<QSize> &sizes) const
 {
-    if (!sizes.empty()) {
-        if (m_aspectRatio == 0) {
-            // There are resolutions supported, choose one non-optimal one):
-            return sizes[1];
-        } else {
-            return m_service->selectSizeWithAspectRatio(sizes, m_aspectRatio);
+    if (sizes.empty())
+        return QSize();
+
+    // The sizes matching the aspect ratio are the ones the service would pick
+    // on their own, and the biggest of them is what it picks from the list
+    QList<QSize> candidates;
+    QSize largestSize;
+    if (m_aspectRatio == 0) {
+        candidates = sizes;
+        Q_FOREACH (const QSize &size, sizes) {
+            if ((long)size.width() * (long)size.height() >
+                    (long)largestSize.width() * (long)largestSize.height()) {
+                largestSize = size;
+            }
+        }
+    } else {
+        largestSize = m_service->selectSizeWithAspectRatio(sizes, m_aspectRatio);
+        if (!largestSize.isValid())
+            return QSize();
+
+        Q_FOREACH (const QSize &size, sizes) {
+            if (m_service->aspectRatioMatches(size, m_aspectRatio))
+                candidates.append(size);
+        }
+    }
+
+    // Prefer the smallest size covering the output, and fall back to the
+    // biggest one if none of them are big enough
+    QSize limit = sizeLimit();
+    QSize coveringSize;
+    Q_FOREACH (const QSize &size, candidates) {
+        const long pixelCount = (long)size.width() * (long)size.height();
+        if (limit.isValid() && size.width() >= limit.width() && size.height() >= limit.height() &&
+                (!coveringSize.isValid() ||
+                 pixelCount < (long)coveringSize.width() * (long)coveringSize.height())) {
+            coveringSize = size;
         }
     }
 
-    return QSize();
+    QSize selectedSize = coveringSize.isValid() ? coveringSize : largestSize;
+    qDebug() << "Viewfinder size" << selectedSize << "selected with policy" << m_sizePolicy
+             << "and size limit" << limit;
+    return selectedSize;
+}
+
+/*!
+ * \brief AalViewfinderSettingsControl::screenSize returns the size of the primary
+ * screen in pixels, or an invalid size if there is no screen
+ */
+QSize AalViewfinderSettingsControl::screenSize() const
+{
+    QGuiApplication *application = qobject_cast<QGuiApplication*>(QCoreApplication::instance());
+    if (!application)
+        return QSize();
+
+    QScreen *screen = application->primaryScreen();
+    if (!screen)
+        return QSize();
+
+    return screen->size() * screen->devicePixelRatio();
 }
@@ -28,6 +28,13 @@ struct CameraControlListener;
 class AalViewfinderSettingsControl : public QCameraViewfinderSettingsControl
 {
 public:
+    enum SizePolicy {
+        /// Always use the biggest preview size matching the aspect ratio
+        LargestSizePolicy,
+        /// Use the smallest preview size that still covers the output size
+        OutputSizePolicy
+    };
+
     AalViewfinderSettingsControl(AalCameraService *service, QObject *parent = 0);
     ~AalViewfinderSettingsControl();
 
@@ -40,14 +47,30 @@ public:
 
     void setAspectRatio(float ratio);
 
+    SizePolicy sizePolicy() const;
+    void setSizePolicy(SizePolicy policy);
+    QSize outputSize() const;
+    void setOutputSize(const QSize &size);
+    qreal zoomHeadroom() const;
+    void setZoomHeadroom(qreal headroom);
+    QSize sizeLimit() const;
+
+    int minimumFrameRate() const;
+    int maximumFrameRate() const;
+    int previewFrameRate() const;
+    void setPreviewFrameRate(int fps);
+    int recordingFrameRate() const;
+    void setRecordingFrameRate(int fps);
+
     void init(CameraControl *control, CameraControlListener *listener);
     void resetAllSettings();
 
-    static void sizeCB(void* ctx, int width, int height);
-
 private:
     void setSize(const QSize &size);
+    void applyPreviewSize();
+    void applyPreviewFrameRate();
     QSize chooseOptimalSize(const QList<QSize> &sizes) const;
+    QSize screenSize() const;
 
     AalCameraService *m_service;
     QSize m_currentSize;
@@ -56,6 +79,12 @@ private:
     mutable QList<QSize> m_availableSizes;
     int m_minFPS;
     int m_maxFPS;
+    int m_requestedMinFPS;
+    int m_requestedMaxFPS;
+    int m_recordingFPS;
+    SizePolicy m_sizePolicy;
+    QSize m_outputSize;
+    qreal m_zoomHeadroom;
 };
 
 #endif // AALVIEWFINDERSETTINGSCONTROL_H
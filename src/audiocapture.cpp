@@ -17,33 +17,59 @@
  */
 
 #include "audiocapture.h"
+#include "cameraproperties.h"
+#include "halstatistics.h"
+#include "tracebuffer.h"
 
-#include <pulse/simple.h>
+#include <pulse/context.h>
 #include <pulse/error.h>
 #include <pulse/sample.h>
+#include <pulse/stream.h>
+#include <pulse/thread-mainloop.h>
 
 #include <errno.h>
 #include <fcntl.h>
 
+#include <QByteArray>
 #include <QDebug>
+#include <QMutexLocker>
 #include <QThread>
 
 AudioCapture::AudioCapture(MediaRecorderWrapper *mediaRecorder)
-    : m_paStream(NULL),
+    : m_mainloop(NULL),
+      m_context(NULL),
+      m_stream(NULL),
       m_audioPipe(-1),
       m_flagExit(false),
-      m_mediaRecorder(mediaRecorder)
+      m_mediaRecorder(mediaRecorder),
+      m_latency(0),
+      m_maximumLatency(0),
+      m_underruns(0)
 {
+    // How much microphone data PulseAudio collects before handing it over
+    m_fragmentTime = qMax(1, CameraProperties::intValue("aal.camera.audio_fragment", 20)) * 1000;
 }
 
 AudioCapture::~AudioCapture()
 {
-    android_recorder_set_audio_read_cb(m_mediaRecorder, NULL, NULL);
+    AAL_HAL_CALL(android_recorder_set_audio_read_cb(m_mediaRecorder, NULL, NULL));
+
+    // Once the mainloop thread stopped, nothing else touches the stream
+    if (m_mainloop != NULL)
+        pa_threaded_mainloop_stop(m_mainloop);
+    if (m_stream != NULL) {
+        pa_stream_disconnect(m_stream);
+        pa_stream_unref(m_stream);
+    }
+    if (m_context != NULL) {
+        pa_context_disconnect(m_context);
+        pa_context_unref(m_context);
+    }
+    if (m_mainloop != NULL)
+        pa_threaded_mainloop_free(m_mainloop);
 
     if (m_audioPipe >= 0)
         close(m_audioPipe);
-    if (m_paStream != NULL)
-        pa_simple_free(m_paStream);
 }
 
 /*!
@@ -52,30 +78,39 @@ AudioCapture::~AudioCapture()
 bool AudioCapture::init(RecorderReadAudioCallback callback, void *context)
 {
     // The MediaRecorderLayer will call method (callback) when it's ready to encode a new audio buffer
-    android_recorder_set_audio_read_cb(m_mediaRecorder, callback, context);
+    AAL_HAL_CALL(android_recorder_set_audio_read_cb(m_mediaRecorder, callback, context));
 
     return true;
 }
 
 /*!
- * \brief Stops the microphone data capture thread loop
+ * \brief Stops passing microphone data to the named pipe, and makes Pulse stop
+ * reading the microphone. It must come after the recorder stopped reading the
+ * pipe, which lets a write blocked in the mainloop thread fail.
  */
 void AudioCapture::stopCapture()
 {
-    qDebug() << __PRETTY_FUNCTION__;
+    if (m_mainloop == NULL) {
+        m_flagExit = true;
+        return;
+    }
+
+    pa_threaded_mainloop_lock(m_mainloop);
     m_flagExit = true;
+    setCorked(true);
+    pa_threaded_mainloop_unlock(m_mainloop);
 }
 
 /*!
- * \brief The main microphone reader/writer loop. Reads from Pulseaudio, writes to named pipe
+ * \brief Starts the microphone capture, once the recorder reads the named pipe.
+ * The data is then passed on as it arrives, from the PulseAudio mainloop thread.
  */
 void AudioCapture::run()
 {
-    m_flagExit = false;
-    qDebug() << __PRETTY_FUNCTION__;
+    TraceScope trace("audio: capture");
 
-    int bytesWritten = 0, bytesRead = 0;
-    const size_t readSize = sizeof(m_audioBuf);
+    if (m_stream == NULL)
+        return;
 
     if (!setupPipe())
     {
@@ -83,85 +118,112 @@ void AudioCapture::run()
         return;
     }
 
-    // To reduce latency, try to flush samples not read before this function is called.
-    {
-        int ret = 0, error = 0;
-        ret = pa_simple_flush(m_paStream, &error);
-        if (ret < 0) {
-            qWarning() << "Failed to flush sample not read before run(): " << pa_strerror(error)
-                       << " (but continuing anyway).";
-        }
-    }
-
-    do {
-        bytesRead = readMicrophone();
-        if (bytesRead > 0)
-        {
-            bytesWritten = writeDataToPipe();
-        }
-    } while (bytesRead == readSize
-                && bytesWritten == readSize
-                && !m_flagExit);
+    // The stream was created corked, so the first samples are the ones
+    // recorded from now on
+    pa_threaded_mainloop_lock(m_mainloop);
+    m_flagExit = false;
+    setCorked(false);
+    pa_threaded_mainloop_unlock(m_mainloop);
+}
 
-    // Make sure that Pulse stops reading the microphone when recording stops
-    if (m_paStream != NULL)
-    {
-        pa_simple_free(m_paStream);
-        m_paStream = NULL;
-    }
+/*!
+ * \brief Returns the capture latency of the microphone data last passed on:
+ * how long ago, in us, it was recorded
+ */
+qint64 AudioCapture::latency() const
+{
+    QMutexLocker locker(&m_latencyMutex);
+    return m_latency;
 }
 
 /*!
- * \brief Reads microphone data from Pulseaudio
+ * \brief Returns the highest capture latency measured, in us
  */
-int AudioCapture::readMicrophone()
+qint64 AudioCapture::maximumLatency() const
 {
-    int ret = 0, error = 0;
-    const size_t readSize = sizeof(m_audioBuf);
-    ret = pa_simple_read(m_paStream, m_audioBuf, readSize, &error);
-    if (ret < 0)
-        qWarning() << "Failed to read audio from the microphone: " << pa_strerror(error);
-    else
-        ret = readSize;
+    QMutexLocker locker(&m_latencyMutex);
+    return m_maximumLatency;
+}
 
-    return ret;
+/*!
+ * \brief Returns how many times microphone data was dropped because the
+ * recorder did not read the named pipe fast enough
+ */
+int AudioCapture::underruns() const
+{
+    QMutexLocker locker(&m_latencyMutex);
+    return m_underruns;
 }
 
 /*!
- * \brief Sets up the Pulseaudio microphone input channel
+ * \brief Sets up the Pulseaudio microphone input channel, in the format the
+ * recorder encodes, so that the samples are passed on as they are
  */
-int AudioCapture::setupMicrophoneStream()
+int AudioCapture::setupMicrophoneStream(int sampleRate, int channelCount)
 {
-    // FIXME: Get these parameters more dynamically from the control
-    static const pa_sample_spec ss = {
+    const pa_sample_spec ss = {
         .format = PA_SAMPLE_S16LE,
-        .rate = 48000,
-        .channels = 1
+        .rate = uint32_t(sampleRate),
+        .channels = uint8_t(channelCount)
     };
 
     /*
-     * On some device, it can take some time between pa_simple_new() below and
-     * first pa_simple_read(). By setting these buffer attributes, we try to
-     * make PulseAudio drop (initially) unread samples. Otherwise, we'll get
-     * those samples and write them into /dev/socket/micshm, which expects
-     * (roughly) realtime audio. This causes A/V desync as those extra samples
-     * will advance /dev/socket/micshm's internal timestamp ahead.
-     *
-     * I actually want to set PA_STREAM_ADJUST_LATENCY to the stream, but it
-     * seems to be impossible with PA's simple API.
+     * /dev/socket/micshm expects (roughly) realtime audio: samples delivered
+     * late advance its internal timestamp ahead, and cause A/V desync. With
+     * PA_STREAM_ADJUST_LATENCY, PulseAudio configures the source for the
+     * fragment size, rather than buffering up to its own default latency.
+     * Whatever is not read within maxlength is dropped.
      */
-    static const pa_buffer_attr buf_attr = {
-        .maxlength = pa_usec_to_bytes(100000 /* 100 msec */, &ss),
+    const pa_buffer_attr buf_attr = {
+        .maxlength = (uint32_t) pa_usec_to_bytes(qMax(100000 /* 100 msec */, 4 * m_fragmentTime), &ss),
         .tlength = (uint32_t) -1,
         .prebuf = (uint32_t) -1,
         .minreq = (uint32_t) -1,
-        .fragsize = pa_usec_to_bytes(100000 /* 100 msec */, &ss)
+        .fragsize = (uint32_t) pa_usec_to_bytes(m_fragmentTime, &ss)
     };
+    const pa_stream_flags_t flags = pa_stream_flags_t(PA_STREAM_ADJUST_LATENCY | PA_STREAM_START_CORKED |
+                                                      PA_STREAM_INTERPOLATE_TIMING |
+                                                      PA_STREAM_AUTO_TIMING_UPDATE);
+
+    m_mainloop = pa_threaded_mainloop_new();
+    if (m_mainloop == NULL) {
+        qWarning() << "Failed to create a PulseAudio mainloop";
+        return AUDIO_CAPTURE_GENERAL_ERROR;
+    }
+    m_context = pa_context_new(pa_threaded_mainloop_get_api(m_mainloop), "qtubuntu-camera");
+    if (m_context == NULL) {
+        qWarning() << "Failed to create a PulseAudio context";
+        return AUDIO_CAPTURE_GENERAL_ERROR;
+    }
+    pa_context_set_state_callback(m_context, &AudioCapture::contextStateCallback, this);
+    if (pa_threaded_mainloop_start(m_mainloop) < 0) {
+        qWarning() << "Failed to start the PulseAudio mainloop";
+        return AUDIO_CAPTURE_GENERAL_ERROR;
+    }
 
     int error = 0;
+    pa_threaded_mainloop_lock(m_mainloop);
+    if (pa_context_connect(m_context, NULL, PA_CONTEXT_NOFLAGS, NULL) < 0)
+        error = pa_context_errno(m_context);
+    else
+        error = waitForContext();
+
+    if (error == 0) {
+        m_stream = pa_stream_new(m_context, "record", &ss, NULL);
+        if (m_stream == NULL)
+            error = pa_context_errno(m_context);
+    }
+    if (error == 0) {
+        pa_stream_set_state_callback(m_stream, &AudioCapture::streamStateCallback, this);
+        pa_stream_set_read_callback(m_stream, &AudioCapture::streamReadCallback, this);
+        if (pa_stream_connect_record(m_stream, NULL, &buf_attr, flags) < 0)
+            error = pa_context_errno(m_context);
+        else
+            error = waitForStream();
+    }
+    pa_threaded_mainloop_unlock(m_mainloop);
 
-    m_paStream = pa_simple_new(NULL, "qtubuntu-camera", PA_STREAM_RECORD, NULL, "record", &ss, NULL, &buf_attr, &error);
-    if (m_paStream == NULL)
+    if (error != 0)
     {
         qWarning() << "Failed to open a PulseAudio channel to read the microphone: " << pa_strerror(error);
         if (error == PA_ERR_TIMEOUT) {
@@ -174,8 +236,131 @@ int AudioCapture::setupMicrophoneStream()
     return 0;
 }
 
+void AudioCapture::contextStateCallback(pa_context *context, void *userdata)
+{
+    Q_UNUSED(context);
+    AudioCapture *thiz = static_cast<AudioCapture*>(userdata);
+    pa_threaded_mainloop_signal(thiz->m_mainloop, 0);
+}
+
+void AudioCapture::streamStateCallback(pa_stream *stream, void *userdata)
+{
+    Q_UNUSED(stream);
+    AudioCapture *thiz = static_cast<AudioCapture*>(userdata);
+    pa_threaded_mainloop_signal(thiz->m_mainloop, 0);
+}
+
+void AudioCapture::streamReadCallback(pa_stream *stream, size_t length, void *userdata)
+{
+    Q_UNUSED(stream);
+    Q_UNUSED(length);
+    AudioCapture *thiz = static_cast<AudioCapture*>(userdata);
+    thiz->readMicrophone();
+}
+
+/*!
+ * \brief Waits, with the mainloop locked, for the context to connect
+ * \return 0 once it is ready, the PulseAudio error otherwise
+ */
+int AudioCapture::waitForContext()
+{
+    for (;;) {
+        pa_context_state_t state = pa_context_get_state(m_context);
+        if (state == PA_CONTEXT_READY)
+            return 0;
+        if (!PA_CONTEXT_IS_GOOD(state)) {
+            int error = pa_context_errno(m_context);
+            return error != 0 ? error : int(PA_ERR_UNKNOWN);
+        }
+        pa_threaded_mainloop_wait(m_mainloop);
+    }
+}
+
+/*!
+ * \brief Waits, with the mainloop locked, for the record stream to be set up
+ * \return 0 once it is ready, the PulseAudio error otherwise
+ */
+int AudioCapture::waitForStream()
+{
+    for (;;) {
+        pa_stream_state_t state = pa_stream_get_state(m_stream);
+        if (state == PA_STREAM_READY)
+            return 0;
+        if (!PA_STREAM_IS_GOOD(state)) {
+            int error = pa_context_errno(m_context);
+            return error != 0 ? error : int(PA_ERR_UNKNOWN);
+        }
+        pa_threaded_mainloop_wait(m_mainloop);
+    }
+}
+
+/*!
+ * \brief Pauses or resumes the capture; the mainloop must be locked
+ */
+void AudioCapture::setCorked(bool corked)
+{
+    if (m_stream == NULL)
+        return;
+
+    pa_operation *operation = pa_stream_cork(m_stream, corked ? 1 : 0, NULL, NULL);
+    if (operation != NULL)
+        pa_operation_unref(operation);
+}
+
+/*!
+ * \brief Passes the microphone data PulseAudio has to the named pipe. It runs
+ * in the PulseAudio mainloop thread, with the mainloop locked.
+ */
+void AudioCapture::readMicrophone()
+{
+    TraceScope trace("audio: read microphone");
+
+    while (pa_stream_readable_size(m_stream) > 0) {
+        const void *data = NULL;
+        size_t size = 0;
+        if (pa_stream_peek(m_stream, &data, &size) < 0) {
+            qWarning() << "Failed to read audio from the microphone: "
+                       << pa_strerror(pa_context_errno(m_context));
+            return;
+        }
+        if (size == 0)
+            break;
+
+        if (!m_flagExit) {
+            if (data != NULL) {
+                writeDataToPipe(data, size);
+            } else {
+                // A hole in the recording: keep the timeline with silence
+                QByteArray silence(int(size), 0);
+                writeDataToPipe(silence.constData(), size);
+            }
+        }
+        pa_stream_drop(m_stream);
+    }
+
+    updateLatency();
+}
+
+/*!
+ * \brief Samples the time between the recording of the microphone data and
+ * its reading
+ */
+void AudioCapture::updateLatency()
+{
+    pa_usec_t usec = 0;
+    int negative = 0;
+    // No timing information yet
+    if (pa_stream_get_latency(m_stream, &usec, &negative) < 0)
+        return;
+
+    QMutexLocker locker(&m_latencyMutex);
+    m_latency = negative ? 0 : qint64(usec);
+    m_maximumLatency = qMax(m_maximumLatency, m_latency);
+}
+
 /*!
- * \brief Opens the named pipe /dev/socket/micshm for writing mic data to the Android (reader) side
+ * \brief Opens the named pipe /dev/socket/micshm for writing mic data to the Android (reader) side.
+ * Writes to it don't block, as they happen with the PulseAudio mainloop locked.
  */
 bool AudioCapture::setupPipe()
 {
@@ -193,26 +378,43 @@ bool AudioCapture::setupPipe()
         return false;
     }
 
+    // Opened blocking first, so that the open still waits for the reader
+    int flags = fcntl(m_audioPipe, F_GETFL);
+    if (flags < 0 || fcntl(m_audioPipe, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        qWarning() << "Failed to make audio data pipe /dev/socket/micshm non-blocking: " << strerror(errno);
+        close(m_audioPipe);
+        m_audioPipe = -1;
+        return false;
+    }
+
     return true;
 }
 
 /*!
- * \brief Writes mic data to the named pipe /dev/socket/micshm
+ * \brief Writes mic data to the named pipe /dev/socket/micshm. When the pipe
+ * is full, the rest of the fragment is dropped and counted as an underrun. Once
+ * the recorder stops reading, the capture ends.
  */
-int AudioCapture::writeDataToPipe()
+int AudioCapture::writeDataToPipe(const void *data, size_t size)
 {
-    // Don't open the named pipe twice
-    if (m_audioPipe < 0 && !setupPipe())
-    {
-        qWarning() << "Failed to open /dev/socket/micshm, cannot write data to pipe";
+    TraceScope trace("audio: write pipe");
+
+    if (m_audioPipe < 0)
         return 0;
-    }
 
-    int num = 0;
-    const size_t writeSize = sizeof(m_audioBuf);
-    num = loopWrite(m_audioPipe, m_audioBuf, writeSize);
-    if (num != writeSize)
-        qWarning() << "Failed to write " << num << " bytes to /dev/socket/micshm: " << strerror(errno) << " (" << errno << ")";
+    ssize_t num = loopWrite(m_audioPipe, data, size);
+    if (num < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        TraceBuffer::instant("audio: underrun");
+        QMutexLocker locker(&m_latencyMutex);
+        ++m_underruns;
+        return 0;
+    }
+    if (num != ssize_t(size)) {
+        qWarning() << "Failed to write " << size << " bytes to /dev/socket/micshm: " << strerror(errno) << " (" << errno << ")";
+        m_flagExit = true;
+        setCorked(true);
+    }
 
     return num;
 }
@@ -228,7 +430,7 @@ ssize_t AudioCapture::loopWrite(int fd, const void *data, size_t size)
         if (r == 0)
             break;
         ret += r;
-        data = (const int16_t*) data + r;
+        data = (const char*) data + r;
         size -= (size_t) r;
     }
     return ret;
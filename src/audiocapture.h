@@ -23,12 +23,15 @@
 
 #include <stdint.h>
 
+#include <QMutex>
 #include <QObject>
 
 class AalMediaRecorderControl;
 struct MediaRecorderWrapper;
 
-struct pa_simple;
+struct pa_context;
+struct pa_stream;
+struct pa_threaded_mainloop;
 
 class AudioCapture : public QObject
 {
@@ -43,25 +46,43 @@ public:
     ~AudioCapture();
 
     bool init(RecorderReadAudioCallback callback, void *context);
-    /* Terminates the Pulseaudio reader/writer QThread */
-    int setupMicrophoneStream();
+    int setupMicrophoneStream(int sampleRate, int channelCount);
+    /* Stops passing microphone data on to the recorder */
     void stopCapture();
 
+    qint64 latency() const;
+    qint64 maximumLatency() const;
+    int underruns() const;
+
 public Q_SLOTS:
     void run();
 
 private:
-    int readMicrophone();
+    static void contextStateCallback(pa_context *context, void *userdata);
+    static void streamStateCallback(pa_stream *stream, void *userdata);
+    static void streamReadCallback(pa_stream *stream, size_t length, void *userdata);
+    int waitForContext();
+    int waitForStream();
+    void setCorked(bool corked);
+    void readMicrophone();
+    void updateLatency();
     bool setupPipe();
     ssize_t loopWrite(int fd, const void *data, size_t len);
-    int writeDataToPipe();
+    int writeDataToPipe(const void *data, size_t size);
 
-    pa_simple *m_paStream;
-    int16_t m_audioBuf[MIC_READ_BUF_SIZE];
+    pa_threaded_mainloop *m_mainloop;
+    pa_context *m_context;
+    pa_stream *m_stream;
+    int m_fragmentTime;
 
     int m_audioPipe;
     bool m_flagExit;
     MediaRecorderWrapper *m_mediaRecorder;
+
+    mutable QMutex m_latencyMutex;
+    qint64 m_latency;
+    qint64 m_maximumLatency;
+    int m_underruns;
 };
 
 #endif // AUDIOCAPTURE_H
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cameracapabilitycache.h"
+#include "cameraproperties.h"
+#include "halstatistics.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QStringList>
+
+#include <hybris/camera/camera_compatibility_layer.h>
+
+QHash<QString, CameraCapabilities> CameraCapabilityCache::m_cache;
+QMutex CameraCapabilityCache::m_cacheMutex;
+
+namespace {
+
+QStringList sizesToStrings(const QList<QSize> &sizes)
+{
+    QStringList result;
+    Q_FOREACH (const QSize &size, sizes) {
+        result << QString("%1x%2").arg(size.width()).arg(size.height());
+    }
+    return result;
+}
+
+QList<QSize> stringsToSizes(const QStringList &strings)
+{
+    QList<QSize> result;
+    Q_FOREACH (const QString &string, strings) {
+        QStringList dimensions = string.split('x');
+        if (dimensions.size() == 2) {
+            result << QSize(dimensions[0].toInt(), dimensions[1].toInt());
+        }
+    }
+    return result;
+}
+
+QStringList intsToStrings(const QList<int> &values)
+{
+    QStringList result;
+    Q_FOREACH (int value, values) {
+        result << QString::number(value);
+    }
+    return result;
+}
+
+QList<int> stringsToInts(const QStringList &strings)
+{
+    QList<int> result;
+    Q_FOREACH (const QString &string, strings) {
+        result << string.toInt();
+    }
+    return result;
+}
+
+}
+
+CameraCapabilityCache::CameraCapabilityCache()
+{
+    m_fingerprint = CameraProperties::stringValue("ro.build.fingerprint");
+
+    if (CameraProperties::boolValue("aal.camera.capability_cache.persist", true)) {
+        QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        if (!cacheDir.isEmpty()) {
+            m_fileName = QDir(cacheDir).filePath("camera-capabilities.ini");
+        }
+    }
+}
+
+/*!
+ * \brief CameraCapabilityCache::capabilities returns the capabilities of the
+ * given device, querying the connected camera only if they are not cached yet
+ * \param deviceId the ID of the connected device
+ * \param control the connected camera
+ */
+CameraCapabilities CameraCapabilityCache::capabilities(int deviceId, CameraControl *control)
+{
+    QMutexLocker locker(&m_cacheMutex);
+    QString cacheKey = key(deviceId);
+    if (m_cache.contains(cacheKey)) {
+        return m_cache.value(cacheKey);
+    }
+
+    CameraCapabilities result;
+    if (load(deviceId, &result)) {
+        m_cache.insert(cacheKey, result);
+        return result;
+    }
+
+    result = query(control);
+    // Don't remember a camera that did not report anything, it may just not
+    // have been ready
+    if (!result.isEmpty()) {
+        m_cache.insert(cacheKey, result);
+        save(deviceId, result);
+    }
+
+    return result;
+}
+
+/*!
+ * \brief CameraCapabilityCache::clear drops all the cached capabilities, in
+ * memory and on disk
+ */
+void CameraCapabilityCache::clear()
+{
+    QMutexLocker locker(&m_cacheMutex);
+    m_cache.clear();
+
+    if (!m_fileName.isEmpty()) {
+        QSettings settings(m_fileName, QSettings::IniFormat);
+        settings.clear();
+    }
+}
+
+CameraCapabilities CameraCapabilityCache::query(CameraControl *control)
+{
+    CameraCapabilities capabilities;
+
+    AAL_HAL_CALL(android_camera_enumerate_supported_preview_sizes(control, &CameraCapabilityCache::sizeCallback,
+                                                                  &capabilities.previewSizes));
+    AAL_HAL_CALL(android_camera_enumerate_supported_picture_sizes(control, &CameraCapabilityCache::sizeCallback,
+                                                                  &capabilities.pictureSizes));
+    AAL_HAL_CALL(android_camera_enumerate_supported_thumbnail_sizes(control, &CameraCapabilityCache::sizeCallback,
+                                                                    &capabilities.thumbnailSizes));
+    AAL_HAL_CALL(android_camera_enumerate_supported_video_sizes(control, &CameraCapabilityCache::sizeCallback,
+                                                                &capabilities.videoSizes));
+    AAL_HAL_CALL(android_camera_enumerate_supported_flash_modes(control, &CameraCapabilityCache::flashModeCallback,
+                                                                &capabilities.flashModes));
+    AAL_HAL_CALL(android_camera_enumerate_supported_scene_modes(control, &CameraCapabilityCache::sceneModeCallback,
+                                                                &capabilities.sceneModes));
+
+    AAL_HAL_CALL(android_camera_get_preview_fps_range(control, &capabilities.minFPS, &capabilities.maxFPS));
+    capabilities.minFPS /= 1000;
+    capabilities.maxFPS /= 1000;
+
+    AAL_HAL_CALL(android_camera_get_max_zoom(control, &capabilities.maxZoom));
+
+    return capabilities;
+}
+
+void CameraCapabilityCache::sizeCallback(void *context, int width, int height)
+{
+    QList<QSize> *sizes = static_cast<QList<QSize>*>(context);
+    sizes->append(QSize(width, height));
+}
+
+void CameraCapabilityCache::flashModeCallback(void *context, FlashMode flashMode)
+{
+    QList<int> *modes = static_cast<QList<int>*>(context);
+    modes->append(flashMode);
+}
+
+void CameraCapabilityCache::sceneModeCallback(void *context, SceneMode sceneMode)
+{
+    QList<int> *modes = static_cast<QList<int>*>(context);
+    modes->append(sceneMode);
+}
+
+QString CameraCapabilityCache::key(int deviceId) const
+{
+    return QString("%1#%2").arg(m_fingerprint).arg(deviceId);
+}
+
+bool CameraCapabilityCache::load(int deviceId, CameraCapabilities *capabilities) const
+{
+    if (m_fileName.isEmpty())
+        return false;
+
+    QSettings settings(m_fileName, QSettings::IniFormat);
+    if (settings.value("fingerprint").toString() != m_fingerprint)
+        return false;
+
+    settings.beginGroup(QString("camera%1").arg(deviceId));
+    if (!settings.contains("previewSizes"))
+        return false;
+
+    capabilities->previewSizes = stringsToSizes(settings.value("previewSizes").toStringList());
+    capabilities->pictureSizes = stringsToSizes(settings.value("pictureSizes").toStringList());
+    capabilities->thumbnailSizes = stringsToSizes(settings.value("thumbnailSizes").toStringList());
+    capabilities->videoSizes = stringsToSizes(settings.value("videoSizes").toStringList());
+    capabilities->flashModes = stringsToInts(settings.value("flashModes").toStringList());
+    capabilities->sceneModes = stringsToInts(settings.value("sceneModes").toStringList());
+    capabilities->minFPS = settings.value("minFPS").toInt();
+    capabilities->maxFPS = settings.value("maxFPS").toInt();
+    capabilities->maxZoom = settings.value("maxZoom").toInt();
+    settings.endGroup();
+
+    return !capabilities->isEmpty();
+}
+
+void CameraCapabilityCache::save(int deviceId, const CameraCapabilities &capabilities) const
+{
+    if (m_fileName.isEmpty())
+        return;
+
+    QSettings settings(m_fileName, QSettings::IniFormat);
+    if (settings.value("fingerprint").toString() != m_fingerprint) {
+        // Written by a different build, none of it can be trusted
+        settings.clear();
+        settings.setValue("fingerprint", m_fingerprint);
+    }
+
+    settings.beginGroup(QString("camera%1").arg(deviceId));
+    settings.setValue("previewSizes", sizesToStrings(capabilities.previewSizes));
+    settings.setValue("pictureSizes", sizesToStrings(capabilities.pictureSizes));
+    settings.setValue("thumbnailSizes", sizesToStrings(capabilities.thumbnailSizes));
+    settings.setValue("videoSizes", sizesToStrings(capabilities.videoSizes));
+    settings.setValue("flashModes", intsToStrings(capabilities.flashModes));
+    settings.setValue("sceneModes", intsToStrings(capabilities.sceneModes));
+    settings.setValue("minFPS", capabilities.minFPS);
+    settings.setValue("maxFPS", capabilities.maxFPS);
+    settings.setValue("maxZoom", capabilities.maxZoom);
+    settings.endGroup();
+
+    settings.sync();
+    if (settings.status() != QSettings::NoError) {
+        qWarning() << "Unable to write the camera capability cache to" << m_fileName;
+    }
+}
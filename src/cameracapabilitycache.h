@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAMERACAPABILITYCACHE_H
+#define CAMERACAPABILITYCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+#include <hybris/camera/camera_compatibility_layer_capabilities.h>
+
+struct CameraControl;
+
+/*!
+ * \brief CameraCapabilities holds what a camera device reports as supported.
+ * Flash and scene modes are kept as the Android enum values.
+ */
+class CameraCapabilities
+{
+public:
+    CameraCapabilities() : minFPS(0), maxFPS(0), maxZoom(0) {}
+
+    bool isEmpty() const { return previewSizes.isEmpty() && pictureSizes.isEmpty(); }
+
+    QList<QSize> previewSizes;
+    QList<QSize> pictureSizes;
+    QList<QSize> thumbnailSizes;
+    QList<QSize> videoSizes;
+    QList<int> flashModes;
+    QList<int> sceneModes;
+    int minFPS;
+    int maxFPS;
+    int maxZoom;
+};
+
+/*!
+ * \brief CameraCapabilityCache avoids querying the camera HAL for the
+ * capabilities of a device every time it is connected. Entries are kept in
+ * memory for the lifetime of the process, and in a file in the cache directory
+ * so that they survive restarts. Both are keyed by the device ID and the build
+ * fingerprint, so a system update invalidates them. The cache is probed on
+ * the camera thread, so access to it is serialized.
+ */
+class CameraCapabilityCache
+{
+public:
+    CameraCapabilityCache();
+
+    CameraCapabilities capabilities(int deviceId, CameraControl *control);
+    void clear();
+
+private:
+    static CameraCapabilities query(CameraControl *control);
+    static void sizeCallback(void *context, int width, int height);
+    static void flashModeCallback(void *context, FlashMode flashMode);
+    static void sceneModeCallback(void *context, SceneMode sceneMode);
+
+    QString key(int deviceId) const;
+    bool load(int deviceId, CameraCapabilities *capabilities) const;
+    void save(int deviceId, const CameraCapabilities &capabilities) const;
+
+    QString m_fingerprint;
+    QString m_fileName;
+
+    static QHash<QString, CameraCapabilities> m_cache;
+    static QMutex m_cacheMutex;
+};
+
+#endif // CAMERACAPABILITYCACHE_H
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cameradeviceregistry.h"
+#include "cameraproperties.h"
+#include "halstatistics.h"
+
+#include <QList>
+
+#include <hybris/camera/camera_compatibility_layer.h>
+
+namespace {
+
+class Device
+{
+public:
+    QByteArray name;
+    QString description;
+    QCamera::Position position;
+    int orientation;
+};
+
+class Registry
+{
+public:
+    Registry();
+
+    QList<Device> devices;
+};
+
+Q_GLOBAL_STATIC(Registry, registry)
+
+Registry::Registry()
+{
+    int cameras = AAL_HAL_CALL(android_camera_get_number_of_devices());
+    for (int deviceId = 0; deviceId < cameras; ++deviceId) {
+        Device device;
+        device.name = QByteArray::number(deviceId);
+        device.position = QCamera::UnspecifiedPosition;
+        device.orientation = 0;
+
+        int facing;
+        int orientation;
+        if (AAL_HAL_CALL(android_camera_get_device_info(deviceId, &facing, &orientation)) == 0) {
+            device.position = facing == BACK_FACING_CAMERA_TYPE ? QCamera::BackFace :
+                                                                  QCamera::FrontFace;
+            // Android's orientation means differently compared to QT's orientation.
+            // On Android, it means "the angle that the camera image needs to be
+            // rotated", but on QT, it means "the physical orientation of the camera
+            // sensor". So, the value will have to be inverted.
+            device.orientation = (360 - orientation) % 360;
+        }
+
+        int override = CameraProperties::intValue(QString("aal.camera.orientations.%1").arg(deviceId), -1);
+        if (override != -1) {
+            device.orientation = override;
+        }
+
+        // Android does not provide a descriptive identifier for devices, so we just
+        // use the index plus some useful human readable information about position.
+        device.description = QString("Camera %1%2").arg(deviceId)
+                .arg(device.position == QCamera::FrontFace ? " Front facing" :
+                     (device.position == QCamera::BackFace ? " Back facing" : ""));
+
+        devices.append(device);
+    }
+}
+
+}
+
+/*!
+ * \brief CameraDeviceRegistry::count returns the number of camera devices
+ */
+int CameraDeviceRegistry::count()
+{
+    return registry()->devices.size();
+}
+
+/*!
+ * \brief CameraDeviceRegistry::indexOf returns the index of the device with
+ * the given name, or -1 if there is none
+ */
+int CameraDeviceRegistry::indexOf(const QByteArray &deviceName)
+{
+    bool ok;
+    int index = deviceName.toInt(&ok, 10);
+    if (!ok || index < 0 || index >= count())
+        return -1;
+    return index;
+}
+
+QByteArray CameraDeviceRegistry::deviceName(int index)
+{
+    if (index < 0 || index >= count())
+        return QByteArray();
+    return registry()->devices.at(index).name;
+}
+
+QString CameraDeviceRegistry::description(int index)
+{
+    if (index < 0 || index >= count())
+        return QString();
+    return registry()->devices.at(index).description;
+}
+
+QCamera::Position CameraDeviceRegistry::position(int index)
+{
+    if (index < 0 || index >= count())
+        return QCamera::UnspecifiedPosition;
+    return registry()->devices.at(index).position;
+}
+
+/*!
+ * \brief CameraDeviceRegistry::orientation returns the physical orientation of
+ * the camera sensor, in degrees, honouring the aal.camera.orientations.N
+ * overrides
+ */
+int CameraDeviceRegistry::orientation(int index)
+{
+    if (index < 0 || index >= count())
+        return 0;
+    return registry()->devices.at(index).orientation;
+}
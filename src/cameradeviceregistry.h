@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAMERADEVICEREGISTRY_H
+#define CAMERADEVICEREGISTRY_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtMultimedia/QCamera>
+
+/*!
+ * \brief CameraDeviceRegistry knows the camera devices of the system. The HAL
+ * and the orientation overrides are only queried the first time it is used;
+ * all lookups after that are served from memory.
+ * Android identifies devices by their index, which is also used as their name.
+ */
+class CameraDeviceRegistry
+{
+public:
+    static int count();
+    static int indexOf(const QByteArray &deviceName);
+
+    static QByteArray deviceName(int index);
+    static QString description(int index);
+    static QCamera::Position position(int index);
+    static int orientation(int index);
+};
+
+#endif // CAMERADEVICEREGISTRY_H
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cameraproperties.h"
+
+#include <hybris/properties/properties.h>
+
+QString CameraProperties::stringValue(const QString &name, const QString &defaultValue)
+{
+    QByteArray propertyName = name.toLocal8Bit();
+
+    char value[PROP_VALUE_MAX];
+    property_get(propertyName.data(), value, "");
+
+    QString result = QString::fromLocal8Bit(value).trimmed();
+    if (result.isEmpty()) {
+        return defaultValue;
+    }
+
+    return result;
+}
+
+int CameraProperties::intValue(const QString &name, int defaultValue)
+{
+    bool ok;
+    int value = stringValue(name).toInt(&ok, /* base */ 10);
+    return ok ? value : defaultValue;
+}
+
+qreal CameraProperties::realValue(const QString &name, qreal defaultValue)
+{
+    bool ok;
+    qreal value = stringValue(name).toDouble(&ok);
+    return ok ? value : defaultValue;
+}
+
+bool CameraProperties::boolValue(const QString &name, bool defaultValue)
+{
+    QString value = stringValue(name).toLower();
+    if (value == QLatin1String("1") || value == QLatin1String("true")) {
+        return true;
+    } else if (value == QLatin1String("0") || value == QLatin1String("false")) {
+        return false;
+    }
+
+    return defaultValue;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAMERAPROPERTIES_H
+#define CAMERAPROPERTIES_H
+
+#include <QString>
+
+/*!
+ * \brief CameraProperties reads the tunables of the camera backend from
+ * Android properties (e.g. "aal.camera.viewfinder.policy"), so that they can
+ * be adjusted per device without rebuilding the plugin.
+ */
+class CameraProperties
+{
+public:
+    static QString stringValue(const QString &name, const QString &defaultValue = QString());
+    static int intValue(const QString &name, int defaultValue);
+    static qreal realValue(const QString &name, qreal defaultValue);
+    static bool boolValue(const QString &name, bool defaultValue);
+};
+
+#endif // CAMERAPROPERTIES_H
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cameraworker.h"
+#include "startuptimeline.h"
+#include "halstatistics.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <string.h>
+
+CameraWorker::CameraWorker(QObject *parent)
+    : QObject(parent),
+      m_busy(false),
+      m_lastConnectId(0),
+      m_connectedId(0),
+      m_connectedControl(0),
+      m_connectedListener(0)
+{
+}
+
+/*!
+ * \brief CameraWorker::post queues a job to be run on the camera thread, after
+ * all the jobs queued before
+ */
+void CameraWorker::post(const Job &job)
+{
+    QMutexLocker locker(&m_mutex);
+    m_jobs.enqueue(job);
+    QMetaObject::invokeMethod(this, "processJobs", Qt::QueuedConnection);
+}
+
+/*!
+ * \brief CameraWorker::waitForIdle blocks until all the queued jobs are done
+ */
+void CameraWorker::waitForIdle()
+{
+    if (QThread::currentThread() == thread())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    while (m_busy || !m_jobs.isEmpty()) {
+        m_idle.wait(&m_mutex);
+    }
+}
+
+/*!
+ * \brief CameraWorker::connectCamera connects to a camera on the camera thread
+ * and emits connectFinished() once done. The result is then fetched with
+ * takeConnection().
+ * \param deviceId the ID of the device to connect to, or -1 to connect by type
+ * \param type the type of camera to connect to when deviceId is -1
+ * \param probe if set, called on the camera thread once connected, to get the
+ * capabilities handed over by takeConnection()
+ * \return the ID of this connection, passed to connectFinished() and to
+ * takeConnection() to tell it apart from earlier ones
+ */
+int CameraWorker::connectCamera(int deviceId, CameraType type, const CapabilityProbe &probe)
+{
+    int connectId = ++m_lastConnectId;
+    post([this, connectId, deviceId, type, probe]() {
+        CameraControlListener *listener = new CameraControlListener;
+        memset(listener, 0, sizeof(*listener));
+
+        CameraControl *control;
+        if (deviceId >= 0) {
+            control = AAL_HAL_CALL(android_camera_connect_by_id(deviceId, listener));
+        } else {
+            control = AAL_HAL_CALL(android_camera_connect_to(type, listener));
+        }
+
+        if (!control) {
+            delete listener;
+            listener = 0;
+        }
+        StartupTimeline::mark("connect: HAL connect");
+
+        CameraCapabilities capabilities;
+        if (control && probe) {
+            capabilities = probe(control);
+            StartupTimeline::mark("connect: capabilities");
+        }
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_connectedId = connectId;
+            m_connectedControl = control;
+            m_connectedListener = listener;
+            m_connectedCapabilities = capabilities;
+        }
+        Q_EMIT connectFinished(connectId);
+    });
+    return connectId;
+}
+
+/*!
+ * \brief CameraWorker::takeConnection hands over the result of a connectCamera()
+ * \param connectId the ID returned by connectCamera()
+ * \param capabilities if not null, set to what the probe returned
+ * \return false if that connection did not finish yet or was already taken,
+ * true otherwise; control is null if connecting failed
+ */
+bool CameraWorker::takeConnection(int connectId, CameraControl **control, CameraControlListener **listener,
+                                  CameraCapabilities *capabilities)
+{
+    QMutexLocker locker(&m_mutex);
+    if (connectId == 0 || m_connectedId != connectId)
+        return false;
+
+    *control = m_connectedControl;
+    *listener = m_connectedListener;
+    if (capabilities)
+        *capabilities = m_connectedCapabilities;
+    m_connectedId = 0;
+    m_connectedControl = 0;
+    m_connectedListener = 0;
+    m_connectedCapabilities = CameraCapabilities();
+    return true;
+}
+
+/*!
+ * \brief CameraWorker::discardConnection disconnects the camera from a pending
+ * connectCamera() as soon as it is connected
+ * \param connectId the ID returned by connectCamera()
+ */
+void CameraWorker::discardConnection(int connectId)
+{
+    post([this, connectId]() {
+        CameraControl *control;
+        CameraControlListener *listener;
+        if (takeConnection(connectId, &control, &listener) && control) {
+            AAL_HAL_CALL(android_camera_disconnect(control));
+            delete listener;
+        }
+    });
+}
+
+void CameraWorker::disconnectCamera(CameraControl *control, CameraControlListener *listener)
+{
+    post([control, listener]() {
+        AAL_HAL_CALL(android_camera_disconnect(control));
+        delete listener;
+    });
+}
+
+void CameraWorker::startPreview(CameraControl *control, unsigned int textureId)
+{
+    post([this, control, textureId]() {
+        AAL_HAL_CALL(android_camera_set_preview_texture(control, textureId));
+        AAL_HAL_CALL(android_camera_start_preview(control));
+        StartupTimeline::mark("preview: HAL start");
+        Q_EMIT previewStarted();
+    });
+}
+
+void CameraWorker::stopPreview(CameraControl *control)
+{
+    post([control]() {
+        AAL_HAL_CALL(android_camera_stop_preview(control));
+        // FIXME: missing android_camera_set_preview_size(QSize())
+        AAL_HAL_CALL(android_camera_set_preview_texture(control, 0));
+    });
+}
+
+void CameraWorker::processJobs()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_jobs.isEmpty()) {
+        Job job = m_jobs.dequeue();
+        m_busy = true;
+        locker.unlock();
+
+        job();
+
+        locker.relock();
+        m_busy = false;
+    }
+    m_idle.wakeAll();
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAMERAWORKER_H
+#define CAMERAWORKER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QWaitCondition>
+
+#include <functional>
+
+#include "cameracapabilitycache.h"
+
+#include <hybris/camera/camera_compatibility_layer.h>
+
+/*!
+ * \brief CameraWorker runs the slow camera HAL calls (connecting, disconnecting,
+ * starting and stopping the preview) on the camera thread, in the order they
+ * were requested, so that they don't block the GUI thread.
+ */
+class CameraWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void()> Job;
+    typedef std::function<CameraCapabilities(CameraControl*)> CapabilityProbe;
+
+    explicit CameraWorker(QObject *parent = 0);
+
+    void post(const Job &job);
+    void waitForIdle();
+
+    int connectCamera(int deviceId, CameraType type, const CapabilityProbe &probe = CapabilityProbe());
+    bool takeConnection(int connectId, CameraControl **control, CameraControlListener **listener,
+                        CameraCapabilities *capabilities = 0);
+    void discardConnection(int connectId);
+    void disconnectCamera(CameraControl *control, CameraControlListener *listener);
+    void startPreview(CameraControl *control, unsigned int textureId);
+    void stopPreview(CameraControl *control);
+
+Q_SIGNALS:
+    void connectFinished(int connectId);
+    void previewStarted();
+
+private Q_SLOTS:
+    void processJobs();
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_idle;
+    QQueue<Job> m_jobs;
+    bool m_busy;
+
+    int m_lastConnectId;
+    int m_connectedId;
+    CameraControl *m_connectedControl;
+    CameraControlListener *m_connectedListener;
+    CameraCapabilities m_connectedCapabilities;
+};
+
+#endif // CAMERAWORKER_H
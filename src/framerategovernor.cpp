@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framerategovernor.h"
+#include "aalcameracontrol.h"
+#include "aalcameraservice.h"
+#include "aalvideorenderercontrol.h"
+#include "aalviewfindersettingscontrol.h"
+#include "cameraproperties.h"
+
+#include <QAbstractVideoSurface>
+#include <QGuiApplication>
+#include <QtMath>
+
+#include <limits>
+
+const int FrameRateGovernor::EVALUATION_INTERVAL;
+const int FrameRateGovernor::FPS_STEP;
+const int FrameRateGovernor::SLOW_WINDOWS;
+const int FrameRateGovernor::PROBE_WINDOWS;
+const int FrameRateGovernor::MAX_PROBE_WINDOWS;
+
+FrameRateGovernor::FrameRateGovernor(AalCameraService *service, QObject *parent):
+    QObject(parent),
+    m_service(service),
+    m_lastFrameCount(0),
+    m_measuredFPS(0.0),
+    m_ceilingFPS(std::numeric_limits<int>::max()),
+    m_slowWindows(0),
+    m_goodWindows(0),
+    m_probeWindows(PROBE_WINDOWS)
+{
+    m_enabled = CameraProperties::boolValue("aal.camera.fps.governor", true);
+    m_idleFPS = CameraProperties::intValue("aal.camera.fps.idle", 15);
+    m_idleTimeout = CameraProperties::intValue("aal.camera.fps.idle_timeout", 10000);
+
+    m_timer.setInterval(EVALUATION_INTERVAL);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(evaluate()));
+
+    QGuiApplication* application = qobject_cast<QGuiApplication*>(QGuiApplication::instance());
+    if (application) {
+        connect(application, SIGNAL(applicationStateChanged(Qt::ApplicationState)),
+                this, SLOT(updateFrameRate()));
+    }
+
+    m_activityTimer.start();
+}
+
+bool FrameRateGovernor::isEnabled() const
+{
+    return m_enabled;
+}
+
+/*!
+ * \brief FrameRateGovernor::setEnabled enables or disables the governor. When
+ * disabled, the viewfinder runs at its maximum frame rate.
+ */
+void FrameRateGovernor::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+
+    m_enabled = enabled;
+    if (!m_enabled) {
+        AalViewfinderSettingsControl *viewfinder = m_service->viewfinderControl();
+        viewfinder->setPreviewFrameRate(viewfinder->maximumFrameRate());
+    } else {
+        updateFrameRate();
+    }
+}
+
+/*!
+ * \brief FrameRateGovernor::measuredFrameRate returns the rate at which
+ * viewfinder frames were presented during the last evaluation interval
+ */
+qreal FrameRateGovernor::measuredFrameRate() const
+{
+    return m_measuredFPS;
+}
+
+/*!
+ * \brief FrameRateGovernor::notifyActivity tells the governor that the user is
+ * interacting with the camera, so an idle viewfinder goes back to full rate
+ */
+void FrameRateGovernor::notifyActivity()
+{
+    m_activityTimer.restart();
+    updateFrameRate();
+}
+
+void FrameRateGovernor::cameraStateChanged(QCamera::State state)
+{
+    // Only measure while the viewfinder can be running
+    if (state == QCamera::ActiveState) {
+        m_lastFrameCount = m_service->videoOutputControl()->presentedFrames();
+        m_ceilingFPS = std::numeric_limits<int>::max();
+        m_slowWindows = 0;
+        m_goodWindows = 0;
+        m_probeWindows = PROBE_WINDOWS;
+        m_windowTimer.start();
+        m_activityTimer.restart();
+        m_timer.start();
+    } else {
+        m_timer.stop();
+        m_measuredFPS = 0.0;
+    }
+}
+
+void FrameRateGovernor::evaluate()
+{
+    quint64 frameCount = m_service->videoOutputControl()->presentedFrames();
+    qint64 elapsed = m_windowTimer.restart();
+    quint64 frames = frameCount - m_lastFrameCount;
+    m_lastFrameCount = frameCount;
+
+    evaluate(frames, elapsed);
+}
+
+/*!
+ * \brief FrameRateGovernor::evaluate adapts the frame rate ceiling to the
+ * frames presented during the last evaluation interval
+ * \param frames the number of frames presented during the interval
+ * \param elapsed the length of the interval in ms
+ */
+void FrameRateGovernor::evaluate(quint64 frames, qint64 elapsed)
+{
+    AalVideoRendererControl *renderer = m_service->videoOutputControl();
+    AalViewfinderSettingsControl *viewfinder = m_service->viewfinderControl();
+
+    if (!m_enabled || elapsed <= 0 || !m_service->androidControl() || !renderer->isPreviewStarted())
+        return;
+
+    m_measuredFPS = frames * 1000.0 / elapsed;
+
+    // When frames keep arriving well below the requested rate, the viewfinder
+    // is limited by something else (exposure time, rendering), and requesting
+    // more frames from the camera only costs power. Lower the ceiling to what
+    // is delivered, and probe upwards again once the delivery keeps up for a
+    // while. Every time the delivery falls behind again, wait twice as long
+    // before the next probe, so that the rate does not keep bouncing.
+    int currentFPS = viewfinder->previewFrameRate();
+    if (m_measuredFPS < currentFPS * 0.75) {
+        m_goodWindows = 0;
+        if (++m_slowWindows >= SLOW_WINDOWS) {
+            m_ceilingFPS = qMax(viewfinder->minimumFrameRate(), qCeil(m_measuredFPS));
+            m_slowWindows = 0;
+            m_probeWindows = qMin(m_probeWindows * 2, MAX_PROBE_WINDOWS);
+        }
+    } else if (m_measuredFPS >= currentFPS * 0.9) {
+        m_slowWindows = 0;
+        if (m_ceilingFPS < viewfinder->maximumFrameRate() && ++m_goodWindows >= m_probeWindows) {
+            m_ceilingFPS = qMin(viewfinder->maximumFrameRate(), m_ceilingFPS + FPS_STEP);
+            m_goodWindows = 0;
+        }
+    } else {
+        m_slowWindows = 0;
+        m_goodWindows = 0;
+    }
+
+    updateFrameRate();
+}
+
+void FrameRateGovernor::updateFrameRate()
+{
+    AalViewfinderSettingsControl *viewfinder = m_service->viewfinderControl();
+    if (!m_enabled || !m_service->androidControl())
+        return;
+
+    int minFPS = viewfinder->minimumFrameRate();
+    int maxFPS = viewfinder->maximumFrameRate();
+    if (maxFPS <= 0)
+        return;
+
+    int targetFPS = maxFPS;
+    if (!isViewfinderVisible()) {
+        targetFPS = minFPS;
+    } else if (m_service->cameraControl()->captureMode() != QCamera::CaptureVideo) {
+        if (m_activityTimer.elapsed() > m_idleTimeout) {
+            targetFPS = qBound(minFPS, m_idleFPS, maxFPS);
+        }
+        targetFPS = qMin(targetFPS, m_ceilingFPS);
+    }
+
+    viewfinder->setPreviewFrameRate(targetFPS);
+}
+
+/*!
+ * \brief FrameRateGovernor::isViewfinderVisible returns false when nobody can
+ * see the viewfinder: the application is in the background or the surface is
+ * not rendering
+ */
+bool FrameRateGovernor::isViewfinderVisible() const
+{
+    QGuiApplication* application = qobject_cast<QGuiApplication*>(QGuiApplication::instance());
+    if (application && application->applicationState() != Qt::ApplicationActive)
+        return false;
+
+    QAbstractVideoSurface *surface = m_service->videoOutputControl()->surface();
+    return surface && surface->isActive();
+}
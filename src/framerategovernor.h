@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMERATEGOVERNOR_H
+#define FRAMERATEGOVERNOR_H
+
+#include <QObject>
+#include <QCamera>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class AalCameraService;
+
+/*!
+ * \brief FrameRateGovernor adapts the viewfinder frame rate, within the range
+ * allowed by AalViewfinderSettingsControl, to what is actually needed: the
+ * lowest rate when the viewfinder is not visible, a reduced rate when the user
+ * is idle, and the highest rate in video mode.
+ */
+class FrameRateGovernor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameRateGovernor(AalCameraService *service, QObject *parent = 0);
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    qreal measuredFrameRate() const;
+
+public Q_SLOTS:
+    void notifyActivity();
+    void cameraStateChanged(QCamera::State state);
+
+private Q_SLOTS:
+    void evaluate();
+    void updateFrameRate();
+
+private:
+    void evaluate(quint64 frames, qint64 elapsed);
+    bool isViewfinderVisible() const;
+
+    AalCameraService *m_service;
+    QTimer m_timer;
+    QElapsedTimer m_windowTimer;
+    QElapsedTimer m_activityTimer;
+    quint64 m_lastFrameCount;
+    qreal m_measuredFPS;
+    int m_ceilingFPS;
+    int m_slowWindows;
+    int m_goodWindows;
+    int m_probeWindows;
+    bool m_enabled;
+    int m_idleFPS;
+    int m_idleTimeout;
+
+    static const int EVALUATION_INTERVAL = 1000; // ms
+    static const int FPS_STEP = 5;
+    static const int SLOW_WINDOWS = 3;
+    static const int PROBE_WINDOWS = 5;
+    static const int MAX_PROBE_WINDOWS = 60;
+};
+
+#endif // FRAMERATEGOVERNOR_H
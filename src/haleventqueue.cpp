@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "haleventqueue.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+
+namespace {
+
+const QEvent::Type WakeupEvent = static_cast<QEvent::Type>(QEvent::registerEventType());
+
+}
+
+HalEventQueue::HalEventQueue(QObject *parent)
+    : QObject(parent),
+      m_head(0),
+      m_wakeupPending(0),
+      m_pendingTypes(0),
+      m_depth(0),
+      m_maximumDepth(0),
+      m_coalescedEvents(0),
+      m_deliveredEvents(0),
+      m_totalLatency(0),
+      m_maximumLatency(0)
+{
+    m_clock.start();
+}
+
+HalEventQueue::~HalEventQueue()
+{
+    Event *event = m_head.fetchAndStoreAcquire(0);
+    while (event) {
+        Event *next = event->next;
+        delete event;
+        event = next;
+    }
+}
+
+/*!
+ * \brief HalEventQueue::post queues an event, to be delivered on the thread of
+ * the queue. Safe to call from any thread, without locking.
+ * \param type what happened
+ * \param data payload of the event, if any
+ */
+void HalEventQueue::post(EventType type, const QByteArray &data)
+{
+    if (isCoalesced(type)) {
+        int bit = 1 << type;
+        if (m_pendingTypes.fetchAndOrOrdered(bit) & bit) {
+            m_coalescedEvents.fetchAndAddRelaxed(1);
+            return;
+        }
+    }
+
+    Event *event = new Event;
+    event->type = type;
+    event->data = data;
+    event->timestamp = m_clock.nsecsElapsed();
+
+    Event *head;
+    do {
+        head = m_head.loadAcquire();
+        event->next = head;
+    } while (!m_head.testAndSetRelease(head, event));
+
+    int depth = m_depth.fetchAndAddRelaxed(1) + 1;
+    int maximumDepth = m_maximumDepth.loadAcquire();
+    while (depth > maximumDepth && !m_maximumDepth.testAndSetRelaxed(maximumDepth, depth)) {
+        maximumDepth = m_maximumDepth.loadAcquire();
+    }
+
+    // One wakeup for all the events posted until the queue is drained
+    if (m_wakeupPending.testAndSetOrdered(0, 1)) {
+        QCoreApplication::postEvent(this, new QEvent(WakeupEvent));
+    }
+}
+
+bool HalEventQueue::event(QEvent *event)
+{
+    if (event->type() == WakeupEvent) {
+        drain();
+        return true;
+    }
+    return QObject::event(event);
+}
+
+void HalEventQueue::drain()
+{
+    // Cleared first, so that events posted while delivering wake us up again
+    m_wakeupPending.storeRelease(0);
+
+    Event *event = m_head.fetchAndStoreAcquire(0);
+
+    // The stack holds the newest event first
+    Event *ordered = 0;
+    while (event) {
+        Event *next = event->next;
+        event->next = ordered;
+        ordered = event;
+        event = next;
+    }
+
+    qint64 now = m_clock.nsecsElapsed();
+    while (ordered) {
+        Event *next = ordered->next;
+        m_depth.fetchAndAddRelaxed(-1);
+        if (isCoalesced(ordered->type)) {
+            m_pendingTypes.fetchAndAndOrdered(~(1 << ordered->type));
+        }
+
+        qint64 latency = now - ordered->timestamp;
+        m_totalLatency += latency;
+        m_maximumLatency = qMax(m_maximumLatency, latency);
+        ++m_deliveredEvents;
+
+        deliver(ordered);
+        delete ordered;
+        ordered = next;
+    }
+}
+
+void HalEventQueue::deliver(const Event *event)
+{
+    switch (event->type) {
+    case PreviewFrameEvent:
+        Q_EMIT previewFrame();
+        break;
+    case FocusEvent:
+        Q_EMIT focusDone();
+        break;
+    case ShutterEvent:
+        Q_EMIT shutter();
+        break;
+    case CompressedImageEvent:
+        Q_EMIT compressedImage(event->data);
+        break;
+    case ErrorEvent:
+        Q_EMIT error();
+        break;
+    }
+}
+
+bool HalEventQueue::isCoalesced(EventType type)
+{
+    return type == PreviewFrameEvent || type == FocusEvent;
+}
+
+/*!
+ * \brief HalEventQueue::depth returns the number of events waiting to be
+ * delivered
+ */
+int HalEventQueue::depth() const
+{
+    return m_depth.loadAcquire();
+}
+
+int HalEventQueue::maximumDepth() const
+{
+    return m_maximumDepth.loadAcquire();
+}
+
+quint64 HalEventQueue::deliveredEvents() const
+{
+    return m_deliveredEvents;
+}
+
+/*!
+ * \brief HalEventQueue::coalescedEvents returns how many events were dropped
+ * because an event of the same kind was still pending
+ */
+quint64 HalEventQueue::coalescedEvents() const
+{
+    return m_coalescedEvents.loadAcquire();
+}
+
+/*!
+ * \brief HalEventQueue::averageLatency returns the average time, in ns, from
+ * posting an event to its delivery
+ */
+qint64 HalEventQueue::averageLatency() const
+{
+    if (m_deliveredEvents == 0)
+        return 0;
+    return m_totalLatency / qint64(m_deliveredEvents);
+}
+
+qint64 HalEventQueue::maximumLatency() const
+{
+    return m_maximumLatency;
+}
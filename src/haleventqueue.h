@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HALEVENTQUEUE_H
+#define HALEVENTQUEUE_H
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+
+/*!
+ * \brief HalEventQueue carries the events of the camera HAL callbacks to the
+ * thread of the queue. Posting is lock-free and can happen from any thread;
+ * all the events posted until the next event loop iteration are delivered
+ * together, as signals. An event that supersedes the previous one of its kind
+ * (a new preview frame, a focus result) is dropped while one is still pending.
+ */
+class HalEventQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum EventType {
+        PreviewFrameEvent,
+        FocusEvent,
+        ShutterEvent,
+        CompressedImageEvent,
+        ErrorEvent
+    };
+
+    explicit HalEventQueue(QObject *parent = 0);
+    ~HalEventQueue();
+
+    void post(EventType type, const QByteArray &data = QByteArray());
+
+    int depth() const;
+    int maximumDepth() const;
+    quint64 deliveredEvents() const;
+    quint64 coalescedEvents() const;
+    qint64 averageLatency() const;
+    qint64 maximumLatency() const;
+
+Q_SIGNALS:
+    void previewFrame();
+    void focusDone();
+    void shutter();
+    void compressedImage(const QByteArray &data);
+    void error();
+
+protected:
+    bool event(QEvent *event);
+
+private:
+    class Event
+    {
+    public:
+        EventType type;
+        QByteArray data;
+        qint64 timestamp;
+        Event *next;
+    };
+
+    void drain();
+    void deliver(const Event *event);
+    static bool isCoalesced(EventType type);
+
+    QAtomicPointer<Event> m_head;
+    QAtomicInt m_wakeupPending;
+    QAtomicInt m_pendingTypes;
+    QAtomicInt m_depth;
+    QAtomicInt m_maximumDepth;
+    QAtomicInt m_coalescedEvents;
+    QElapsedTimer m_clock;
+
+    // Only touched by the thread of the queue
+    quint64 m_deliveredEvents;
+    qint64 m_totalLatency;
+    qint64 m_maximumLatency;
+};
+
+#endif // HALEVENTQUEUE_H
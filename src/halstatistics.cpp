@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "halstatistics.h"
+#include "cameraproperties.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+
+namespace {
+
+class Function
+{
+public:
+    Function() : calls(0), slowCalls(0), totalTime(0), maximumTime(0)
+    {
+        for (int i = 0; i < HalStatistics::BUCKETS; ++i)
+            histogram[i] = 0;
+    }
+
+    quint64 calls;
+    quint64 slowCalls;
+    qint64 totalTime;
+    qint64 maximumTime;
+    // Bucket i counts the calls shorter than 4^i us, the last one all others
+    quint64 histogram[HalStatistics::BUCKETS];
+};
+
+class Statistics
+{
+public:
+    Statistics()
+    {
+        slowThreshold = qint64(CameraProperties::intValue("aal.camera.hal_slow_threshold", 16)) * 1000000;
+    }
+
+    QMutex mutex;
+    QHash<QByteArray, Function> functions;
+    qint64 slowThreshold;
+};
+
+Q_GLOBAL_STATIC(Statistics, statistics)
+
+int bucket(qint64 nsecs)
+{
+    qint64 limit = 1000;
+    for (int i = 0; i < HalStatistics::BUCKETS - 1; ++i) {
+        if (nsecs < limit)
+            return i;
+        limit *= 4;
+    }
+    return HalStatistics::BUCKETS - 1;
+}
+
+QString formatTime(qint64 nsecs)
+{
+    if (nsecs < 1000000)
+        return QString("%1 us").arg(nsecs / 1000);
+    return QString("%1 ms").arg(nsecs / 1000000.0, 0, 'f', 1);
+}
+
+}
+
+/*!
+ * \brief HalStatistics::record records one call of a HAL function
+ * \param call the call as written in the source; the function is its part
+ * before the first parenthesis
+ * \param nsecs how long the call took
+ */
+void HalStatistics::record(const char *call, qint64 nsecs)
+{
+    QByteArray name(call);
+    int parenthesis = name.indexOf('(');
+    if (parenthesis != -1)
+        name.truncate(parenthesis);
+    name = name.trimmed();
+
+    Statistics *s = statistics();
+    QMutexLocker locker(&s->mutex);
+    Function &function = s->functions[name];
+    ++function.calls;
+    function.totalTime += nsecs;
+    function.maximumTime = qMax(function.maximumTime, nsecs);
+    ++function.histogram[bucket(nsecs)];
+
+    if (s->slowThreshold > 0 && nsecs > s->slowThreshold) {
+        ++function.slowCalls;
+        qWarning().nospace() << "Slow HAL call: " << name.constData() << " took "
+                             << qPrintable(formatTime(nsecs)) << " on thread "
+                             << QThread::currentThread();
+    }
+}
+
+void HalStatistics::reset()
+{
+    Statistics *s = statistics();
+    QMutexLocker locker(&s->mutex);
+    s->functions.clear();
+}
+
+/*!
+ * \brief HalStatistics::dump returns a table of the calls recorded so far, one
+ * line per function, with the histogram of their durations
+ */
+QString HalStatistics::dump()
+{
+    Statistics *s = statistics();
+    QMutexLocker locker(&s->mutex);
+
+    QStringList header;
+    qint64 limit = 1000;
+    for (int i = 0; i < BUCKETS - 1; ++i) {
+        header << QString("<%1").arg(formatTime(limit));
+        limit *= 4;
+    }
+    header << "more";
+
+    QStringList lines;
+    lines << QString("HAL calls (histogram buckets: %1)").arg(header.join(", "));
+
+    QList<QByteArray> names = s->functions.keys();
+    std::sort(names.begin(), names.end());
+    Q_FOREACH (const QByteArray &name, names) {
+        const Function &function = s->functions.value(name);
+        QStringList histogram;
+        for (int i = 0; i < BUCKETS; ++i)
+            histogram << QString::number(function.histogram[i]);
+        lines << QString("  %1: %2 calls, %3 slow, average %4, max %5 [%6]")
+                 .arg(QString::fromLatin1(name))
+                 .arg(function.calls)
+                 .arg(function.slowCalls)
+                 .arg(formatTime(function.totalTime / qint64(function.calls)))
+                 .arg(formatTime(function.maximumTime))
+                 .arg(histogram.join(' '));
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HALSTATISTICS_H
+#define HALSTATISTICS_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+/*!
+ * \brief HalStatistics keeps, per HAL function, the number of calls and a
+ * histogram of their duration, and warns about calls slower than
+ * aal.camera.hal_slow_threshold (ms).
+ *
+ * Calls are recorded through AAL_HAL_CALL(), which only does so when the
+ * plugin is built with CONFIG+=hal_instrumentation; otherwise it is the plain
+ * call.
+ */
+class HalStatistics
+{
+public:
+    static const int BUCKETS = 12;
+
+    static void record(const char *call, qint64 nsecs);
+    static void reset();
+    static QString dump();
+};
+
+/*!
+ * \brief HalCallTimer records the time from its construction to its
+ * destruction as one call of a HAL function
+ */
+class HalCallTimer
+{
+public:
+    explicit HalCallTimer(const char *call) : m_call(call) { m_timer.start(); }
+    ~HalCallTimer() { HalStatistics::record(m_call, m_timer.nsecsElapsed()); }
+
+private:
+    const char *m_call;
+    QElapsedTimer m_timer;
+};
+
+#ifdef AAL_HAL_INSTRUMENTATION
+#define AAL_HAL_CALL(call) (HalCallTimer(#call), call)
+#else
+#define AAL_HAL_CALL(call) (call)
+#endif
+
+#endif // HALSTATISTICS_H
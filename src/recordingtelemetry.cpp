@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recordingtelemetry.h"
+
+RecordingTelemetry::RecordingTelemetry()
+    : m_lastUpdate(0),
+      m_lastWrite(0),
+      m_bytesWritten(0),
+      m_bitRate(0),
+      m_audioBitRate(0),
+      m_idle(0)
+{
+}
+
+/*!
+ * \brief RecordingTelemetry::start starts following a new output
+ * \param elapsed the time of the recording clock, in ms
+ * \param audioBitRate the bit rate the audio is encoded at, 0 without audio
+ */
+void RecordingTelemetry::start(qint64 elapsed, int audioBitRate)
+{
+    m_lastUpdate = elapsed;
+    m_lastWrite = elapsed;
+    m_bytesWritten = 0;
+    m_bitRate = 0;
+    m_audioBitRate = audioBitRate;
+    m_idle = 0;
+}
+
+/*!
+ * \brief RecordingTelemetry::update takes a new sample of the output
+ * \param elapsed the time of the recording clock, in ms
+ * \param bytesWritten the size of the output
+ * \param idle the time since the output was last written to, in ms, if it is
+ * known; otherwise it is the time since an update saw the output grow
+ */
+void RecordingTelemetry::update(qint64 elapsed, qint64 bytesWritten, qint64 idle)
+{
+    const qint64 interval = elapsed - m_lastUpdate;
+    if (interval > 0) {
+        m_bitRate = int(qMax(qint64(0), bytesWritten - m_bytesWritten) * 8 * 1000 / interval);
+        m_lastUpdate = elapsed;
+    }
+
+    if (bytesWritten > m_bytesWritten)
+        m_lastWrite = elapsed;
+    m_bytesWritten = bytesWritten;
+    m_idle = idle >= 0 ? idle : elapsed - m_lastWrite;
+}
+
+qint64 RecordingTelemetry::bytesWritten() const
+{
+    return m_bytesWritten;
+}
+
+/*!
+ * \brief RecordingTelemetry::bitRate returns the bit rate of the output over
+ * the last update, in bit/s
+ */
+int RecordingTelemetry::bitRate() const
+{
+    return m_bitRate;
+}
+
+int RecordingTelemetry::videoBitRate() const
+{
+    return qMax(0, m_bitRate - audioBitRate());
+}
+
+int RecordingTelemetry::audioBitRate() const
+{
+    return qMin(m_audioBitRate, m_bitRate);
+}
+
+/*!
+ * \brief RecordingTelemetry::timeSinceLastWrite returns, in ms, how long the
+ * output has not grown
+ */
+qint64 RecordingTelemetry::timeSinceLastWrite() const
+{
+    return m_idle;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECORDINGTELEMETRY_H
+#define RECORDINGTELEMETRY_H
+
+#include <QtGlobal>
+
+/*!
+ * \brief RecordingTelemetry follows what a recording actually writes: the size
+ * of its output, the bit rate achieved over the last update, and the time
+ * since the output last grew, so that stalls on slow storage can be noticed.
+ *
+ * Only the total size of the output is known. The audio is encoded at a
+ * constant bit rate, so the rest is taken as the video bit rate.
+ */
+class RecordingTelemetry
+{
+public:
+    RecordingTelemetry();
+
+    void start(qint64 elapsed, int audioBitRate);
+    void update(qint64 elapsed, qint64 bytesWritten, qint64 idle = -1);
+
+    qint64 bytesWritten() const;
+    int bitRate() const;
+    int videoBitRate() const;
+    int audioBitRate() const;
+    qint64 timeSinceLastWrite() const;
+
+private:
+    qint64 m_lastUpdate;
+    qint64 m_lastWrite;
+    qint64 m_bytesWritten;
+    int m_bitRate;
+    int m_audioBitRate;
+    qint64 m_idle;
+};
+
+#endif // RECORDINGTELEMETRY_H
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recordingwriter.h"
+#include "tracebuffer.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// How often the file is checked for new data, in ms
+const int UPDATE_INTERVAL = 50;
+
+qint64 alignDown(qint64 value, qint64 alignment)
+{
+    return value - value % alignment;
+}
+
+}
+
+/*!
+ * \brief RecordingWriter::RecordingWriter
+ * \param fd the file the recorder writes to
+ * \param chunkSize the size of the ranges written back at a time
+ * \param preallocation how much space to keep reserved past the end of the
+ * file; 0 to not reserve any
+ */
+RecordingWriter::RecordingWriter(int fd, qint64 chunkSize, qint64 preallocation, QObject *parent)
+    : QThread(parent),
+      m_fd(fd),
+      m_chunkSize(qMax(chunkSize, qint64(4096))),
+      m_preallocation(preallocation),
+      m_stop(false),
+      m_size(0),
+      m_writeStarted(0),
+      m_writtenBack(0),
+      m_allocatedEnd(0),
+      m_maximumBuffered(0),
+      m_stallTime(0),
+      m_maximumStall(0)
+{
+    setObjectName("recording writer");
+}
+
+RecordingWriter::~RecordingWriter()
+{
+    finish();
+}
+
+/*!
+ * \brief RecordingWriter::finish stops following the file once the recorder
+ * is done with it: the rest of the data is written back, and the space
+ * reserved past its end is given back
+ */
+void RecordingWriter::finish()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_stop)
+            return;
+        m_stop = true;
+        m_wakeUp.wakeAll();
+    }
+    wait();
+
+    update(true);
+    if (m_allocatedEnd > m_size && ftruncate(m_fd, m_size) < 0)
+        qWarning() << "Failed to release the space reserved for the recording:" << strerror(errno);
+}
+
+qint64 RecordingWriter::fileSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_size;
+}
+
+/*!
+ * \brief RecordingWriter::bufferedBytes returns how much of the file is
+ * still in the page cache only
+ */
+qint64 RecordingWriter::bufferedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_size - m_writtenBack;
+}
+
+qint64 RecordingWriter::maximumBufferedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maximumBuffered;
+}
+
+/*!
+ * \brief RecordingWriter::preallocatedBytes returns how much space is reserved
+ * past the end of the file
+ */
+qint64 RecordingWriter::preallocatedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return qMax(qint64(0), m_allocatedEnd - m_size);
+}
+
+/*!
+ * \brief RecordingWriter::stallTime returns the time, in ns, spent waiting for
+ * the disk to catch up with the recorder
+ */
+qint64 RecordingWriter::stallTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stallTime;
+}
+
+qint64 RecordingWriter::maximumStall() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maximumStall;
+}
+
+void RecordingWriter::run()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_stop) {
+        m_wakeUp.wait(&m_mutex, UPDATE_INTERVAL);
+        if (m_stop)
+            break;
+
+        locker.unlock();
+        update(false);
+        locker.relock();
+    }
+}
+
+/*!
+ * \brief RecordingWriter::update starts the write-back of the chunks completed
+ * since the last update, and waits for the one before them, so that at most
+ * about two chunks are in flight. The final update writes everything back.
+ */
+void RecordingWriter::update(bool final)
+{
+    struct stat info;
+    if (fstat(m_fd, &info) < 0)
+        return;
+    const qint64 size = info.st_size;
+
+    preallocate(size);
+
+    const qint64 end = final ? size : alignDown(size, m_chunkSize);
+    if (end > m_writeStarted) {
+        sync_file_range(m_fd, m_writeStarted, end - m_writeStarted, SYNC_FILE_RANGE_WRITE);
+        m_writeStarted = end;
+    }
+
+    const qint64 waitEnd = final ? m_writeStarted : m_writeStarted - m_chunkSize;
+    qint64 stall = 0;
+    if (waitEnd > m_writtenBack) {
+        TraceScope trace("writer: wait for write-back");
+        QElapsedTimer timer;
+        timer.start();
+        sync_file_range(m_fd, m_writtenBack, waitEnd - m_writtenBack,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        stall = timer.nsecsElapsed();
+        // The recorder does not read the data back, no need to keep it cached
+        posix_fadvise(m_fd, m_writtenBack, waitEnd - m_writtenBack, POSIX_FADV_DONTNEED);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_size = size;
+    if (waitEnd > m_writtenBack)
+        m_writtenBack = waitEnd;
+    m_maximumBuffered = qMax(m_maximumBuffered, size - m_writtenBack);
+    m_stallTime += stall;
+    m_maximumStall = qMax(m_maximumStall, stall);
+}
+
+/*!
+ * \brief RecordingWriter::preallocate keeps at least half of the preallocation
+ * reserved past the end of the file, so that the file system can give the
+ * recording large contiguous extents
+ */
+void RecordingWriter::preallocate(qint64 size)
+{
+    if (m_preallocation <= 0 || m_allocatedEnd - size >= m_preallocation / 2)
+        return;
+
+    const qint64 start = qMax(m_allocatedEnd, size);
+    const qint64 end = alignDown(size + m_preallocation, m_chunkSize) + m_chunkSize;
+    if (fallocate(m_fd, FALLOC_FL_KEEP_SIZE, start, end - start) < 0) {
+        if (errno == EOPNOTSUPP)
+            qDebug() << "The file system of the recording can't reserve space";
+        else
+            qWarning() << "Failed to reserve space for the recording:" << strerror(errno);
+        m_preallocation = 0;
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_allocatedEnd = end;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECORDINGWRITER_H
+#define RECORDINGWRITER_H
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+/*!
+ * \brief RecordingWriter manages the write-back of a recording file while the
+ * recorder writes to it: it reserves disk space ahead of the end of the file
+ * with fallocate(), and pushes the written data to the disk in chunk sized,
+ * aligned ranges with sync_file_range(), so that the page cache does not fill
+ * up with dirty pages that are then flushed all at once, stalling the encoder.
+ *
+ * The recorder keeps writing to the file itself: the MP4 writer seeks back to
+ * patch its headers, so its output can't go through a pipe.
+ */
+class RecordingWriter : public QThread
+{
+public:
+    RecordingWriter(int fd, qint64 chunkSize, qint64 preallocation, QObject *parent = 0);
+    ~RecordingWriter();
+
+    void finish();
+
+    qint64 fileSize() const;
+    qint64 bufferedBytes() const;
+    qint64 maximumBufferedBytes() const;
+    qint64 preallocatedBytes() const;
+    qint64 stallTime() const;
+    qint64 maximumStall() const;
+
+protected:
+    void run();
+
+private:
+    void update(bool final);
+    void preallocate(qint64 size);
+
+    int m_fd;
+    qint64 m_chunkSize;
+    qint64 m_preallocation;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wakeUp;
+    bool m_stop;
+
+    // Only written by the writer thread; read under m_mutex
+    qint64 m_size;
+    qint64 m_writeStarted;  // write-back was started up to here
+    qint64 m_writtenBack;   // data up to here is on the disk
+    qint64 m_allocatedEnd;
+    qint64 m_maximumBuffered;
+    qint64 m_stallTime;
+    qint64 m_maximumStall;
+};
+
+#endif // RECORDINGWRITER_H
@@ -16,11 +16,11 @@
 
 #include "rotationhandler.h"
 
-#include <QCameraInfo>
 #include <QOrientationReading>
 
 #include "aalcameracontrol.h"
 #include "aalvideodeviceselectorcontrol.h"
+#include "cameradeviceregistry.h"
 
 RotationHandler::RotationHandler(AalCameraService *service, QObject *parent):
     QObject(parent),
@@ -31,6 +31,8 @@ RotationHandler::RotationHandler(AalCameraService *service, QObject *parent):
     connect(&m_orientationSensor, SIGNAL(readingChanged()), this, SLOT(orientationChanged()));
     connect(service->cameraControl(), SIGNAL(stateChanged(QCamera::State)),
                                 this, SLOT(cameraStateChanged(QCamera::State)));
+    // The handler is created on demand, the camera may be active already
+    cameraStateChanged(service->cameraControl()->state());
 }
 
 void RotationHandler::orientationChanged()
@@ -71,18 +73,17 @@ void RotationHandler::cameraStateChanged(QCamera::State state)
 int RotationHandler::calculateRotation()
 {
     int selectedDevice = m_service->deviceSelector()->selectedDevice();
-    QCameraInfo cameraInfo = QCameraInfo::availableCameras().value(selectedDevice);
 
     // Starts of by getting device orientation
     int rotation = m_deviceOrientation;
 
-    if (cameraInfo.position() == QCamera::FrontFace) {
+    if (CameraDeviceRegistry::position(selectedDevice) == QCamera::FrontFace) {
         // Clockwise device becomes counter-clockwise camera
         rotation = (360 - rotation);
     }
 
     // Account for camera orientation
-    rotation -= cameraInfo.orientation();
+    rotation -= CameraDeviceRegistry::orientation(selectedDevice);
 
     // Ensure rotation is positive
     rotation = (rotation + 360) % 360;
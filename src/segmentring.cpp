@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "segmentring.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+/*!
+ * \brief SegmentRing::SegmentRing
+ * \param fileName the file the recording would have been written to; the
+ * segments are named after it, with a sequence number
+ * \param maxSegments how many segments to keep, counting the one being
+ * recorded and the one prepared to follow it
+ * \param budget how many bytes the segments may take, 0 for no limit
+ */
+SegmentRing::SegmentRing(const QString &fileName, int maxSegments, qint64 budget)
+    : m_maxSegments(qMax(maxSegments, MINIMUM_SEGMENTS)),
+      m_budget(budget),
+      m_counter(0),
+      m_largestSegment(0),
+      m_gapCount(0),
+      m_lastGap(0),
+      m_maximumGap(0),
+      m_totalGap(0)
+{
+    QFileInfo info(fileName);
+    m_baseName = info.path() + QLatin1Char('/') + info.completeBaseName();
+    m_suffix = info.suffix().isEmpty() ? QString() : QLatin1Char('.') + info.suffix();
+
+    const QString prefix = info.completeBaseName() + QLatin1Char('_');
+    const QStringList existing = QDir(info.path()).entryList(QStringList() << prefix + QLatin1Char('*') + m_suffix,
+                                                             QDir::Files);
+    Q_FOREACH (const QString &name, existing) {
+        bool ok;
+        int number = name.mid(prefix.size(), name.size() - prefix.size() - m_suffix.size()).toInt(&ok);
+        if (ok)
+            m_counter = qMax(m_counter, number);
+    }
+}
+
+/*!
+ * \brief SegmentRing::nextSegment drops the oldest segments to make room for
+ * a new one, and returns the name of the new one. The segment being recorded
+ * and the one before it, which may still be finalized, are never dropped.
+ * \param freedSize set to how much space the dropped segments took, 0 if none
+ * was dropped
+ */
+QString SegmentRing::nextSegment(qint64 *freedSize)
+{
+    qint64 total = 0;
+    Q_FOREACH (const QString &segment, m_segments) {
+        qint64 size = QFileInfo(segment).size();
+        m_largestSegment = qMax(m_largestSegment, size);
+        total += size;
+    }
+
+    *freedSize = 0;
+    while (m_segments.size() > 2 &&
+           (m_segments.size() >= m_maxSegments ||
+            (m_budget > 0 && total + m_largestSegment > m_budget))) {
+        QString dropped = m_segments.takeFirst();
+        qint64 droppedSize = QFileInfo(dropped).size();
+        if (QFile::remove(dropped))
+            *freedSize += droppedSize;
+        total -= droppedSize;
+    }
+
+    ++m_counter;
+    QString segment = QString("%1_%2%3").arg(m_baseName).arg(m_counter, 4, 10, QLatin1Char('0'))
+                                        .arg(m_suffix);
+    m_segments.append(segment);
+    return segment;
+}
+
+/*!
+ * \brief SegmentRing::discard removes a segment that ended up not being
+ * recorded
+ */
+void SegmentRing::discard(const QString &segment)
+{
+    if (m_segments.removeOne(segment))
+        QFile::remove(segment);
+}
+
+/*!
+ * \brief SegmentRing::segments returns the segments, the oldest first
+ */
+QStringList SegmentRing::segments() const
+{
+    return m_segments;
+}
+
+qint64 SegmentRing::totalSize() const
+{
+    qint64 total = 0;
+    Q_FOREACH (const QString &segment, m_segments)
+        total += QFileInfo(segment).size();
+    return total;
+}
+
+/*!
+ * \brief SegmentRing::recordGap records the time, in ns, between the end of
+ * a segment and the start of the next one
+ */
+void SegmentRing::recordGap(qint64 nsecs)
+{
+    ++m_gapCount;
+    m_lastGap = nsecs;
+    m_maximumGap = qMax(m_maximumGap, nsecs);
+    m_totalGap += nsecs;
+}
+
+int SegmentRing::gapCount() const
+{
+    return m_gapCount;
+}
+
+qint64 SegmentRing::lastGap() const
+{
+    return m_lastGap;
+}
+
+qint64 SegmentRing::maximumGap() const
+{
+    return m_maximumGap;
+}
+
+qint64 SegmentRing::averageGap() const
+{
+    return m_gapCount > 0 ? m_totalGap / m_gapCount : 0;
+}
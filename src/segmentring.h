@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEGMENTRING_H
+#define SEGMENTRING_H
+
+#include <QString>
+#include <QStringList>
+
+/*!
+ * \brief SegmentRing keeps track of the files of a loop recording: it names
+ * the segments after the recording, and makes room for each new one by
+ * dropping the oldest segments, so that only the newest ones are kept within
+ * the segment count and the disk budget. The space the dropped segments
+ * freed can then be reserved for the new one. The numbering goes on after the
+ * segments already in the directory, so that an earlier loop recording to the
+ * same place is not overwritten.
+ *
+ * It also keeps the statistics of the gaps between the segments.
+ */
+class SegmentRing
+{
+public:
+    SegmentRing(const QString &fileName, int maxSegments, qint64 budget);
+
+    QString nextSegment(qint64 *freedSize);
+    void discard(const QString &segment);
+
+    QStringList segments() const;
+    qint64 totalSize() const;
+
+    void recordGap(qint64 nsecs);
+    int gapCount() const;
+    qint64 lastGap() const;
+    qint64 maximumGap() const;
+    qint64 averageGap() const;
+
+    static const int MINIMUM_SEGMENTS = 3;
+
+private:
+    QString m_baseName;
+    QString m_suffix;
+    int m_maxSegments;
+    qint64 m_budget;
+    int m_counter;
+    QStringList m_segments;
+    qint64 m_largestSegment;
+
+    int m_gapCount;
+    qint64 m_lastGap;
+    qint64 m_maximumGap;
+    qint64 m_totalGap;
+};
+
+#endif // SEGMENTRING_H
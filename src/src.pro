@@ -10,11 +10,17 @@ target.path += $$[QT_INSTALL_PLUGINS]/$${PLUGIN_TYPE}
 INSTALLS = target
 
 CONFIG += link_pkgconfig
-PKGCONFIG += exiv2 libqtubuntu-media-signals libmedia libcamera hybris-egl-platform libpulse-simple libandroid-properties
+PKGCONFIG += exiv2 libqtubuntu-media-signals libmedia libcamera hybris-egl-platform libpulse libandroid-properties
 
 OTHER_FILES += aalcamera.json
 
+# Build with CONFIG+=hal_instrumentation to time every HAL call
+CONFIG(hal_instrumentation) {
+    DEFINES += AAL_HAL_INSTRUMENTATION
+}
+
 HEADERS += \
+    aalaudioencodersettingscontrol.h \
     aalcameracontrol.h \
     aalcameraflashcontrol.h \
     aalcamerafocuscontrol.h \
@@ -32,10 +38,24 @@ HEADERS += \
     aalcamerainfocontrol.h \
     audiocapture.h \
     aalcameraexposurecontrol.h \
+    cameracapabilitycache.h \
+    cameradeviceregistry.h \
+    cameraproperties.h \
+    cameraworker.h \
     storagemanager.h \
-    rotationhandler.h
+    rotationhandler.h \
+    startuptimeline.h \
+    framerategovernor.h \
+    haleventqueue.h \
+    halstatistics.h \
+    tracebuffer.h \
+    recordingwriter.h \
+    segmentring.h \
+    streamrelay.h \
+    recordingtelemetry.h
 
 SOURCES += \
+    aalaudioencodersettingscontrol.cpp \
     aalcameracontrol.cpp \
     aalcameraflashcontrol.cpp \
     aalcamerafocuscontrol.cpp \
@@ -53,5 +73,18 @@ SOURCES += \
     aalcamerainfocontrol.cpp \
     audiocapture.cpp \
     aalcameraexposurecontrol.cpp \
+    cameracapabilitycache.cpp \
+    cameradeviceregistry.cpp \
+    cameraproperties.cpp \
+    cameraworker.cpp \
     storagemanager.cpp \
-    rotationhandler.cpp
+    rotationhandler.cpp \
+    startuptimeline.cpp \
+    framerategovernor.cpp \
+    haleventqueue.cpp \
+    halstatistics.cpp \
+    tracebuffer.cpp \
+    recordingwriter.cpp \
+    segmentring.cpp \
+    streamrelay.cpp \
+    recordingtelemetry.cpp
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "startuptimeline.h"
+#include "cameraproperties.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+
+class Timeline
+{
+public:
+    Timeline() : running(false) {}
+
+    QMutex mutex;
+    QElapsedTimer timer;
+    QList<StartupTimeline::Phase> phases;
+    bool running;
+};
+
+Q_GLOBAL_STATIC(Timeline, timeline)
+
+void addPhase(Timeline *t, const QString &name)
+{
+    StartupTimeline::Phase phase;
+    phase.name = name;
+    phase.elapsed = t->timer.nsecsElapsed();
+    phase.duration = phase.elapsed - (t->phases.isEmpty() ? 0 : t->phases.last().elapsed);
+    t->phases.append(phase);
+}
+
+}
+
+/*!
+ * \brief StartupTimeline::start starts recording a new timeline, dropping the
+ * previous one
+ */
+void StartupTimeline::start()
+{
+    Timeline *t = timeline();
+    QMutexLocker locker(&t->mutex);
+    t->phases.clear();
+    t->running = true;
+    t->timer.start();
+}
+
+/*!
+ * \brief StartupTimeline::mark records that a step of the startup is done
+ */
+void StartupTimeline::mark(const QString &phase)
+{
+    Timeline *t = timeline();
+    QMutexLocker locker(&t->mutex);
+    if (!t->running)
+        return;
+
+    addPhase(t, phase);
+}
+
+/*!
+ * \brief StartupTimeline::finish records the last step of the startup and
+ * stops the timeline. The total time and the breakdown are logged if
+ * aal.camera.startup_timeline is set.
+ */
+void StartupTimeline::finish(const QString &phase)
+{
+    Timeline *t = timeline();
+    {
+        QMutexLocker locker(&t->mutex);
+        if (!t->running)
+            return;
+
+        addPhase(t, phase);
+        t->running = false;
+    }
+
+    if (CameraProperties::boolValue("aal.camera.startup_timeline", false)) {
+        qDebug() << "Camera started in" << totalTime() / 1000000 << "ms";
+        qDebug().noquote() << report();
+    }
+}
+
+bool StartupTimeline::isRunning()
+{
+    Timeline *t = timeline();
+    QMutexLocker locker(&t->mutex);
+    return t->running;
+}
+
+/*!
+ * \brief StartupTimeline::totalTime returns the time, in ns, from start() to
+ * the last recorded step
+ */
+qint64 StartupTimeline::totalTime()
+{
+    Timeline *t = timeline();
+    QMutexLocker locker(&t->mutex);
+    return t->phases.isEmpty() ? 0 : t->phases.last().elapsed;
+}
+
+QList<StartupTimeline::Phase> StartupTimeline::phases()
+{
+    Timeline *t = timeline();
+    QMutexLocker locker(&t->mutex);
+    return t->phases;
+}
+
+/*!
+ * \brief StartupTimeline::report returns a table with the time spent in each
+ * step, and the time since start() at the end of it
+ */
+QString StartupTimeline::report()
+{
+    QString result = QString("%1 %2  %3\n").arg("step (ms)", 10).arg("total", 9).arg("phase");
+    Q_FOREACH (const Phase &phase, phases()) {
+        result += QString("%1 %2  %3\n").arg(phase.duration / 1000000.0, 10, 'f', 2)
+                                       .arg(phase.elapsed / 1000000.0, 9, 'f', 2)
+                                       .arg(phase.name);
+    }
+    return result;
+}
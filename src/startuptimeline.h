@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QList>
+#include <QString>
+
+/*!
+ * \brief StartupTimeline records how long each step of a camera cold start
+ * takes, from the creation of the service to the first viewfinder frame. Steps
+ * can be marked from any thread; marks outside of a start are ignored.
+ */
+class StartupTimeline
+{
+public:
+    class Phase
+    {
+    public:
+        QString name;
+        qint64 elapsed;   // since start(), in ns
+        qint64 duration;  // since the previous phase, in ns
+    };
+
+    static void start();
+    static void mark(const QString &phase);
+    static void finish(const QString &phase);
+
+    static bool isRunning();
+    static qint64 totalTime();
+    static QList<Phase> phases();
+    static QString report();
+};
+
+#endif // STARTUPTIMELINE_H
@@ -15,6 +15,7 @@
  */
 
 #include "storagemanager.h"
+#include "tracebuffer.h"
 
 #include <QDateTime>
 #include <QDebug>
@@ -96,6 +97,7 @@ QString StorageManager::fileNameGenerator(const QString &base, const QString& ex
 
 bool StorageManager::updateJpegMetadata(QByteArray data, QVariantMap metadata, QTemporaryFile* destination)
 {
+    TraceScope trace("storage: write exif");
     if (data.isEmpty() || destination == 0) return false;
 
     Exiv2::Image::AutoPtr image;
@@ -205,6 +207,7 @@ bool StorageManager::updateJpegMetadata(QByteArray data, QVariantMap metadata, Q
 SaveToDiskResult StorageManager::saveJpegImage(QByteArray data, QVariantMap metadata, QString fileName,
                                                QSize previewResolution, int captureID)
 {
+    TraceScope trace("storage: save jpeg");
     SaveToDiskResult result;
 
     QString captureFile;
@@ -229,7 +232,9 @@ SaveToDiskResult StorageManager::saveJpegImage(QByteArray data, QVariantMap meta
     scaledSize.scale(previewResolution, Qt::KeepAspectRatio);
     reader.setScaledSize(scaledSize);
     reader.setQuality(25);
+    TraceBuffer::begin("storage: decode preview");
     QImage image = reader.read();
+    TraceBuffer::end("storage: decode preview");
     Q_EMIT previewReady(captureID, image);
 
     QTemporaryFile file;
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "streamrelay.h"
+#include "tracebuffer.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+const int READ_SIZE = 64 * 1024;
+}
+
+/*!
+ * \brief StreamRelay::StreamRelay takes over the file descriptors it is given
+ * \param input the read end of the pipe the recorder writes to
+ * \param output the consumer, set to non-blocking mode
+ * \param tee the file to write the stream to as well, -1 for none; it is
+ * written with at most TEE_BUFFER_SIZE bytes pending
+ * \param backlogSize how many bytes to keep for the consumer at most
+ */
+StreamRelay::StreamRelay(int input, int output, int tee, int backlogSize, QObject *parent)
+    : QThread(parent),
+      m_input(input),
+      m_output(output),
+      m_teeWriter(tee >= 0 ? new TeeWriter(tee, TEE_BUFFER_SIZE) : 0),
+      m_backlogSize(qMax(backlogSize, PACKET_SIZE)),
+      m_received(0),
+      m_forwarded(0),
+      m_dropped(0),
+      m_dropEvents(0),
+      m_consumerGone(false)
+{
+    setObjectName("stream relay");
+}
+
+StreamRelay::~StreamRelay()
+{
+    wait();
+    if (m_input >= 0)
+        close(m_input);
+    if (m_output >= 0)
+        close(m_output);
+    delete m_teeWriter;
+}
+
+qint64 StreamRelay::bytesReceived() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_received;
+}
+
+qint64 StreamRelay::bytesForwarded() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_forwarded;
+}
+
+qint64 StreamRelay::bytesDropped() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_dropped;
+}
+
+/*!
+ * \brief StreamRelay::dropEvents returns how many times data was dropped
+ * because the consumer did not keep up
+ */
+int StreamRelay::dropEvents() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_dropEvents;
+}
+
+/*!
+ * \brief StreamRelay::consumerGone returns whether the consumer closed its end
+ */
+bool StreamRelay::consumerGone() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_consumerGone;
+}
+
+/*!
+ * \brief StreamRelay::teeBytesDropped returns how much of the stream was not
+ * written to the file because the disk did not keep up
+ */
+qint64 StreamRelay::teeBytesDropped() const
+{
+    return m_teeWriter != 0 ? m_teeWriter->bytesDropped() : 0;
+}
+
+/*!
+ * \brief StreamRelay::run relays the stream until the recorder closes the pipe
+ */
+void StreamRelay::run()
+{
+    // A consumer that went away is noticed with EPIPE
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, 0);
+
+    if (m_teeWriter != 0)
+        m_teeWriter->start();
+
+    QByteArray buffer(READ_SIZE, Qt::Uninitialized);
+    Q_FOREVER {
+        struct pollfd fds[2] = {
+            { m_input, POLLIN, 0 },
+            { m_output, POLLOUT, 0 }
+        };
+        const int count = (m_output >= 0 && !m_backlog.isEmpty()) ? 2 : 1;
+        if (poll(fds, count, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            qWarning() << "Stream relay failed:" << strerror(errno);
+            break;
+        }
+
+        if (count == 2 && fds[1].revents != 0)
+            forward();
+
+        if (fds[0].revents == 0)
+            continue;
+
+        ssize_t size = read(m_input, buffer.data(), buffer.size());
+        if (size < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            qWarning() << "Failed to read the stream:" << strerror(errno);
+            break;
+        }
+        if (size == 0)
+            break;
+
+        if (m_teeWriter != 0)
+            m_teeWriter->append(buffer.constData(), size);
+
+        QMutexLocker locker(&m_mutex);
+        m_received += size;
+        if (m_output < 0) {
+            m_dropped += size;
+            continue;
+        }
+        locker.unlock();
+
+        m_backlog.append(buffer.constData(), size);
+        forward();
+        dropOverflow();
+    }
+
+    // The rest goes out only if the consumer can take it right away
+    forward();
+    QMutexLocker locker(&m_mutex);
+    m_dropped += m_backlog.size();
+    m_backlog.clear();
+    locker.unlock();
+
+    // The file gets what is still buffered for it
+    if (m_teeWriter != 0)
+        m_teeWriter->finish();
+}
+
+/*!
+ * \brief StreamRelay::forward writes as much of the backlog as the consumer
+ * takes without blocking
+ */
+void StreamRelay::forward()
+{
+    while (m_output >= 0 && !m_backlog.isEmpty()) {
+        ssize_t written = write(m_output, m_backlog.constData(), m_backlog.size());
+        if (written > 0) {
+            m_backlog.remove(0, written);
+            QMutexLocker locker(&m_mutex);
+            m_forwarded += written;
+            continue;
+        }
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+
+        qWarning() << "The stream consumer went away:" << strerror(errno);
+        close(m_output);
+        m_output = -1;
+
+        QMutexLocker locker(&m_mutex);
+        m_dropped += m_backlog.size();
+        m_consumerGone = true;
+        m_backlog.clear();
+    }
+}
+
+/*!
+ * \brief StreamRelay::dropOverflow drops the oldest whole packets of the
+ * backlog beyond its size. A packet the consumer got part of is completed
+ * first, so that the consumer stays aligned on packets.
+ */
+void StreamRelay::dropOverflow()
+{
+    const int excess = m_backlog.size() - m_backlogSize;
+    if (excess <= 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    const int started = m_forwarded % PACKET_SIZE;
+    const int keep = started > 0 ? PACKET_SIZE - started : 0;
+    const int droppable = (m_backlog.size() - keep) / PACKET_SIZE * PACKET_SIZE;
+    const int drop = qMin((excess + PACKET_SIZE - 1) / PACKET_SIZE * PACKET_SIZE, droppable);
+    if (drop <= 0)
+        return;
+
+    m_backlog.remove(keep, drop);
+    m_dropped += drop;
+    ++m_dropEvents;
+    TraceBuffer::instant("stream: drop");
+}
+
+/*!
+ * \brief StreamRelay::TeeWriter::TeeWriter takes over fd
+ * \param bufferSize how many bytes may wait to be written at most
+ */
+StreamRelay::TeeWriter::TeeWriter(int fd, int bufferSize)
+    : m_fd(fd),
+      m_bufferSize(qMax(bufferSize, PACKET_SIZE)),
+      m_taken(0),
+      m_dropped(0),
+      m_finished(false),
+      m_failed(false)
+{
+    setObjectName("stream tee");
+}
+
+StreamRelay::TeeWriter::~TeeWriter()
+{
+    finish();
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+/*!
+ * \brief StreamRelay::TeeWriter::append queues data to be written without
+ * blocking. Beyond the buffer size, the oldest whole packets that were not
+ * taken for writing yet are dropped, so that the file stays aligned on packets.
+ */
+void StreamRelay::TeeWriter::append(const char *data, int size)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_failed)
+        return;
+
+    m_buffer.append(data, size);
+    m_wakeUp.wakeAll();
+
+    const int excess = m_buffer.size() - m_bufferSize;
+    if (excess <= 0)
+        return;
+
+    const int started = m_taken % PACKET_SIZE;
+    const int keep = started > 0 ? PACKET_SIZE - started : 0;
+    const int droppable = (m_buffer.size() - keep) / PACKET_SIZE * PACKET_SIZE;
+    const int drop = qMin((excess + PACKET_SIZE - 1) / PACKET_SIZE * PACKET_SIZE, droppable);
+    if (drop <= 0)
+        return;
+
+    m_buffer.remove(keep, drop);
+    m_dropped += drop;
+    TraceBuffer::instant("stream: tee drop");
+}
+
+/*!
+ * \brief StreamRelay::TeeWriter::finish writes what is left and ends the thread
+ */
+void StreamRelay::TeeWriter::finish()
+{
+    QMutexLocker locker(&m_mutex);
+    m_finished = true;
+    m_wakeUp.wakeAll();
+    locker.unlock();
+
+    wait();
+}
+
+qint64 StreamRelay::TeeWriter::bytesDropped() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_dropped;
+}
+
+void StreamRelay::TeeWriter::run()
+{
+    QByteArray chunk;
+    Q_FOREVER {
+        QMutexLocker locker(&m_mutex);
+        while (m_buffer.isEmpty() && !m_finished)
+            m_wakeUp.wait(&m_mutex);
+        if (m_buffer.isEmpty())
+            return;
+        chunk.clear();
+        chunk.swap(m_buffer);
+        m_taken += chunk.size();
+        locker.unlock();
+
+        const char *data = chunk.constData();
+        int size = chunk.size();
+        while (size > 0) {
+            ssize_t written = write(m_fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                qWarning() << "Failed to write the stream to the file:" << strerror(errno);
+                close(m_fd);
+                m_fd = -1;
+
+                locker.relock();
+                m_failed = true;
+                m_buffer.clear();
+                return;
+            }
+            data += written;
+            size -= written;
+        }
+    }
+}
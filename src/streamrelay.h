@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STREAMRELAY_H
+#define STREAMRELAY_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+/*!
+ * \brief StreamRelay forwards the MPEG-TS output of the recorder, read from a
+ * pipe, to a consumer such as a streaming daemon, and optionally to a file.
+ *
+ * The pipe is always drained, so that the encoder never waits for the
+ * consumer: what the consumer can't take right away is kept in a bounded
+ * backlog, and when the backlog is full its oldest whole TS packets are
+ * dropped. The consumer thus only ever sees complete packets, and can
+ * resynchronize on the next key frame.
+ *
+ * The file is written from a thread of its own, so that a stalled disk holds
+ * up neither the consumer nor the encoder. Its buffer is bounded the same
+ * way, by dropping whole packets.
+ */
+class StreamRelay : public QThread
+{
+public:
+    StreamRelay(int input, int output, int tee, int backlogSize, QObject *parent = 0);
+    ~StreamRelay();
+
+    qint64 bytesReceived() const;
+    qint64 bytesForwarded() const;
+    qint64 bytesDropped() const;
+    int dropEvents() const;
+    bool consumerGone() const;
+    qint64 teeBytesDropped() const;
+
+    static const int PACKET_SIZE = 188;
+    static const int TEE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+protected:
+    void run();
+
+private:
+    class TeeWriter : public QThread
+    {
+    public:
+        TeeWriter(int fd, int bufferSize);
+        ~TeeWriter();
+
+        void append(const char *data, int size);
+        void finish();
+        qint64 bytesDropped() const;
+
+    protected:
+        void run();
+
+    private:
+        int m_fd;
+        int m_bufferSize;
+
+        mutable QMutex m_mutex;
+        QWaitCondition m_wakeUp;
+        QByteArray m_buffer;
+        qint64 m_taken;
+        qint64 m_dropped;
+        bool m_finished;
+        bool m_failed;
+    };
+
+    void forward();
+    void dropOverflow();
+
+    int m_input;
+    int m_output;
+    TeeWriter *m_teeWriter;
+    int m_backlogSize;
+    QByteArray m_backlog;
+
+    mutable QMutex m_mutex;
+    qint64 m_received;
+    qint64 m_forwarded;
+    qint64 m_dropped;
+    int m_dropEvents;
+    bool m_consumerGone;
+};
+
+#endif // STREAMRELAY_H
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tracebuffer.h"
+#include "cameraproperties.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+namespace {
+
+class Event
+{
+public:
+    Event() : name(0), timestamp(0), phase(0) {}
+
+    const char *name;
+    qint64 timestamp;   // in ns, since the first event of the process
+    char phase;         // 'B', 'E' or 'i', as in the Chrome trace format
+};
+
+/*!
+ * \brief Ring is the buffer of one thread. Only its thread writes to it, the
+ * dump reads the events published by m_next.
+ */
+class Ring
+{
+public:
+    Ring(int id, const QString &threadName, int capacity)
+        : id(id), threadName(threadName), events(capacity), next(0) {}
+
+    int id;
+    QString threadName;
+    QVector<Event> events;
+    QAtomicInteger<quint64> next;
+};
+
+class Trace
+{
+public:
+    Trace() : clearedAt(0)
+    {
+        capacity = qMax(16, CameraProperties::intValue("aal.camera.trace_events", 8192));
+        timer.start();
+    }
+
+    ~Trace()
+    {
+        qDeleteAll(rings);
+    }
+
+    QMutex mutex;
+    QList<Ring*> rings;
+    QElapsedTimer timer;
+    QAtomicInteger<qint64> clearedAt;
+    int capacity;
+};
+
+Q_GLOBAL_STATIC(Trace, trace)
+
+QBasicAtomicInt traceEnabled = Q_BASIC_ATOMIC_INITIALIZER(-1);
+
+// Rings outlive their thread, so that the events of finished save workers are
+// still in the dump
+thread_local Ring *threadRing = 0;
+
+Ring *currentRing(Trace *t)
+{
+    if (!threadRing) {
+        QThread *thread = QThread::currentThread();
+        QString name = thread->objectName();
+        if (name.isEmpty() && QCoreApplication::instance() &&
+            thread == QCoreApplication::instance()->thread()) {
+            name = QStringLiteral("main");
+        }
+
+        QMutexLocker locker(&t->mutex);
+        if (name.isEmpty())
+            name = QString("thread %1").arg(t->rings.count());
+        threadRing = new Ring(t->rings.count(), name, t->capacity);
+        t->rings.append(threadRing);
+    }
+    return threadRing;
+}
+
+void record(const char *name, char phase)
+{
+    if (!TraceBuffer::isEnabled())
+        return;
+
+    Trace *t = trace();
+    Ring *ring = currentRing(t);
+    quint64 index = ring->next.load();
+    Event &event = ring->events[index % ring->events.size()];
+    event.name = name;
+    event.phase = phase;
+    event.timestamp = t->timer.nsecsElapsed();
+    ring->next.storeRelease(index + 1);
+}
+
+}
+
+bool TraceBuffer::isEnabled()
+{
+    int value = traceEnabled.loadAcquire();
+    if (value < 0) {
+        value = CameraProperties::boolValue("aal.camera.trace", false) ? 1 : 0;
+        traceEnabled.storeRelease(value);
+    }
+    return value;
+}
+
+void TraceBuffer::setEnabled(bool value)
+{
+    traceEnabled.storeRelease(value ? 1 : 0);
+}
+
+void TraceBuffer::begin(const char *name)
+{
+    record(name, 'B');
+}
+
+void TraceBuffer::end(const char *name)
+{
+    record(name, 'E');
+}
+
+void TraceBuffer::instant(const char *name)
+{
+    record(name, 'i');
+}
+
+/*!
+ * \brief TraceBuffer::clear drops the events recorded so far. The rings are
+ * not touched, as other threads may be writing to them; older events are
+ * filtered out of the dump instead.
+ */
+void TraceBuffer::clear()
+{
+    Trace *t = trace();
+    t->clearedAt.storeRelease(t->timer.nsecsElapsed());
+}
+
+/*!
+ * \brief TraceBuffer::toJson returns the events of all threads in the Chrome
+ * trace event format. An event being overwritten while the dump runs can come
+ * out garbled, so it is best taken when the camera is idle.
+ */
+QByteArray TraceBuffer::toJson()
+{
+    Trace *t = trace();
+    const qint64 clearedAt = t->clearedAt.loadAcquire();
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray events;
+    QMutexLocker locker(&t->mutex);
+    Q_FOREACH (Ring *ring, t->rings) {
+        QJsonObject threadName;
+        threadName["name"] = QStringLiteral("thread_name");
+        threadName["ph"] = QStringLiteral("M");
+        threadName["pid"] = pid;
+        threadName["tid"] = ring->id;
+        QJsonObject args;
+        args["name"] = ring->threadName;
+        threadName["args"] = args;
+        events.append(threadName);
+
+        const quint64 next = ring->next.loadAcquire();
+        const quint64 size = ring->events.size();
+        const quint64 first = next > size ? next - size : 0;
+        for (quint64 i = first; i < next; ++i) {
+            const Event event = ring->events.at(i % size);
+            if (!event.name || event.timestamp < clearedAt)
+                continue;
+
+            QJsonObject object;
+            object["name"] = QString::fromLatin1(event.name);
+            object["ph"] = QString(QLatin1Char(event.phase));
+            object["ts"] = event.timestamp / 1000.0;
+            object["pid"] = pid;
+            object["tid"] = ring->id;
+            if (event.phase == 'i')
+                object["s"] = QStringLiteral("t");
+            events.append(object);
+        }
+    }
+    locker.unlock();
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = QStringLiteral("ms");
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+/*!
+ * \brief TraceBuffer::save writes the trace to fileName
+ * \return true if the file was written
+ */
+bool TraceBuffer::save(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not write the trace to" << fileName << ":" << file.errorString();
+        return false;
+    }
+
+    const QByteArray json = toJson();
+    return file.write(json) == json.size();
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACEBUFFER_H
+#define TRACEBUFFER_H
+
+#include <QByteArray>
+#include <QString>
+
+/*!
+ * \brief TraceBuffer records begin/end/instant events in one ring buffer per
+ * thread, so that what the GUI thread, the save workers, the audio capture
+ * thread and the HAL callback threads did can be seen side by side. The trace
+ * is exported as Chrome trace JSON, which chrome://tracing and Perfetto open.
+ *
+ * Recording is off unless aal.camera.trace is set; each thread then keeps its
+ * last aal.camera.trace_events events. Writing an event takes no lock, event
+ * names must be string literals.
+ */
+class TraceBuffer
+{
+public:
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    static void begin(const char *name);
+    static void end(const char *name);
+    static void instant(const char *name);
+
+    static void clear();
+    static QByteArray toJson();
+    static bool save(const QString &fileName);
+};
+
+/*!
+ * \brief TraceScope records a begin event on construction and the matching end
+ * event on destruction
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name) : m_name(name) { TraceBuffer::begin(m_name); }
+    ~TraceScope() { TraceBuffer::end(m_name); }
+
+private:
+    const char *m_name;
+};
+
+#endif // TRACEBUFFER_H
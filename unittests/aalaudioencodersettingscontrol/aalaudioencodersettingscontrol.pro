@@ -0,0 +1,16 @@
+include(../../coverage.pri)
+
+TARGET = tst_aalaudioencodersettingscontrol
+
+QT += testlib multimedia
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/aalaudioencodersettingscontrol.h
+
+SOURCES += tst_aalaudioencodersettingscontrol.cpp \
+    ../../src/aalaudioencodersettingscontrol.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+
+#include "aalaudioencodersettingscontrol.h"
+
+class tst_AalAudioEncoderSettingsControl : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void defaults();
+    void supportedValues();
+    void setAudioSettings();
+    void unsupportedSettings();
+};
+
+void tst_AalAudioEncoderSettingsControl::defaults()
+{
+    AalAudioEncoderSettingsControl control;
+    QAudioEncoderSettings settings = control.audioSettings();
+
+    // The format the microphone is captured in, so nothing is resampled
+    QCOMPARE(settings.sampleRate(), 48000);
+    QCOMPARE(settings.channelCount(), 1);
+    QCOMPARE(settings.codec(), QString("AAC"));
+    QVERIFY(settings.bitRate() > 0);
+}
+
+void tst_AalAudioEncoderSettingsControl::supportedValues()
+{
+    AalAudioEncoderSettingsControl control;
+
+    bool continuous = true;
+    QList<int> rates = control.supportedSampleRates(QAudioEncoderSettings(), &continuous);
+    QVERIFY(!continuous);
+    QVERIFY(rates.contains(48000));
+    QVERIFY(rates.contains(44100));
+    QVERIFY(!rates.contains(96000));
+
+    QCOMPARE(control.supportedChannelCounts(), QList<int>() << 1 << 2);
+    QCOMPARE(control.supportedAudioCodecs(), QStringList() << "AAC");
+}
+
+void tst_AalAudioEncoderSettingsControl::setAudioSettings()
+{
+    AalAudioEncoderSettingsControl control;
+
+    QAudioEncoderSettings settings;
+    settings.setSampleRate(44100);
+    settings.setChannelCount(2);
+    settings.setBitRate(128000);
+    control.setAudioSettings(settings);
+    QCOMPARE(control.audioSettings().sampleRate(), 44100);
+    QCOMPARE(control.audioSettings().channelCount(), 2);
+    QCOMPARE(control.audioSettings().bitRate(), 128000);
+
+    control.resetAllSettings();
+    QCOMPARE(control.audioSettings().sampleRate(), 48000);
+    QCOMPARE(control.audioSettings().channelCount(), 1);
+}
+
+void tst_AalAudioEncoderSettingsControl::unsupportedSettings()
+{
+    AalAudioEncoderSettingsControl control;
+
+    // Unsupported and unset values leave the current ones
+    QAudioEncoderSettings settings;
+    settings.setCodec("mp3");
+    settings.setSampleRate(96000);
+    settings.setChannelCount(6);
+    control.setAudioSettings(settings);
+    QCOMPARE(control.audioSettings().codec(), QString("AAC"));
+    QCOMPARE(control.audioSettings().sampleRate(), 48000);
+    QCOMPARE(control.audioSettings().channelCount(), 1);
+    QVERIFY(control.audioSettings().bitRate() > 0);
+}
+
+QTEST_GUILESS_MAIN(tst_AalAudioEncoderSettingsControl)
+
+#include "tst_aalaudioencodersettingscontrol.moc"
@@ -9,11 +9,15 @@ INCLUDEPATH += ../../src
 INCLUDEPATH += ../mocks/aal
 
 HEADERS += ../../src/aalcameracontrol.h \
-    ../../src/aalcameraservice.h
+    ../../src/aalcameraservice.h \
+    ../../src/cameraproperties.h \
+    ../../src/haleventqueue.h
 
 SOURCES += tst_aalcameracontrol.cpp \
     ../../src/aalcameracontrol.cpp \
-    aalcameraservice.cpp
+    ../../src/haleventqueue.cpp \
+    aalcameraservice.cpp \
+    ../stubs/cameraproperties_stub.cpp
 
 check.depends = $${TARGET}
 check.commands = ./$${TARGET}
@@ -16,13 +16,12 @@
 
 #include "aalcameraservice.h"
 
-AalCameraService *AalCameraService::m_service = 0;
-
 class CameraControl {};
 
 AalCameraService::AalCameraService(QObject *parent) :
     QMediaService(parent),
-    m_androidControl(new CameraControl()),
+    m_mediaRecorderControl(0),
+    m_androidControl(0),
     m_androidListener(0)
 {
 }
@@ -43,6 +42,11 @@ void AalCameraService::releaseControl(QMediaControl *control)
     Q_UNUSED(control);
 }
 
+AalMediaRecorderControl *AalCameraService::mediaRecorderControl()
+{
+    return m_mediaRecorderControl;
+}
+
 CameraControl *AalCameraService::androidControl()
 {
     return m_androidControl;
@@ -50,15 +54,25 @@ CameraControl *AalCameraService::androidControl()
 
 bool AalCameraService::connectCamera()
 {
+    if (!m_androidControl)
+        m_androidControl = new CameraControl();
     return true;
 }
 
+void AalCameraService::connectCameraAsync()
+{
+    Q_EMIT cameraConnected(connectCamera());
+}
+
 void AalCameraService::disconnectCamera()
 {
+    delete m_androidControl;
+    m_androidControl = 0;
 }
 
 void AalCameraService::startPreview()
 {
+    Q_EMIT previewStarted();
 }
 
 void AalCameraService::stopPreview()
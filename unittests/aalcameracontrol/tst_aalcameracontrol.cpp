@@ -31,6 +31,11 @@ private slots:
 
     void setState();
     void captureMode();
+    void standby();
+    void standbyTimeout();
+    void resumeLoaded();
+    void reconnect();
+    void unload();
 
 private:
     AalCameraControl *m_cameraControl;
@@ -39,6 +44,8 @@ private:
 
 void tst_AalCameraControl::initTestCase()
 {
+    qRegisterMetaType<QCamera::Status>();
+
     m_service = new AalCameraService();
     m_cameraControl = new AalCameraControl(m_service);
 }
@@ -52,12 +59,20 @@ void tst_AalCameraControl::cleanupTestCase()
 void tst_AalCameraControl::setState()
 {
     QSignalSpy spy(m_cameraControl, SIGNAL(stateChanged(QCamera::State)));
+    QSignalSpy statusSpy(m_cameraControl, SIGNAL(statusChanged(QCamera::Status)));
 
     QCamera::State state = QCamera::ActiveState;
     m_cameraControl->setState(state);
 
     QCOMPARE(m_cameraControl->state(), state);
     QCOMPARE(spy.count(), 1);
+
+    QCOMPARE(m_cameraControl->status(), QCamera::ActiveStatus);
+    QCOMPARE(statusSpy.count(), 4);
+    QCOMPARE(statusSpy.at(0).at(0).value<QCamera::Status>(), QCamera::LoadingStatus);
+    QCOMPARE(statusSpy.at(1).at(0).value<QCamera::Status>(), QCamera::LoadedStatus);
+    QCOMPARE(statusSpy.at(2).at(0).value<QCamera::Status>(), QCamera::StartingStatus);
+    QCOMPARE(statusSpy.at(3).at(0).value<QCamera::Status>(), QCamera::ActiveStatus);
 }
 
 void tst_AalCameraControl::captureMode()
@@ -71,6 +86,86 @@ void tst_AalCameraControl::captureMode()
     QCOMPARE(spy.count(), 1);
 }
 
+void tst_AalCameraControl::standby()
+{
+    m_cameraControl->setState(QCamera::ActiveState);
+    m_cameraControl->m_previousApplicationState = Qt::ApplicationActive;
+
+    m_cameraControl->setApplicationState(Qt::ApplicationInactive);
+    QCOMPARE(m_cameraControl->state(), QCamera::LoadedState);
+    QVERIFY(m_service->androidControl() != 0);
+    QVERIFY(m_cameraControl->m_standbyTimer.isActive());
+
+    m_cameraControl->setApplicationState(Qt::ApplicationActive);
+    QCOMPARE(m_cameraControl->state(), QCamera::ActiveState);
+    QCOMPARE(m_cameraControl->status(), QCamera::ActiveStatus);
+    QVERIFY(!m_cameraControl->m_standbyTimer.isActive());
+    QVERIFY(m_cameraControl->resumeLatency() >= 0);
+    QVERIFY(m_cameraControl->m_resumeWarm);
+}
+
+void tst_AalCameraControl::standbyTimeout()
+{
+    m_cameraControl->setState(QCamera::ActiveState);
+    m_cameraControl->m_previousApplicationState = Qt::ApplicationActive;
+    m_cameraControl->m_standbyTimer.setInterval(10);
+
+    m_cameraControl->setApplicationState(Qt::ApplicationSuspended);
+    QCOMPARE(m_cameraControl->state(), QCamera::LoadedState);
+    QTRY_COMPARE(m_cameraControl->state(), QCamera::UnloadedState);
+    QVERIFY(!m_service->androidControl());
+
+    m_cameraControl->setApplicationState(Qt::ApplicationActive);
+    QCOMPARE(m_cameraControl->state(), QCamera::ActiveState);
+    QVERIFY(!m_cameraControl->m_resumeWarm);
+}
+
+void tst_AalCameraControl::resumeLoaded()
+{
+    m_cameraControl->setState(QCamera::LoadedState);
+    m_cameraControl->m_previousApplicationState = Qt::ApplicationActive;
+
+    m_cameraControl->setApplicationState(Qt::ApplicationInactive);
+    m_cameraControl->setApplicationState(Qt::ApplicationActive);
+    QCOMPARE(m_cameraControl->state(), QCamera::LoadedState);
+
+    // No viewfinder comes back, so there is nothing to measure
+    QVERIFY(!m_cameraControl->m_resumeTimer.isValid());
+}
+
+void tst_AalCameraControl::reconnect()
+{
+    m_cameraControl->setState(QCamera::ActiveState);
+    QSignalSpy statusSpy(m_cameraControl, SIGNAL(statusChanged(QCamera::Status)));
+    QSignalSpy modeSpy(m_cameraControl, SIGNAL(captureModeChanged(QCamera::CaptureModes)));
+
+    // As for a switch to another device
+    m_service->disconnectCamera();
+    m_cameraControl->reconnect();
+
+    QCOMPARE(m_cameraControl->state(), QCamera::ActiveState);
+    QCOMPARE(m_cameraControl->status(), QCamera::ActiveStatus);
+    QVERIFY(m_service->androidControl() != 0);
+    QCOMPARE(statusSpy.count(), 4);
+    QCOMPARE(statusSpy.at(0).at(0).value<QCamera::Status>(), QCamera::LoadingStatus);
+    QCOMPARE(statusSpy.at(1).at(0).value<QCamera::Status>(), QCamera::LoadedStatus);
+    QCOMPARE(statusSpy.at(2).at(0).value<QCamera::Status>(), QCamera::StartingStatus);
+    QCOMPARE(statusSpy.at(3).at(0).value<QCamera::Status>(), QCamera::ActiveStatus);
+    QCOMPARE(modeSpy.count(), 1);
+}
+
+void tst_AalCameraControl::unload()
+{
+    QSignalSpy spy(m_cameraControl, SIGNAL(stateChanged(QCamera::State)));
+
+    m_cameraControl->setState(QCamera::UnloadedState);
+
+    QCOMPARE(m_cameraControl->state(), QCamera::UnloadedState);
+    QCOMPARE(m_cameraControl->status(), QCamera::UnloadedStatus);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(!m_service->androidControl());
+}
+
 QTEST_GUILESS_MAIN(tst_AalCameraControl)
 
 #include "tst_aalcameracontrol.moc"
@@ -19,8 +19,6 @@
 #include "camera_control.h"
 #include "camera_compatibility_layer.h"
 
-AalCameraService *AalCameraService::m_service = 0;
-
 AalCameraService::AalCameraService(QObject *parent) :
     QMediaService(parent),
     m_androidControl(0),
@@ -45,11 +43,25 @@ void AalCameraService::releaseControl(QMediaControl *control)
     Q_UNUSED(control);
 }
 
+AalCameraExposureControl *AalCameraService::exposureControl()
+{
+    return m_exposureControl;
+}
+
 CameraControl *AalCameraService::androidControl()
 {
     return m_androidControl;
 }
 
+void AalCameraService::setCameraParameter(CameraParameter parameter, const ParameterSetter &setter,
+                                          bool needsPreviewRestart)
+{
+    Q_UNUSED(parameter);
+    Q_UNUSED(needsPreviewRestart);
+    if (m_androidControl)
+        setter(m_androidControl);
+}
+
 bool AalCameraService::connectCamera()
 {
     m_androidListener = new CameraControlListener;
@@ -84,6 +96,10 @@ void AalCameraService::initControls(CameraControl *camControl, CameraControlList
     m_exposureControl->init(camControl, listener);
 }
 
+void AalCameraService::ensureDeferredInit()
+{
+}
+
 void AalCameraService::updateCaptureReady()
 {
 }
@@ -17,8 +17,6 @@
 #include "aalcameraservice.h"
 #include "aalcameracontrol.h"
 
-AalCameraService *AalCameraService::m_service = 0;
-
 AalCameraService::AalCameraService(QObject *parent) :
     QMediaService(parent),
     m_androidControl(0),
@@ -48,6 +46,15 @@ CameraControl *AalCameraService::androidControl()
     return m_androidControl;
 }
 
+void AalCameraService::setCameraParameter(CameraParameter parameter, const ParameterSetter &setter,
+                                          bool needsPreviewRestart)
+{
+    Q_UNUSED(parameter);
+    Q_UNUSED(needsPreviewRestart);
+    if (m_androidControl)
+        setter(m_androidControl);
+}
+
 bool AalCameraService::connectCamera()
 {
     return true;
@@ -86,6 +93,10 @@ bool AalCameraService::isBackCameraUsed() const
     return true;
 }
 
+void AalCameraService::ensureDeferredInit()
+{
+}
+
 void AalCameraService::updateCaptureReady()
 {
 }
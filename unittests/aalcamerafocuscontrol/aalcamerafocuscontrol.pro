@@ -11,10 +11,12 @@ INCLUDEPATH += ../mocks/aal
 HEADERS += ../../src/aalcamerafocuscontrol.h \
     ../../src/aalcameraservice.h \
     ../../src/aalimagecapturecontrol.h \
+    ../../src/haleventqueue.h \
     ../../src/storagemanager.h
 
 SOURCES += tst_aalcamerafocuscontrol.cpp \
     ../../src/aalcamerafocuscontrol.cpp \
+    ../../src/haleventqueue.cpp \
     storagemanager.cpp \
     aalcameraservice.cpp \
     aalimagecapturecontrol.cpp
@@ -16,8 +16,6 @@
 
 #include "aalcameraservice.h"
 
-AalCameraService *AalCameraService::m_service = 0;
-
 AalCameraService::AalCameraService(QObject *parent) :
     QMediaService(parent),
     m_androidControl(0),
@@ -45,6 +43,21 @@ CameraControl *AalCameraService::androidControl()
     return m_androidControl;
 }
 
+void AalCameraService::setCameraParameter(CameraParameter parameter, const ParameterSetter &setter,
+                                          bool needsPreviewRestart)
+{
+    Q_UNUSED(parameter);
+    Q_UNUSED(needsPreviewRestart);
+    if (m_androidControl)
+        setter(m_androidControl);
+}
+
+void AalCameraService::sendCameraCommand(const ParameterSetter &command)
+{
+    if (m_androidControl)
+        command(m_androidControl);
+}
+
 bool AalCameraService::connectCamera()
 {
     return true;
@@ -73,6 +86,10 @@ void AalCameraService::initControls(CameraControl *camControl, CameraControlList
     Q_UNUSED(listener);
 }
 
+void AalCameraService::ensureDeferredInit()
+{
+}
+
 void AalCameraService::updateCaptureReady()
 {
 }
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QAbstractVideoSurface>
+#include <QCameraControl>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QVideoRendererControl>
+
+#include <qtubuntu_media_signals.h>
+
+#define private public
+#include "aalcameraflashcontrol.h"
+#include "aalcamerafocuscontrol.h"
+#include "aalcameraservice.h"
+#include "aalcamerazoomcontrol.h"
+#include "aalvideoencodersettingscontrol.h"
+#include "aalvideorenderercontrol.h"
+#include "cameraworker.h"
+
+/*!
+ * \brief The FakeSurface class stands in for the QML video output: it creates
+ * a texture for the first frame, as qtvideo-node does
+ */
+class FakeSurface : public QAbstractVideoSurface
+{
+public:
+    QList<QVideoFrame::PixelFormat> supportedPixelFormats(QAbstractVideoBuffer::HandleType type) const
+    {
+        Q_UNUSED(type);
+        return QList<QVideoFrame::PixelFormat>() << QVideoFrame::Format_RGB32;
+    }
+
+    bool present(const QVideoFrame &frame)
+    {
+        if (frame.handle().toUInt() == 0) {
+            Q_EMIT SharedSignal::instance()->textureCreated(1);
+        }
+        return true;
+    }
+};
+
+class tst_AalCameraService : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void deferredInitAfterFirstFrame();
+    void deferredInitWhenQueried();
+    void modeSwitchHeldBack();
+    void parameterTransactionOrder();
+    void parameterTransactionNesting();
+    void parameterTransactionSingleRestart();
+    void reconnectWhileConnecting();
+    void videoFrameRates();
+
+private:
+    void startCamera(bool withSurface = true);
+
+    AalCameraService *m_service;
+    FakeSurface *m_surface;
+};
+
+void tst_AalCameraService::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void tst_AalCameraService::init()
+{
+    m_service = new AalCameraService();
+    m_surface = new FakeSurface;
+}
+
+/*!
+ * \brief tst_AalCameraService::startCamera starts the camera; with a surface
+ * it waits until the first frame is presented and the deferred controls are
+ * set up, without one only until the camera is connected
+ */
+void tst_AalCameraService::startCamera(bool withSurface)
+{
+    QVideoRendererControl *renderer =
+        qobject_cast<QVideoRendererControl*>(m_service->requestControl(QVideoRendererControl_iid));
+    QCameraControl *camera =
+        qobject_cast<QCameraControl*>(m_service->requestControl(QCameraControl_iid));
+    if (withSurface)
+        renderer->setSurface(m_surface);
+    camera->setState(QCamera::ActiveState);
+
+    if (withSurface) {
+        QTRY_VERIFY(m_service->isPreviewStarted() && !m_service->m_deferredInitPending);
+    } else {
+        QTRY_VERIFY(m_service->androidControl() != 0);
+    }
+    m_service->cameraWorker()->waitForIdle();
+}
+
+void tst_AalCameraService::cleanup()
+{
+    delete m_service;
+    delete m_surface;
+}
+
+void tst_AalCameraService::deferredInitAfterFirstFrame()
+{
+    bool pendingWhenConnected = false;
+    bool focusSetUpWhenConnected = true;
+    connect(m_service, &AalCameraService::cameraConnected, this, [&](bool success) {
+        QVERIFY(success);
+        pendingWhenConnected = m_service->m_deferredInitPending;
+        focusSetUpWhenConnected = m_service->m_androidListener->on_msg_focus_cb != 0;
+    });
+
+    startCamera();
+
+    // Only the controls needed for the viewfinder are set up when connecting
+    QVERIFY(pendingWhenConnected);
+    QVERIFY(!focusSetUpWhenConnected);
+    QVERIFY(m_service->m_androidListener->on_msg_focus_cb != 0);
+}
+
+void tst_AalCameraService::deferredInitWhenQueried()
+{
+    // Without a surface no frame is presented
+    startCamera(false);
+    QVERIFY(m_service->m_deferredInitPending);
+    QVERIFY(m_service->m_androidListener->on_msg_focus_cb == 0);
+
+    m_service->zoomControl()->maximumDigitalZoom();
+    QVERIFY(!m_service->m_deferredInitPending);
+    QVERIFY(m_service->m_androidListener->on_msg_focus_cb != 0);
+}
+
+void tst_AalCameraService::modeSwitchHeldBack()
+{
+    startCamera(false);
+    QSignalSpy spy(m_service->flashControl(), SIGNAL(flashReady(bool)));
+
+    m_service->enableVideoMode();
+    m_service->enablePhotoMode();
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(m_service->m_videoEncoderControl == 0);
+
+    // The deferred initialization applies the current capture mode once
+    m_service->ensureDeferredInit();
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(m_service->m_videoEncoderControl == 0);
+}
+
+void tst_AalCameraService::parameterTransactionOrder()
+{
+    startCamera();
+
+    QStringList applied;
+    QList<QThread*> threads;
+    auto setter = [&applied, &threads](const QString &name) {
+        return [&applied, &threads, name](CameraControl *cc) {
+            Q_UNUSED(cc);
+            applied.append(name);
+            threads.append(QThread::currentThread());
+        };
+    };
+
+    m_service->beginParameterTransaction();
+    m_service->setCameraParameter(AalCameraService::SceneModeParameter, setter("scene"));
+    m_service->setCameraParameter(AalCameraService::FlashModeParameter, setter("flash 1"));
+    m_service->setCameraParameter(AalCameraService::JpegQualityParameter, setter("jpeg"));
+    m_service->setCameraParameter(AalCameraService::FlashModeParameter, setter("flash 2"));
+    m_service->commitParameterTransaction();
+    m_service->cameraWorker()->waitForIdle();
+
+    // Staging order, with only the last value of a parameter
+    QCOMPARE(applied, QStringList() << "scene" << "jpeg" << "flash 2");
+    Q_FOREACH (QThread *thread, threads) {
+        QCOMPARE(thread, &m_service->m_cameraThread);
+    }
+
+    // A single parameter is applied on the camera thread too
+    applied.clear();
+    threads.clear();
+    m_service->setCameraParameter(AalCameraService::FlashModeParameter, setter("flash 3"));
+    m_service->cameraWorker()->waitForIdle();
+    QCOMPARE(applied, QStringList() << "flash 3");
+    QCOMPARE(threads.first(), &m_service->m_cameraThread);
+}
+
+void tst_AalCameraService::parameterTransactionNesting()
+{
+    startCamera();
+
+    QStringList applied;
+    auto setter = [&applied](const QString &name) {
+        return [&applied, name](CameraControl *cc) {
+            Q_UNUSED(cc);
+            applied.append(name);
+        };
+    };
+
+    m_service->beginParameterTransaction();
+    m_service->setCameraParameter(AalCameraService::FocusModeParameter, setter("focus"));
+    m_service->beginParameterTransaction();
+    m_service->setCameraParameter(AalCameraService::FlashModeParameter, setter("flash"));
+    m_service->commitParameterTransaction();
+    m_service->cameraWorker()->waitForIdle();
+    QVERIFY(applied.isEmpty());
+
+    m_service->commitParameterTransaction();
+    m_service->cameraWorker()->waitForIdle();
+    QCOMPARE(applied, QStringList() << "focus" << "flash");
+    QCOMPARE(m_service->m_transactionDepth, 0);
+}
+
+void tst_AalCameraService::parameterTransactionSingleRestart()
+{
+    startCamera();
+
+    QSignalSpy spy(m_service->cameraWorker(), SIGNAL(previewStarted()));
+    int applied = 0;
+    auto setter = [&applied](CameraControl *cc) {
+        Q_UNUSED(cc);
+        ++applied;
+    };
+
+    m_service->beginParameterTransaction();
+    m_service->setCameraParameter(AalCameraService::PreviewSizeParameter, setter, true);
+    m_service->setCameraParameter(AalCameraService::PreviewFrameRateParameter, setter, true);
+    m_service->setCameraParameter(AalCameraService::PreviewSizeParameter, setter, true);
+    m_service->setCameraParameter(AalCameraService::JpegQualityParameter, setter);
+    m_service->commitParameterTransaction();
+    m_service->cameraWorker()->waitForIdle();
+
+    QCOMPARE(applied, 3);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(m_service->isPreviewStarted());
+}
+
+/*!
+ * \brief tst_AalCameraService::reconnectWhileConnecting disconnects and
+ * connects again while the first connection is still running on the camera
+ * thread: only the second connection is reported
+ */
+void tst_AalCameraService::reconnectWhileConnecting()
+{
+    startCamera();
+
+    m_service->disconnectCamera();
+    QSignalSpy spy(m_service, SIGNAL(cameraConnected(bool)));
+
+    qputenv("AAL_MOCK_CONNECT_LATENCY", "50");
+    m_service->connectCameraAsync();
+    m_service->disconnectCamera();
+    m_service->connectCameraAsync();
+
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toBool(), true);
+    QVERIFY(m_service->androidControl() != 0);
+    m_service->cameraWorker()->waitForIdle();
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+    qunsetenv("AAL_MOCK_CONNECT_LATENCY");
+}
+
+void tst_AalCameraService::videoFrameRates()
+{
+    // Without a camera, the rates all cameras support
+    QCOMPARE(m_service->videoEncoderControl()->supportedFrameRates(QVideoEncoderSettings()),
+             QList<qreal>() << 15 << 30);
+    delete m_service->m_videoEncoderControl;
+    m_service->m_videoEncoderControl = 0;
+
+    // Then the standard rates up to the top of the preview frame rate range
+    // the camera reports
+    startCamera();
+    QCOMPARE(m_service->videoEncoderControl()->supportedFrameRates(QVideoEncoderSettings()),
+             QList<qreal>() << 15 << 24 << 30);
+}
+
+QTEST_MAIN(tst_AalCameraService)
+
+#include "tst_aalcameraservice.moc"
@@ -19,8 +19,6 @@
 #include <aalcamerazoomcontrol.h>
 #include <hybris/camera/camera_compatibility_layer.h>
 
-AalCameraService *AalCameraService::m_service = 0;
-
 AalCameraService::AalCameraService(QObject *parent) :
     QMediaService(parent),
     m_androidControl(0),
@@ -52,10 +50,26 @@ CameraControl *AalCameraService::androidControl()
     return m_androidControl;
 }
 
+void AalCameraService::setCameraParameter(CameraParameter parameter, const ParameterSetter &setter,
+                                          bool needsPreviewRestart)
+{
+    Q_UNUSED(parameter);
+    Q_UNUSED(needsPreviewRestart);
+    if (m_androidControl)
+        setter(m_androidControl);
+}
+
+void AalCameraService::sendCameraCommand(const ParameterSetter &command)
+{
+    if (m_androidControl)
+        command(m_androidControl);
+}
+
 bool AalCameraService::connectCamera()
 {
     m_androidListener = new CameraControlListener;
     m_androidControl = android_camera_connect_to(BACK_FACING_CAMERA_TYPE, m_androidListener);
+    m_capabilities.maxZoom = 4;
 
     initControls(m_androidControl, m_androidListener);
 
@@ -86,6 +100,10 @@ void AalCameraService::initControls(CameraControl *camControl, CameraControlList
     m_zoomControl->init(camControl, listener);
 }
 
+void AalCameraService::ensureDeferredInit()
+{
+}
+
 void AalCameraService::updateCaptureReady()
 {
 }
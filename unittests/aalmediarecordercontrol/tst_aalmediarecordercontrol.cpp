@@ -14,11 +14,20 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QElapsedTimer>
 #include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 #include <QUrl>
 
 #include "aalcameraservice.h"
+#include "fake_media_recorder.h"
+#include "segmentring.h"
+#include "streamrelay.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
 
 #define private public
 #include "aalmediarecordercontrol.h"
@@ -29,8 +38,17 @@ class tst_AalMediaRecorderControl : public QObject
 private slots:
     void initTestCase();
     void cleanupTestCase();
+    void cleanup();
 
     void setState();
+    void prewarm();
+    void releaseInPhotoMode();
+    void startWhilePrewarming();
+    void restartWhileFinalizing();
+    void loopRecording();
+    void streaming();
+    void telemetry();
+    void timeLapse();
 
 private:
     AalMediaRecorderControl *m_recorderControl;
@@ -50,6 +68,11 @@ void tst_AalMediaRecorderControl::cleanupTestCase()
     delete m_service;
 }
 
+void tst_AalMediaRecorderControl::cleanup()
+{
+    setFakeRecorderEnabled(false);
+}
+
 void tst_AalMediaRecorderControl::setState()
 {
     QString fileName("/tmp/videotest.avi");
@@ -69,7 +92,244 @@ void tst_AalMediaRecorderControl::setState()
 
     m_recorderControl->setState(QMediaRecorder::StoppedState);
     QCOMPARE(m_recorderControl->state(), QMediaRecorder::StoppedState);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+}
+
+void tst_AalMediaRecorderControl::prewarm()
+{
+    QTemporaryDir directory;
+    QString fileName = directory.path() + "/prewarmed.mp4";
+    m_recorderControl->setOutputLocation(QUrl(fileName));
+    m_recorderControl->m_prewarmEnabled = true;
+    m_service->cameraControl()->setCaptureMode(QCamera::CaptureVideo);
+
+    m_recorderControl->prewarm();
+    QTRY_VERIFY(m_recorderControl->m_prewarmed);
+    QVERIFY(m_recorderControl->mediaRecorder() != 0);
+    QString prewarmFile = QFile::decodeName(m_recorderControl->m_prewarmFile);
+    QVERIFY(QFile::exists(prewarmFile));
     QCOMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+
+    // Starting takes the pre-warmed recorder and moves its file in place
+    MediaRecorderWrapper *recorder = m_recorderControl->mediaRecorder();
+    m_recorderControl->setState(QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+    QCOMPARE(m_recorderControl->mediaRecorder(), recorder);
+    QVERIFY(!QFile::exists(prewarmFile));
+    QVERIFY(QFile::exists(fileName));
+
+    // Stopping prepares the same recorder for the next recording
+    m_recorderControl->setState(QMediaRecorder::StoppedState);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+    QTRY_VERIFY(m_recorderControl->m_prewarmed);
+    QCOMPARE(m_recorderControl->mediaRecorder(), recorder);
+    prewarmFile = QFile::decodeName(m_recorderControl->m_prewarmFile);
+    QVERIFY(QFile::exists(prewarmFile));
+
+    m_recorderControl->releasePrewarmed();
+    QVERIFY(m_recorderControl->mediaRecorder() == 0);
+    QVERIFY(!QFile::exists(prewarmFile));
+    m_recorderControl->m_prewarmEnabled = false;
+    m_service->cameraControl()->setCaptureMode(QCamera::CaptureStillImage);
+}
+
+void tst_AalMediaRecorderControl::releaseInPhotoMode()
+{
+    QTemporaryDir directory;
+    m_recorderControl->setOutputLocation(QUrl(directory.path() + "/photomode.mp4"));
+    m_recorderControl->m_prewarmEnabled = true;
+    m_service->cameraControl()->setCaptureMode(QCamera::CaptureVideo);
+
+    m_recorderControl->setState(QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+
+    // Leaving video mode while finalizing, the recorder is not kept around
+    m_recorderControl->setState(QMediaRecorder::StoppedState);
+    m_service->cameraControl()->setCaptureMode(QCamera::CaptureStillImage);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+    QVERIFY(m_recorderControl->mediaRecorder() == 0);
+    QVERIFY(!m_recorderControl->m_prewarmed);
+
+    m_recorderControl->m_prewarmEnabled = false;
+}
+
+void tst_AalMediaRecorderControl::startWhilePrewarming()
+{
+    QTemporaryDir directory;
+    QString fileName = directory.path() + "/pending.mp4";
+    m_recorderControl->setOutputLocation(QUrl(fileName));
+    m_recorderControl->m_prewarmEnabled = true;
+
+    // The start does not wait for the camera thread, it completes once the
+    // recorder is prepared
+    m_recorderControl->prewarm();
+    QVERIFY(m_recorderControl->m_prewarmPending);
+    m_recorderControl->setState(QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->state(), QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::LoadingStatus);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+    QVERIFY(QFile::exists(fileName));
+
+    // Photo mode, the recorder is released once finalized
+    m_recorderControl->setState(QMediaRecorder::StoppedState);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+    QVERIFY(m_recorderControl->mediaRecorder() == 0);
+    m_recorderControl->m_prewarmEnabled = false;
+}
+
+void tst_AalMediaRecorderControl::restartWhileFinalizing()
+{
+    QTemporaryDir directory;
+    m_recorderControl->setOutputLocation(QUrl(directory.path() + "/first.mp4"));
+    m_recorderControl->setState(QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+
+    m_recorderControl->setState(QMediaRecorder::StoppedState);
+    QCOMPARE(m_recorderControl->state(), QMediaRecorder::StoppedState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::FinalizingStatus);
+
+    // The next recording gets its own recorder
+    m_recorderControl->setOutputLocation(QUrl(directory.path() + "/second.mp4"));
+    m_recorderControl->setState(QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+
+    m_recorderControl->waitForFinalization();
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+    QVERIFY(m_recorderControl->mediaRecorder() != 0);
+
+    m_recorderControl->setState(QMediaRecorder::StoppedState);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+    QVERIFY(m_recorderControl->mediaRecorder() == 0);
+}
+
+void tst_AalMediaRecorderControl::loopRecording()
+{
+    QTemporaryDir directory;
+    m_recorderControl->setOutputLocation(QUrl(directory.path() + "/loop.mp4"));
+    m_recorderControl->m_loopEnabled = true;
+    m_recorderControl->m_maxSegments = 3;
+
+    m_recorderControl->setState(QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+    SegmentRing *segments = m_recorderControl->segments();
+    QVERIFY(segments != 0);
+    // The segment being recorded and the one prepared to follow it
+    QCOMPARE(segments->segments().size(), 2);
+    QString first = segments->segments().first();
+    QVERIFY(first.endsWith("/loop_0001.mp4"));
+
+    for (int i = 0; i < 4; ++i) {
+        MediaRecorderWrapper *recorder = m_recorderControl->mediaRecorder();
+        m_recorderControl->rollOver();
+        QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+        QVERIFY(m_recorderControl->mediaRecorder() != recorder);
+    }
+    QCOMPARE(segments->gapCount(), 4);
+    QVERIFY(segments->maximumGap() >= segments->averageGap());
+    // Only the newest segments are kept
+    QCOMPARE(segments->segments().size(), 3);
+    QVERIFY(!QFile::exists(first));
+
+    m_recorderControl->setState(QMediaRecorder::StoppedState);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+    // The segment prepared to follow is dropped
+    QCOMPARE(segments->segments().size(), 2);
+    QVERIFY(segments->segments().last().endsWith("/loop_0005.mp4"));
+    Q_FOREACH (const QString &segment, segments->segments())
+        QVERIFY(QFile::exists(segment));
+
+    m_recorderControl->m_loopEnabled = false;
+}
+
+void tst_AalMediaRecorderControl::streaming()
+{
+    setFakeRecorderEnabled(true);
+    QTemporaryDir directory;
+    QString fileName = directory.path() + "/stream.ts";
+    m_recorderControl->setOutputLocation(QUrl(fileName));
+
+    int consumer[2];
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, consumer) == 0);
+    QVERIFY(m_recorderControl->setStreamOutput(consumer[0]));
+    close(consumer[0]);
+
+    m_recorderControl->setState(QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+    QVERIFY(m_recorderControl->streamRelay() != 0);
+
+    // The consumer gets the stream while it is recorded
+    char buffer[4096];
+    QTRY_VERIFY(recv(consumer[1], buffer, sizeof(buffer), MSG_DONTWAIT) > 0);
+
+    m_recorderControl->setState(QMediaRecorder::StoppedState);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+    QVERIFY(m_recorderControl->streamRelay() == 0);
+    // Without tee, nothing is written to the output location
+    QVERIFY(!QFile::exists(fileName));
+
+    m_recorderControl->setStreamOutput(-1);
+    close(consumer[1]);
+}
+
+void tst_AalMediaRecorderControl::telemetry()
+{
+    setFakeRecorderEnabled(true);
+    QTemporaryDir directory;
+    m_recorderControl->setOutputLocation(QUrl(directory.path() + "/telemetry.mp4"));
+    QSignalSpy telemetryChanged(m_recorderControl, SIGNAL(telemetryChanged()));
+
+    QElapsedTimer clock;
+    clock.start();
+    m_recorderControl->setState(QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+
+    QTRY_VERIFY(telemetryChanged.count() >= 3);
+    QVERIFY(m_recorderControl->property("bytesWritten").toLongLong() > 0);
+    QVERIFY(m_recorderControl->property("bitRate").toInt() > 0);
+    QVERIFY(m_recorderControl->videoBitRate() <= m_recorderControl->bitRate());
+    QVERIFY(m_recorderControl->timeSinceLastWrite() < 1000);
+
+    // The duration follows the clock
+    qint64 duration = m_recorderControl->duration();
+    QVERIFY(duration <= clock.elapsed());
+    QVERIFY(duration >= clock.elapsed() - 500);
+
+    m_recorderControl->setState(QMediaRecorder::StoppedState);
+    duration = m_recorderControl->duration();
+    QVERIFY(duration >= 2000);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+    QCOMPARE(m_recorderControl->duration(), duration);
+}
+
+void tst_AalMediaRecorderControl::timeLapse()
+{
+    setFakeRecorderEnabled(true);
+    QTemporaryDir directory;
+    m_recorderControl->setOutputLocation(QUrl(directory.path() + "/timelapse.mp4"));
+    m_recorderControl->setProperty("timeLapseInterval", 100);
+    QCOMPARE(m_recorderControl->timeLapseInterval(), 100);
+
+    m_recorderControl->setState(QMediaRecorder::RecordingState);
+    QCOMPARE(m_recorderControl->status(), QMediaRecorder::RecordingStatus);
+    // A time-lapse has no sound
+    QCOMPARE(m_recorderControl->audioBitRate(), 0);
+
+    // The interval is kept for the whole recording
+    m_recorderControl->setTimeLapseInterval(0);
+    QCOMPARE(m_recorderControl->timeLapseInterval(), 100);
+
+    QTest::qWait(1000);
+    m_recorderControl->setState(QMediaRecorder::StoppedState);
+    QTRY_COMPARE(m_recorderControl->status(), QMediaRecorder::UnloadedStatus);
+
+    // Only the captured frames are encoded: about 10 instead of 30
+    FakeRecorderStats stats = fakeRecorderStats();
+    QVERIFY(stats.framesWritten >= 5);
+    QVERIFY(stats.framesWritten <= 15);
+    QCOMPARE(stats.audioBuffers, 0);
+
+    m_recorderControl->setTimeLapseInterval(0);
+    QCOMPARE(m_recorderControl->timeLapseInterval(), 0);
 }
 
 QTEST_GUILESS_MAIN(tst_AalMediaRecorderControl)
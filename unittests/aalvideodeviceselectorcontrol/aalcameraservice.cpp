@@ -16,11 +16,11 @@
 
 #include "aalcameraservice.h"
 #include "aalcameracontrol.h"
-
-AalCameraService *AalCameraService::m_service = 0;
+#include "aalvideoencodersettingscontrol.h"
 
 AalCameraService::AalCameraService(QObject *parent) :
     QMediaService(parent),
+    m_videoEncoderControl(0),
     m_androidControl(0),
     m_androidListener(0)
 {
@@ -30,6 +30,7 @@ AalCameraService::AalCameraService(QObject *parent) :
 AalCameraService::~AalCameraService()
 {
     delete m_cameraControl;
+    delete m_videoEncoderControl;
 }
 
 QMediaControl *AalCameraService::requestControl(const char *name)
@@ -43,6 +44,13 @@ void AalCameraService::releaseControl(QMediaControl *control)
     Q_UNUSED(control);
 }
 
+AalVideoEncoderSettingsControl *AalCameraService::videoEncoderControl()
+{
+    if (!m_videoEncoderControl)
+        m_videoEncoderControl = new AalVideoEncoderSettingsControl(this);
+    return m_videoEncoderControl;
+}
+
 CameraControl *AalCameraService::androidControl()
 {
     return m_androidControl;
@@ -96,3 +104,10 @@ QSize AalCameraService::selectSizeWithAspectRatio(const QList<QSize> &sizes, flo
     Q_UNUSED(targetAspectRatio);
     return QSize();
 }
+
+bool AalCameraService::aspectRatioMatches(const QSize &size, float targetAspectRatio) const
+{
+    Q_UNUSED(size);
+    Q_UNUSED(targetAspectRatio);
+    return false;
+}
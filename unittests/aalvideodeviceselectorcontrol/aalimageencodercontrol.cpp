@@ -71,28 +71,3 @@ void AalImageEncoderControl::resetAllSettings()
 {
 }
 
-void AalImageEncoderControl::getPictureSizeCb(void *ctx, int width, int height)
-{
-    Q_UNUSED(ctx);
-    Q_UNUSED(width);
-    Q_UNUSED(height);
-}
-
-void AalImageEncoderControl::getPictureSize(int width, int height)
-{
-    Q_UNUSED(width);
-    Q_UNUSED(height);
-}
-
-void AalImageEncoderControl::getThumbnailSizeCb(void *ctx, int width, int height)
-{
-    Q_UNUSED(ctx);
-    Q_UNUSED(width);
-    Q_UNUSED(height);
-}
-
-void AalImageEncoderControl::getThumbnailSize(int width, int height)
-{
-    Q_UNUSED(width);
-    Q_UNUSED(height);
-}
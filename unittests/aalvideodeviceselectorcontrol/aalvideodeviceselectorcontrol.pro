@@ -13,6 +13,7 @@ HEADERS += ../../src/aalvideodeviceselectorcontrol.h \
     ../../src/aalcameracontrol.h \
     ../../src/aalcameraservice.h \
     ../../src/aalvideoencodersettingscontrol.h \
+    ../../src/cameradeviceregistry.h \
     ../stubs/qcamerainfodata.h
 
 SOURCES += tst_aalvideodeviceselectorcontrol.cpp \
@@ -22,7 +23,7 @@ SOURCES += tst_aalvideodeviceselectorcontrol.cpp \
     aalviewfindersettingscontrol.cpp \
     ../stubs/aalcameracontrol_stub.cpp \
     ../stubs/aalvideoencodersettingscontrol_stub.cpp \
-    ../stubs/qcamerainfo_stub.cpp \
+    ../stubs/cameradeviceregistry_stub.cpp \
     ../stubs/qcamerainfodata.cpp
 
 check.depends = $${TARGET}
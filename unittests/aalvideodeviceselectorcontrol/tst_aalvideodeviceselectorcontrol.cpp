@@ -17,9 +17,8 @@
 #include <QtTest/QtTest>
 #include <QSignalSpy>
 
-#include "aalcameraservice.h"
-
 #define private public
+#include "aalcameraservice.h"
 #include "aalvideodeviceselectorcontrol.h"
 #include "qcamerainfodata.h"
 
@@ -63,6 +62,8 @@ void tst_AalVideoDeviceSelectorControl::selectDevice()
     QCOMPARE(m_selectControl->selectedDevice(), 1);
     QCOMPARE(spy.count(), 1);
     QCOMPARE(spy2.count(), 1);
+    // Not created just to be reset
+    QVERIFY(m_service->m_videoEncoderControl == 0);
 }
 
 QTEST_GUILESS_MAIN(tst_AalVideoDeviceSelectorControl)
@@ -17,8 +17,6 @@
 #include "aalcameraservice.h"
 #include <cmath>
 
-AalCameraService *AalCameraService::m_service = 0;
-
 AalCameraService::AalCameraService(QObject *parent) :
     QMediaService(parent),
     m_androidControl(0),
@@ -46,6 +44,15 @@ CameraControl *AalCameraService::androidControl()
     return m_androidControl;
 }
 
+void AalCameraService::setCameraParameter(CameraParameter parameter, const ParameterSetter &setter,
+                                          bool needsPreviewRestart)
+{
+    Q_UNUSED(parameter);
+    Q_UNUSED(needsPreviewRestart);
+    if (m_androidControl)
+        setter(m_androidControl);
+}
+
 bool AalCameraService::connectCamera()
 {
     return true;
@@ -92,16 +99,14 @@ QSize AalCameraService::selectSizeWithAspectRatio(const QList<QSize> &sizes, flo
 {
     QSize selectedSize;
     long selectedPixelCount = 0;
-    const float EPSILON = 0.02;
 
     if (!sizes.empty()) {
         // Loop over all sizes until we find the highest one that matches targetAspectRatio.
         QList<QSize>::const_iterator it = sizes.begin();
         while (it != sizes.end()) {
             QSize size = *it;
-            const float aspectRatio = (float)size.width() / (float)size.height();
             const long pixelCount = (long)size.width() * (long)size.height();
-            if (fabs(aspectRatio - targetAspectRatio) < EPSILON && pixelCount > selectedPixelCount) {
+            if (aspectRatioMatches(size, targetAspectRatio) && pixelCount > selectedPixelCount) {
                 selectedSize = size;
                 selectedPixelCount = pixelCount;
             }
@@ -112,3 +117,13 @@ QSize AalCameraService::selectSizeWithAspectRatio(const QList<QSize> &sizes, flo
     return selectedSize;
 }
 
+bool AalCameraService::aspectRatioMatches(const QSize &size, float targetAspectRatio) const
+{
+    const float EPSILON = 0.02;
+    if (size.height() <= 0)
+        return false;
+
+    const float aspectRatio = (float)size.width() / (float)size.height();
+    return fabs(aspectRatio - targetAspectRatio) < EPSILON;
+}
+
@@ -10,12 +10,14 @@ INCLUDEPATH += ../mocks/aal
 
 HEADERS += ../../src/aalviewfindersettingscontrol.h \
     ../../src/aalcameraservice.h \
-    ../../src/aalvideorenderercontrol.h
+    ../../src/aalvideorenderercontrol.h \
+    ../../src/cameraproperties.h
 
 SOURCES += tst_aalviewfindersettingscontrol.cpp \
     ../../src/aalviewfindersettingscontrol.cpp \
     aalcameraservice.cpp \
-    aalvideorenderercontrol.cpp
+    aalvideorenderercontrol.cpp \
+    ../stubs/cameraproperties_stub.cpp
 
 check.depends = $${TARGET}
 check.commands = ./$${TARGET}
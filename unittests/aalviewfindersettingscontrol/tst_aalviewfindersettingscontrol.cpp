@@ -30,12 +30,18 @@ private slots:
 
     void setSize();
     void resetAllSettings();
+    void frameRateRange();
+    void recordingFrameRate();
 
     void chooseOptimalSize16by9();
     void chooseOptimalSize4by3();
     void chooseOptimalSizeEmpty();
     void chooseOptimalSize0AspectRatio();
     void chooseOptimalSize0AspectRatioEmpty();
+    void chooseOptimalSizeOutputLimited();
+    void chooseOptimalSizeZoomHeadroom();
+    void chooseOptimalSizeOutputTooBig();
+    void chooseOptimalSizeLargestPolicy();
 
 private:
     AalViewfinderSettingsControl *m_vfControl;
@@ -75,6 +81,61 @@ void tst_AalViewfinderSettingsControl::resetAllSettings()
     QCOMPARE(m_vfControl->currentSize(), QSize());
 }
 
+void tst_AalViewfinderSettingsControl::frameRateRange()
+{
+    m_vfControl->m_minFPS = 10;
+    m_vfControl->m_maxFPS = 30;
+    m_vfControl->m_currentFPS = 30;
+
+    m_vfControl->setViewfinderParameter(QCameraViewfinderSettingsControl::MaximumFrameRate, 24);
+    QCOMPARE(m_vfControl->maximumFrameRate(), 24);
+    QCOMPARE(m_vfControl->previewFrameRate(), 24);
+
+    m_vfControl->setViewfinderParameter(QCameraViewfinderSettingsControl::MinimumFrameRate, 15);
+    QCOMPARE(m_vfControl->minimumFrameRate(), 15);
+
+    m_vfControl->setPreviewFrameRate(5);
+    QCOMPARE(m_vfControl->previewFrameRate(), 15);
+    m_vfControl->setPreviewFrameRate(60);
+    QCOMPARE(m_vfControl->previewFrameRate(), 24);
+
+    // requests outside the supported range are limited to it
+    m_vfControl->setViewfinderParameter(QCameraViewfinderSettingsControl::MaximumFrameRate, 60);
+    QCOMPARE(m_vfControl->maximumFrameRate(), 30);
+
+    m_vfControl->setViewfinderParameter(QCameraViewfinderSettingsControl::MinimumFrameRate, 0);
+    m_vfControl->setViewfinderParameter(QCameraViewfinderSettingsControl::MaximumFrameRate, 0);
+    QCOMPARE(m_vfControl->minimumFrameRate(), 10);
+    QCOMPARE(m_vfControl->maximumFrameRate(), 30);
+}
+
+void tst_AalViewfinderSettingsControl::recordingFrameRate()
+{
+    m_vfControl->m_minFPS = 10;
+    m_vfControl->m_maxFPS = 60;
+    m_vfControl->m_currentFPS = 60;
+    m_vfControl->setViewfinderParameter(QCameraViewfinderSettingsControl::MaximumFrameRate, 30);
+
+    // A recording pins the viewfinder to its frame rate, even above the
+    // requested maximum
+    m_vfControl->setRecordingFrameRate(48);
+    QCOMPARE(m_vfControl->minimumFrameRate(), 48);
+    QCOMPARE(m_vfControl->maximumFrameRate(), 48);
+    QCOMPARE(m_vfControl->previewFrameRate(), 48);
+    m_vfControl->setPreviewFrameRate(15);
+    QCOMPARE(m_vfControl->previewFrameRate(), 48);
+
+    // within what the camera supports
+    m_vfControl->setRecordingFrameRate(120);
+    QCOMPARE(m_vfControl->previewFrameRate(), 60);
+
+    m_vfControl->setRecordingFrameRate(0);
+    QCOMPARE(m_vfControl->maximumFrameRate(), 30);
+    QCOMPARE(m_vfControl->previewFrameRate(), 30);
+
+    m_vfControl->setViewfinderParameter(QCameraViewfinderSettingsControl::MaximumFrameRate, 0);
+}
+
 void tst_AalViewfinderSettingsControl::chooseOptimalSize16by9()
 {
     m_vfControl->m_aspectRatio = (float)16 / (float)9;
@@ -113,7 +174,7 @@ void tst_AalViewfinderSettingsControl::chooseOptimalSize0AspectRatio()
     resolutions.append(QSize(1280, 720));
     resolutions.append(QSize(960, 720));
 
-    QCOMPARE(m_vfControl->chooseOptimalSize(resolutions), QSize(1280, 720));
+    QCOMPARE(m_vfControl->chooseOptimalSize(resolutions), QSize(1920, 1080));
 }
 
 void tst_AalViewfinderSettingsControl::chooseOptimalSize0AspectRatioEmpty()
@@ -124,6 +185,67 @@ void tst_AalViewfinderSettingsControl::chooseOptimalSize0AspectRatioEmpty()
     QCOMPARE(m_vfControl->chooseOptimalSize(resolutions), QSize());
 }
 
+void tst_AalViewfinderSettingsControl::chooseOptimalSizeOutputLimited()
+{
+    m_vfControl->m_aspectRatio = (float)16 / (float)9;
+    m_vfControl->m_sizePolicy = AalViewfinderSettingsControl::OutputSizePolicy;
+    m_vfControl->m_zoomHeadroom = 1.0;
+    m_vfControl->m_outputSize = QSize(720, 1280);
+    QList<QSize> resolutions;
+    resolutions.append(QSize(3840, 2160));
+    resolutions.append(QSize(1920, 1080));
+    resolutions.append(QSize(1280, 720));
+    resolutions.append(QSize(960, 720));
+    resolutions.append(QSize(640, 360));
+
+    QCOMPARE(m_vfControl->sizeLimit(), QSize(1280, 720));
+    QCOMPARE(m_vfControl->chooseOptimalSize(resolutions), QSize(1280, 720));
+}
+
+void tst_AalViewfinderSettingsControl::chooseOptimalSizeZoomHeadroom()
+{
+    m_vfControl->m_aspectRatio = (float)16 / (float)9;
+    m_vfControl->m_sizePolicy = AalViewfinderSettingsControl::OutputSizePolicy;
+    m_vfControl->m_zoomHeadroom = 1.5;
+    m_vfControl->m_outputSize = QSize(1280, 720);
+    QList<QSize> resolutions;
+    resolutions.append(QSize(3840, 2160));
+    resolutions.append(QSize(1920, 1080));
+    resolutions.append(QSize(1280, 720));
+
+    QCOMPARE(m_vfControl->chooseOptimalSize(resolutions), QSize(1920, 1080));
+}
+
+void tst_AalViewfinderSettingsControl::chooseOptimalSizeOutputTooBig()
+{
+    m_vfControl->m_aspectRatio = (float)4 / (float)3;
+    m_vfControl->m_sizePolicy = AalViewfinderSettingsControl::OutputSizePolicy;
+    m_vfControl->m_zoomHeadroom = 1.0;
+    m_vfControl->m_outputSize = QSize(2560, 1440);
+    QList<QSize> resolutions;
+    resolutions.append(QSize(1920, 1080));
+    resolutions.append(QSize(1440, 1080));
+    resolutions.append(QSize(960, 720));
+
+    QCOMPARE(m_vfControl->chooseOptimalSize(resolutions), QSize(1440, 1080));
+}
+
+void tst_AalViewfinderSettingsControl::chooseOptimalSizeLargestPolicy()
+{
+    m_vfControl->m_aspectRatio = (float)16 / (float)9;
+    m_vfControl->m_sizePolicy = AalViewfinderSettingsControl::LargestSizePolicy;
+    m_vfControl->m_outputSize = QSize(1280, 720);
+    QList<QSize> resolutions;
+    resolutions.append(QSize(1920, 1080));
+    resolutions.append(QSize(1280, 720));
+
+    QCOMPARE(m_vfControl->sizeLimit(), QSize());
+    QCOMPARE(m_vfControl->chooseOptimalSize(resolutions), QSize(1920, 1080));
+
+    m_vfControl->m_sizePolicy = AalViewfinderSettingsControl::OutputSizePolicy;
+    m_vfControl->m_outputSize = QSize();
+}
+
 QTEST_GUILESS_MAIN(tst_AalViewfinderSettingsControl)
 
 #include "tst_aalviewfindersettingscontrol.moc"
@@ -0,0 +1,22 @@
+include(../../coverage.pri)
+
+TARGET = tst_cameracapabilitycache
+
+QT += testlib
+
+LIBS += -L../mocks/aal -laal
+INCLUDEPATH += ../../src
+INCLUDEPATH += ../mocks/aal
+INCLUDEPATH += ../stubs/
+
+HEADERS += ../../src/cameracapabilitycache.h \
+    ../../src/cameraproperties.h \
+    ../stubs/camerapropertiesdata.h
+
+SOURCES += tst_cameracapabilitycache.cpp \
+    ../../src/cameracapabilitycache.cpp \
+    ../stubs/cameraproperties_stub.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QStandardPaths>
+
+#include <hybris/camera/camera_compatibility_layer.h>
+
+#include "camerapropertiesdata.h"
+
+#define private public
+#include "cameracapabilitycache.h"
+
+class tst_CameraCapabilityCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void queryDevice();
+    void memoryCache();
+    void diskCache();
+    void otherDevice();
+    void otherBuild();
+
+private:
+    CameraControl *m_androidControl;
+    CameraControlListener *m_androidListener;
+};
+
+void tst_CameraCapabilityCache::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    m_androidListener = new CameraControlListener;
+    m_androidControl = android_camera_connect_to(BACK_FACING_CAMERA_TYPE, m_androidListener);
+}
+
+void tst_CameraCapabilityCache::cleanupTestCase()
+{
+    CameraCapabilityCache cache;
+    cache.clear();
+
+    android_camera_delete(m_androidControl);
+    delete m_androidListener;
+}
+
+void tst_CameraCapabilityCache::init()
+{
+    CameraPropertiesData::values.clear();
+    CameraCapabilityCache cache;
+    cache.clear();
+}
+
+void tst_CameraCapabilityCache::queryDevice()
+{
+    CameraCapabilityCache cache;
+    CameraCapabilities capabilities = cache.capabilities(0, m_androidControl);
+
+    QCOMPARE(capabilities.previewSizes.count(), 3);
+    QCOMPARE(capabilities.pictureSizes.first(), QSize(3264, 2448));
+    QCOMPARE(capabilities.thumbnailSizes.count(), 1);
+    QCOMPARE(capabilities.videoSizes.count(), 2);
+    QCOMPARE(capabilities.flashModes.count(), 4);
+    QCOMPARE(capabilities.sceneModes.count(), 1);
+    QCOMPARE(capabilities.minFPS, 10);
+    QCOMPARE(capabilities.maxFPS, 30);
+    QCOMPARE(capabilities.maxZoom, 4);
+}
+
+void tst_CameraCapabilityCache::memoryCache()
+{
+    CameraCapabilityCache cache;
+    CameraCapabilities queried = cache.capabilities(0, m_androidControl);
+
+    // no camera to query, the capabilities have to come from the cache
+    CameraCapabilityCache otherCache;
+    CameraCapabilities cached = otherCache.capabilities(0, 0);
+    QCOMPARE(cached.previewSizes, queried.previewSizes);
+    QCOMPARE(cached.flashModes, queried.flashModes);
+}
+
+void tst_CameraCapabilityCache::diskCache()
+{
+    CameraCapabilityCache cache;
+    CameraCapabilities queried = cache.capabilities(0, m_androidControl);
+
+    // simulate a restart of the application
+    CameraCapabilityCache::m_cache.clear();
+
+    CameraCapabilityCache otherCache;
+    CameraCapabilities cached = otherCache.capabilities(0, 0);
+    QCOMPARE(cached.previewSizes, queried.previewSizes);
+    QCOMPARE(cached.pictureSizes, queried.pictureSizes);
+    QCOMPARE(cached.thumbnailSizes, queried.thumbnailSizes);
+    QCOMPARE(cached.videoSizes, queried.videoSizes);
+    QCOMPARE(cached.flashModes, queried.flashModes);
+    QCOMPARE(cached.sceneModes, queried.sceneModes);
+    QCOMPARE(cached.minFPS, queried.minFPS);
+    QCOMPARE(cached.maxFPS, queried.maxFPS);
+    QCOMPARE(cached.maxZoom, queried.maxZoom);
+}
+
+void tst_CameraCapabilityCache::otherDevice()
+{
+    CameraCapabilityCache cache;
+    cache.capabilities(0, m_androidControl);
+
+    QVERIFY(!cache.m_cache.contains(cache.key(1)));
+    cache.capabilities(1, m_androidControl);
+    QVERIFY(cache.m_cache.contains(cache.key(1)));
+}
+
+void tst_CameraCapabilityCache::otherBuild()
+{
+    CameraPropertiesData::values.insert("ro.build.fingerprint", "vendor/device:9/build1:user");
+    CameraCapabilityCache cache;
+    cache.capabilities(0, m_androidControl);
+
+    // simulate a system update and a restart of the application
+    CameraCapabilityCache::m_cache.clear();
+    CameraPropertiesData::values.insert("ro.build.fingerprint", "vendor/device:9/build2:user");
+
+    CameraCapabilityCache otherCache;
+    CameraCapabilities cached;
+    QVERIFY(!otherCache.load(0, &cached));
+    QVERIFY(!otherCache.m_cache.contains(otherCache.key(0)));
+
+    // the capabilities are queried again and replace the ones of the old build
+    CameraCapabilities queried = otherCache.capabilities(0, m_androidControl);
+    QVERIFY(!queried.isEmpty());
+    QSettings settings(otherCache.m_fileName, QSettings::IniFormat);
+    QCOMPARE(settings.value("fingerprint").toString(), QString("vendor/device:9/build2:user"));
+
+    CameraCapabilityCache::m_cache.clear();
+    CameraPropertiesData::values.insert("ro.build.fingerprint", "vendor/device:9/build1:user");
+    CameraCapabilityCache oldCache;
+    QVERIFY(!oldCache.load(0, &cached));
+}
+
+QTEST_GUILESS_MAIN(tst_CameraCapabilityCache)
+
+#include "tst_cameracapabilitycache.moc"
@@ -0,0 +1,20 @@
+include(../../coverage.pri)
+
+TARGET = tst_cameradeviceregistry
+
+QT += testlib multimedia
+
+LIBS += -L../mocks/aal -laal
+INCLUDEPATH += ../../src
+INCLUDEPATH += ../mocks/aal
+
+HEADERS += ../../src/cameradeviceregistry.h \
+    ../../src/cameraproperties.h
+
+SOURCES += tst_cameradeviceregistry.cpp \
+    ../../src/cameradeviceregistry.cpp \
+    ../stubs/cameraproperties_stub.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
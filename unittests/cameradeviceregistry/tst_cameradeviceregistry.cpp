@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+
+#include "cameradeviceregistry.h"
+
+class tst_CameraDeviceRegistry : public QObject
+{
+    Q_OBJECT
+private slots:
+    void devices();
+    void invalidDevice();
+};
+
+void tst_CameraDeviceRegistry::devices()
+{
+    QCOMPARE(CameraDeviceRegistry::count(), 2);
+
+    QCOMPARE(CameraDeviceRegistry::deviceName(0), QByteArray("0"));
+    QCOMPARE(CameraDeviceRegistry::indexOf("0"), 0);
+    QCOMPARE(CameraDeviceRegistry::position(0), QCamera::BackFace);
+    QCOMPARE(CameraDeviceRegistry::orientation(0), 270);
+    QCOMPARE(CameraDeviceRegistry::description(0), QString("Camera 0 Back facing"));
+
+    QCOMPARE(CameraDeviceRegistry::deviceName(1), QByteArray("1"));
+    QCOMPARE(CameraDeviceRegistry::indexOf("1"), 1);
+    QCOMPARE(CameraDeviceRegistry::position(1), QCamera::FrontFace);
+    QCOMPARE(CameraDeviceRegistry::description(1), QString("Camera 1 Front facing"));
+}
+
+void tst_CameraDeviceRegistry::invalidDevice()
+{
+    QCOMPARE(CameraDeviceRegistry::indexOf("2"), -1);
+    QCOMPARE(CameraDeviceRegistry::indexOf("back"), -1);
+    QCOMPARE(CameraDeviceRegistry::deviceName(-1), QByteArray());
+    QCOMPARE(CameraDeviceRegistry::position(2), QCamera::UnspecifiedPosition);
+    QCOMPARE(CameraDeviceRegistry::orientation(2), 0);
+    QCOMPARE(CameraDeviceRegistry::description(2), QString());
+}
+
+QTEST_GUILESS_MAIN(tst_CameraDeviceRegistry)
+
+#include "tst_cameradeviceregistry.moc"
@@ -0,0 +1,24 @@
+include(../../coverage.pri)
+
+TARGET = tst_cameraworker
+
+QT += testlib
+
+LIBS += -L../mocks/aal -laal
+INCLUDEPATH += ../../src
+INCLUDEPATH += ../mocks/aal
+
+HEADERS += ../../src/cameraworker.h \
+    ../../src/cameraproperties.h \
+    ../../src/halstatistics.h \
+    ../../src/startuptimeline.h
+
+SOURCES += tst_cameraworker.cpp \
+    ../../src/cameraworker.cpp \
+    ../../src/halstatistics.cpp \
+    ../../src/startuptimeline.cpp \
+    ../stubs/cameraproperties_stub.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include <QThread>
+
+#include "cameraworker.h"
+
+class tst_CameraWorker : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void connectCamera();
+    void discardConnection();
+    void staleConnectFinished();
+    void probeCapabilities();
+
+private:
+    QThread m_thread;
+    CameraWorker *m_worker;
+};
+
+void tst_CameraWorker::initTestCase()
+{
+    // Long enough for the GUI thread to run ahead of the camera thread
+    qputenv("AAL_MOCK_CONNECT_LATENCY", "50");
+}
+
+void tst_CameraWorker::init()
+{
+    m_worker = new CameraWorker;
+    m_worker->moveToThread(&m_thread);
+    m_thread.start();
+}
+
+void tst_CameraWorker::cleanup()
+{
+    m_worker->waitForIdle();
+    m_thread.quit();
+    m_thread.wait();
+    delete m_worker;
+}
+
+void tst_CameraWorker::connectCamera()
+{
+    QSignalSpy spy(m_worker, SIGNAL(connectFinished(int)));
+    CameraControl *control = 0;
+    CameraControlListener *listener = 0;
+
+    int connectId = m_worker->connectCamera(-1, BACK_FACING_CAMERA_TYPE);
+    QVERIFY(connectId != 0);
+    QVERIFY(!m_worker->takeConnection(connectId, &control, &listener));
+
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.takeFirst().at(0).toInt(), connectId);
+    QVERIFY(m_worker->takeConnection(connectId, &control, &listener));
+    QVERIFY(control != 0);
+    QVERIFY(listener != 0);
+
+    // A connection is only handed over once
+    QVERIFY(!m_worker->takeConnection(connectId, &control, &listener));
+
+    m_worker->disconnectCamera(control, listener);
+}
+
+void tst_CameraWorker::discardConnection()
+{
+    QSignalSpy spy(m_worker, SIGNAL(connectFinished(int)));
+    CameraControl *control = 0;
+    CameraControlListener *listener = 0;
+
+    int connectId = m_worker->connectCamera(-1, BACK_FACING_CAMERA_TYPE);
+    m_worker->discardConnection(connectId);
+    m_worker->waitForIdle();
+
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(!m_worker->takeConnection(connectId, &control, &listener));
+}
+
+/*!
+ * \brief tst_CameraWorker::staleConnectFinished reconnects while the first
+ * connection is still running: its connectFinished() must not hand over the
+ * second connection, and the second one must not get lost
+ */
+void tst_CameraWorker::staleConnectFinished()
+{
+    QSignalSpy spy(m_worker, SIGNAL(connectFinished(int)));
+    CameraControl *control = 0;
+    CameraControlListener *listener = 0;
+
+    int firstId = m_worker->connectCamera(-1, BACK_FACING_CAMERA_TYPE);
+    m_worker->discardConnection(firstId);
+    int secondId = m_worker->connectCamera(-1, FRONT_FACING_CAMERA_TYPE);
+    QVERIFY(secondId != firstId);
+
+    // The first connection finished, the second one is still connecting
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.at(0).at(0).toInt(), firstId);
+    QVERIFY(!m_worker->takeConnection(firstId, &control, &listener));
+
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).toInt(), secondId);
+    QVERIFY(!m_worker->takeConnection(firstId, &control, &listener));
+    QVERIFY(m_worker->takeConnection(secondId, &control, &listener));
+    QVERIFY(control != 0);
+
+    m_worker->disconnectCamera(control, listener);
+}
+
+/*!
+ * \brief tst_CameraWorker::probeCapabilities checks that the capabilities are
+ * probed on the camera thread and handed over with the connection
+ */
+void tst_CameraWorker::probeCapabilities()
+{
+    QSignalSpy spy(m_worker, SIGNAL(connectFinished(int)));
+    CameraControl *control = 0;
+    CameraControlListener *listener = 0;
+    CameraCapabilities capabilities;
+    QThread *probeThread = 0;
+
+    int connectId = m_worker->connectCamera(-1, BACK_FACING_CAMERA_TYPE,
+                                            [&probeThread](CameraControl *control) {
+        Q_UNUSED(control);
+        probeThread = QThread::currentThread();
+        CameraCapabilities result;
+        result.maxZoom = 4;
+        return result;
+    });
+
+    QVERIFY(spy.wait());
+    QVERIFY(m_worker->takeConnection(connectId, &control, &listener, &capabilities));
+    QCOMPARE(probeThread, &m_thread);
+    QCOMPARE(capabilities.maxZoom, 4);
+
+    m_worker->disconnectCamera(control, listener);
+}
+
+QTEST_GUILESS_MAIN(tst_CameraWorker)
+
+#include "tst_cameraworker.moc"
@@ -0,0 +1,86 @@
+include(../../coverage.pri)
+
+TARGET = tst_framerategovernor
+
+QT += testlib concurrent multimedia opengl gui sensors
+
+CONFIG += link_pkgconfig
+PKGCONFIG += exiv2 libqtubuntu-media-signals
+
+LIBS += -L../mocks/aal -laal
+INCLUDEPATH += ../../src
+INCLUDEPATH += ../mocks/aal
+
+HEADERS += \
+    ../../src/aalaudioencodersettingscontrol.h \
+    ../../src/aalcameracontrol.h \
+    ../../src/aalcameraflashcontrol.h \
+    ../../src/aalcamerafocuscontrol.h \
+    ../../src/aalcameraservice.h \
+    ../../src/aalcameraserviceplugin.h \
+    ../../src/aalcamerazoomcontrol.h \
+    ../../src/aalimagecapturecontrol.h \
+    ../../src/aalimageencodercontrol.h \
+    ../../src/aalmediarecordercontrol.h \
+    ../../src/aalmetadatawritercontrol.h \
+    ../../src/aalvideodeviceselectorcontrol.h \
+    ../../src/aalvideoencodersettingscontrol.h \
+    ../../src/aalvideorenderercontrol.h \
+    ../../src/aalviewfindersettingscontrol.h \
+    ../../src/aalcamerainfocontrol.h \
+    ../../src/audiocapture.h \
+    ../../src/aalcameraexposurecontrol.h \
+    ../../src/cameracapabilitycache.h \
+    ../../src/cameradeviceregistry.h \
+    ../../src/cameraproperties.h \
+    ../../src/cameraworker.h \
+    ../../src/storagemanager.h \
+    ../../src/rotationhandler.h \
+    ../../src/startuptimeline.h \
+    ../../src/framerategovernor.h \
+    ../../src/haleventqueue.h \
+    ../../src/halstatistics.h \
+    ../../src/tracebuffer.h \
+    ../../src/recordingwriter.h \
+    ../../src/segmentring.h \
+    ../../src/streamrelay.h \
+    ../../src/recordingtelemetry.h
+
+SOURCES += tst_framerategovernor.cpp \
+    ../../src/aalaudioencodersettingscontrol.cpp \
+    ../../src/aalcameracontrol.cpp \
+    ../../src/aalcameraflashcontrol.cpp \
+    ../../src/aalcamerafocuscontrol.cpp \
+    ../../src/aalcameraservice.cpp \
+    ../../src/aalcameraserviceplugin.cpp \
+    ../../src/aalcamerazoomcontrol.cpp \
+    ../../src/aalimagecapturecontrol.cpp \
+    ../../src/aalimageencodercontrol.cpp \
+    ../../src/aalmediarecordercontrol.cpp \
+    ../../src/aalmetadatawritercontrol.cpp \
+    ../../src/aalvideodeviceselectorcontrol.cpp \
+    ../../src/aalvideoencodersettingscontrol.cpp \
+    ../../src/aalvideorenderercontrol.cpp \
+    ../../src/aalviewfindersettingscontrol.cpp \
+    ../../src/aalcamerainfocontrol.cpp \
+    ../../src/aalcameraexposurecontrol.cpp \
+    ../../src/cameracapabilitycache.cpp \
+    ../../src/cameradeviceregistry.cpp \
+    ../../src/cameraworker.cpp \
+    ../../src/storagemanager.cpp \
+    ../../src/rotationhandler.cpp \
+    ../../src/startuptimeline.cpp \
+    ../../src/framerategovernor.cpp \
+    ../../src/haleventqueue.cpp \
+    ../../src/halstatistics.cpp \
+    ../../src/tracebuffer.cpp \
+    ../../src/recordingwriter.cpp \
+    ../../src/segmentring.cpp \
+    ../../src/streamrelay.cpp \
+    ../../src/recordingtelemetry.cpp \
+    ../stubs/audiocapture_stub.cpp \
+    ../stubs/cameraproperties_stub.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QAbstractVideoSurface>
+#include <QCameraControl>
+#include <QStandardPaths>
+#include <QVideoRendererControl>
+#include <QtMath>
+
+#include <limits>
+
+#include <qtubuntu_media_signals.h>
+
+#define private public
+#include "aalcameraservice.h"
+#include "aalviewfindersettingscontrol.h"
+#include "cameraworker.h"
+#include "framerategovernor.h"
+
+/*!
+ * \brief The FakeSurface class stands in for the QML video output: it creates
+ * a texture for the first frame, as qtvideo-node does
+ */
+class FakeSurface : public QAbstractVideoSurface
+{
+public:
+    QList<QVideoFrame::PixelFormat> supportedPixelFormats(QAbstractVideoBuffer::HandleType type) const
+    {
+        Q_UNUSED(type);
+        return QList<QVideoFrame::PixelFormat>() << QVideoFrame::Format_RGB32;
+    }
+
+    bool present(const QVideoFrame &frame)
+    {
+        if (frame.handle().toUInt() == 0) {
+            Q_EMIT SharedSignal::instance()->textureCreated(1);
+        }
+        return true;
+    }
+};
+
+class tst_FrameRateGovernor : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void lowerCeiling();
+    void keepCeilingWhenKeepingUp();
+    void backOffAfterLowering();
+
+private:
+    void presentFrames(qreal ratio);
+
+    AalCameraService *m_service;
+    FakeSurface *m_surface;
+    FrameRateGovernor *m_governor;
+};
+
+void tst_FrameRateGovernor::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void tst_FrameRateGovernor::init()
+{
+    m_service = new AalCameraService();
+    m_surface = new FakeSurface;
+
+    QVideoRendererControl *renderer =
+        qobject_cast<QVideoRendererControl*>(m_service->requestControl(QVideoRendererControl_iid));
+    QCameraControl *camera =
+        qobject_cast<QCameraControl*>(m_service->requestControl(QCameraControl_iid));
+    renderer->setSurface(m_surface);
+    camera->setState(QCamera::ActiveState);
+    QTRY_VERIFY(m_service->isPreviewStarted() && !m_service->m_deferredInitPending);
+
+    // The windows are driven by the test only
+    m_governor = m_service->frameRateGovernor();
+    m_governor->m_timer.stop();
+    m_governor->updateFrameRate();
+}
+
+void tst_FrameRateGovernor::cleanup()
+{
+    delete m_service;
+    delete m_surface;
+}
+
+/*!
+ * \brief tst_FrameRateGovernor::presentFrames evaluates a one second window in
+ * which the given part of the current frame rate was presented
+ */
+void tst_FrameRateGovernor::presentFrames(qreal ratio)
+{
+    int fps = m_service->viewfinderControl()->previewFrameRate();
+    m_governor->evaluate(quint64(qRound(fps * ratio)), 1000);
+}
+
+void tst_FrameRateGovernor::lowerCeiling()
+{
+    AalViewfinderSettingsControl *viewfinder = m_service->viewfinderControl();
+    int fps = viewfinder->previewFrameRate();
+    QVERIFY(fps > 0);
+
+    for (int i = 1; i < FrameRateGovernor::SLOW_WINDOWS; ++i) {
+        presentFrames(0.5);
+        QCOMPARE(m_governor->m_ceilingFPS, std::numeric_limits<int>::max());
+    }
+    presentFrames(0.5);
+
+    QCOMPARE(m_governor->m_ceilingFPS, qMax(viewfinder->minimumFrameRate(), qCeil(fps * 0.5)));
+    QVERIFY(viewfinder->previewFrameRate() <= m_governor->m_ceilingFPS);
+    QCOMPARE(m_governor->measuredFrameRate(), qreal(qRound(fps * 0.5)));
+}
+
+void tst_FrameRateGovernor::keepCeilingWhenKeepingUp()
+{
+    for (int i = 0; i < 2 * FrameRateGovernor::SLOW_WINDOWS; ++i) {
+        presentFrames(1.0);
+        presentFrames(0.5);
+    }
+
+    // Slow windows that are not consecutive don't lower the ceiling
+    QCOMPARE(m_governor->m_ceilingFPS, std::numeric_limits<int>::max());
+}
+
+void tst_FrameRateGovernor::backOffAfterLowering()
+{
+    AalViewfinderSettingsControl *viewfinder = m_service->viewfinderControl();
+
+    for (int i = 0; i < FrameRateGovernor::SLOW_WINDOWS; ++i)
+        presentFrames(0.5);
+    int ceiling = m_governor->m_ceilingFPS;
+    QVERIFY(ceiling < viewfinder->maximumFrameRate());
+
+    int probeWindows = m_governor->m_probeWindows;
+    QCOMPARE(probeWindows, 2 * FrameRateGovernor::PROBE_WINDOWS);
+
+    // The delivery keeps up, but the ceiling is held for a while
+    for (int i = 1; i < probeWindows; ++i) {
+        presentFrames(1.0);
+        QCOMPARE(m_governor->m_ceilingFPS, ceiling);
+    }
+    presentFrames(1.0);
+    QCOMPARE(m_governor->m_ceilingFPS, qMin(viewfinder->maximumFrameRate(), ceiling + FrameRateGovernor::FPS_STEP));
+
+    // Falling behind again doubles the time until the next probe
+    for (int i = 0; i < FrameRateGovernor::SLOW_WINDOWS; ++i)
+        presentFrames(0.5);
+    ceiling = m_governor->m_ceilingFPS;
+    QCOMPARE(m_governor->m_probeWindows, 2 * probeWindows);
+
+    for (int i = 1; i < 2 * probeWindows; ++i) {
+        presentFrames(1.0);
+        QCOMPARE(m_governor->m_ceilingFPS, ceiling);
+    }
+    presentFrames(1.0);
+    QVERIFY(m_governor->m_ceilingFPS > ceiling);
+}
+
+QTEST_MAIN(tst_FrameRateGovernor)
+
+#include "tst_framerategovernor.moc"
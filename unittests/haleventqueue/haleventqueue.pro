@@ -0,0 +1,16 @@
+include(../../coverage.pri)
+
+TARGET = tst_haleventqueue
+
+QT += testlib
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/haleventqueue.h
+
+SOURCES += tst_haleventqueue.cpp \
+    ../../src/haleventqueue.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include <QThread>
+
+#include "haleventqueue.h"
+
+class Poster : public QThread
+{
+public:
+    Poster(HalEventQueue *queue, int count) : m_queue(queue), m_count(count) {}
+
+protected:
+    void run()
+    {
+        for (int i = 0; i < m_count; ++i) {
+            m_queue->post(HalEventQueue::ShutterEvent);
+        }
+    }
+
+private:
+    HalEventQueue *m_queue;
+    int m_count;
+};
+
+class tst_HalEventQueue : public QObject
+{
+    Q_OBJECT
+private slots:
+    void order();
+    void coalescing();
+    void concurrentPosts();
+};
+
+void tst_HalEventQueue::order()
+{
+    HalEventQueue queue;
+    QStringList received;
+    connect(&queue, &HalEventQueue::shutter, [&]() { received << "shutter"; });
+    connect(&queue, &HalEventQueue::compressedImage, [&](const QByteArray &data) {
+        received << QString::fromLatin1(data);
+    });
+    connect(&queue, &HalEventQueue::error, [&]() { received << "error"; });
+
+    queue.post(HalEventQueue::ShutterEvent);
+    queue.post(HalEventQueue::CompressedImageEvent, "jpeg");
+    queue.post(HalEventQueue::ErrorEvent);
+    QCOMPARE(queue.depth(), 3);
+    QVERIFY(received.isEmpty());
+
+    QTRY_COMPARE(received, QStringList() << "shutter" << "jpeg" << "error");
+    QCOMPARE(queue.depth(), 0);
+    QCOMPARE(queue.maximumDepth(), 3);
+    QCOMPARE(queue.deliveredEvents(), quint64(3));
+    QVERIFY(queue.maximumLatency() >= queue.averageLatency());
+}
+
+void tst_HalEventQueue::coalescing()
+{
+    HalEventQueue queue;
+    QSignalSpy frameSpy(&queue, SIGNAL(previewFrame()));
+    QSignalSpy focusSpy(&queue, SIGNAL(focusDone()));
+    QSignalSpy shutterSpy(&queue, SIGNAL(shutter()));
+
+    for (int i = 0; i < 5; ++i) {
+        queue.post(HalEventQueue::PreviewFrameEvent);
+        queue.post(HalEventQueue::FocusEvent);
+        queue.post(HalEventQueue::ShutterEvent);
+    }
+
+    QTRY_COMPARE(shutterSpy.count(), 5);
+    QCOMPARE(frameSpy.count(), 1);
+    QCOMPARE(focusSpy.count(), 1);
+    QCOMPARE(queue.coalescedEvents(), quint64(8));
+
+    // Delivered events no longer hold back new ones
+    queue.post(HalEventQueue::PreviewFrameEvent);
+    QTRY_COMPARE(frameSpy.count(), 2);
+}
+
+void tst_HalEventQueue::concurrentPosts()
+{
+    const int threads = 4;
+    const int events = 1000;
+
+    HalEventQueue queue;
+    QSignalSpy spy(&queue, SIGNAL(shutter()));
+
+    QList<Poster*> posters;
+    for (int i = 0; i < threads; ++i) {
+        posters << new Poster(&queue, events);
+    }
+    Q_FOREACH (Poster *poster, posters) {
+        poster->start();
+    }
+    Q_FOREACH (Poster *poster, posters) {
+        poster->wait();
+    }
+    qDeleteAll(posters);
+
+    QTRY_COMPARE(spy.count(), threads * events);
+    QCOMPARE(queue.depth(), 0);
+}
+
+QTEST_GUILESS_MAIN(tst_HalEventQueue)
+
+#include "tst_haleventqueue.moc"
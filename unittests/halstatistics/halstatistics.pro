@@ -0,0 +1,19 @@
+include(../../coverage.pri)
+
+TARGET = tst_halstatistics
+
+QT += testlib
+
+INCLUDEPATH += ../../src
+
+DEFINES += AAL_HAL_INSTRUMENTATION
+
+HEADERS += ../../src/halstatistics.h
+
+SOURCES += tst_halstatistics.cpp \
+    ../../src/halstatistics.cpp \
+    ../stubs/cameraproperties_stub.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
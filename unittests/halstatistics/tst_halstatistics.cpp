@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QThread>
+
+#include "halstatistics.h"
+
+static int fakeHalCall(int value)
+{
+    return value * 2;
+}
+
+static void slowHalCall()
+{
+    QThread::msleep(20);
+}
+
+class tst_HalStatistics : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+
+    void countsCalls();
+    void keepsReturnValue();
+    void flagsSlowCalls();
+    void reset();
+};
+
+void tst_HalStatistics::init()
+{
+    HalStatistics::reset();
+}
+
+void tst_HalStatistics::countsCalls()
+{
+    for (int i = 0; i < 3; ++i)
+        AAL_HAL_CALL(fakeHalCall(i));
+
+    QString dump = HalStatistics::dump();
+    QVERIFY(dump.contains("fakeHalCall: 3 calls, 0 slow"));
+}
+
+void tst_HalStatistics::keepsReturnValue()
+{
+    int result = AAL_HAL_CALL(fakeHalCall(21));
+    QCOMPARE(result, 42);
+}
+
+void tst_HalStatistics::flagsSlowCalls()
+{
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Slow HAL call: slowHalCall took .*"));
+    AAL_HAL_CALL(slowHalCall());
+
+    QString dump = HalStatistics::dump();
+    QVERIFY(dump.contains("slowHalCall: 1 calls, 1 slow"));
+}
+
+void tst_HalStatistics::reset()
+{
+    AAL_HAL_CALL(fakeHalCall(1));
+    HalStatistics::reset();
+
+    QVERIFY(!HalStatistics::dump().contains("fakeHalCall"));
+}
+
+QTEST_GUILESS_MAIN(tst_HalStatistics)
+
+#include "tst_halstatistics.moc"
@@ -6,7 +6,8 @@ CONFIG += staticlib
 HEADERS =  camera_compatibility_layer.h \
            camera_compatibility_layer_capabilities.h \
            camera_control.h \
-           media_recorder_layer.h
+           media_recorder_layer.h \
+           fake_media_recorder.h
 
 SOURCES += camera_compatibility_layer.cpp \
            media_recorder_layer.cpp
@@ -23,6 +23,7 @@
 
 #include <QtGlobal>
 #include <QDebug>
+#include <QThread>
 
 void crashTest(CameraControl* control)
 {
@@ -30,6 +31,16 @@ void crashTest(CameraControl* control)
         qDebug() << "Something is wrong, but at least it did not crash";
 }
 
+// Simulates a slow camera HAL: the environment variable holds the time in ms
+// the call takes, e.g. AAL_MOCK_CONNECT_LATENCY=300
+void fakeLatency(const char *variable)
+{
+    bool ok;
+    int latency = qgetenv(variable).toInt(&ok);
+    if (ok && latency > 0)
+        QThread::msleep(latency);
+}
+
 
 int android_camera_get_number_of_devices()
 {
@@ -39,14 +50,29 @@ int android_camera_get_number_of_devices()
 CameraControl* android_camera_connect_to(CameraType camera_type, CameraControlListener* listener)
 {    
     Q_UNUSED(camera_type);
+    fakeLatency("AAL_MOCK_CONNECT_LATENCY");
     CameraControl* cc = new CameraControl();
     cc->listener = listener;
     return cc;
 }
 
+CameraControl* android_camera_connect_by_id(int32_t camera_id, CameraControlListener* listener)
+{
+    return android_camera_connect_to(camera_id == 0 ? BACK_FACING_CAMERA_TYPE : FRONT_FACING_CAMERA_TYPE,
+                                     listener);
+}
+
+int android_camera_get_device_info(int32_t camera_id, int* facing, int* orientation)
+{
+    *facing = camera_id == 0 ? BACK_FACING_CAMERA_TYPE : FRONT_FACING_CAMERA_TYPE;
+    *orientation = 90;
+    return 0;
+}
+
 void android_camera_disconnect(CameraControl* control)
 {
     crashTest(control);
+    fakeLatency("AAL_MOCK_DISCONNECT_LATENCY");
 }
 
 int android_camera_lock(CameraControl* control)
@@ -100,6 +126,7 @@ void android_camera_enumerate_supported_scene_modes(CameraControl* control, scen
     Q_UNUSED(cb);
     Q_UNUSED(ctx);
     crashTest(control);
+    fakeLatency("AAL_MOCK_QUERY_LATENCY");
     cb(ctx, SCENE_MODE_ACTION);
 }
 
@@ -108,6 +135,7 @@ void android_camera_enumerate_supported_flash_modes(CameraControl* control, flas
     Q_UNUSED(cb);
     Q_UNUSED(ctx);
     crashTest(control);
+    fakeLatency("AAL_MOCK_QUERY_LATENCY");
     cb(ctx, FLASH_MODE_ON);
     cb(ctx, FLASH_MODE_AUTO);
     cb(ctx, FLASH_MODE_TORCH);
@@ -164,15 +192,16 @@ void android_camera_get_effect_mode(CameraControl* control, EffectMode* mode)
 
 void android_camera_get_preview_fps_range(CameraControl* control, int* min, int* max)
 {
-    Q_UNUSED(min);
-    Q_UNUSED(max);
     crashTest(control);
+    *min = 10000;
+    *max = 30000;
 }
 
 void android_camera_set_preview_fps(CameraControl* control, int fps)
 {
     Q_UNUSED(fps);
     crashTest(control);
+    fakeLatency("AAL_MOCK_PARAMETER_LATENCY");
 }
 
 void android_camera_get_preview_fps(CameraControl* control, int* fps)
@@ -183,16 +212,34 @@ void android_camera_get_preview_fps(CameraControl* control, int* fps)
 
 void android_camera_enumerate_supported_preview_sizes(CameraControl* control, size_callback cb, void* ctx)
 {
-    Q_UNUSED(cb);
-    Q_UNUSED(ctx);
     crashTest(control);
+    fakeLatency("AAL_MOCK_QUERY_LATENCY");
+    cb(ctx, 1920, 1080);
+    cb(ctx, 1280, 720);
+    cb(ctx, 640, 480);
 }
 
 void android_camera_enumerate_supported_picture_sizes(CameraControl* control, size_callback cb, void* ctx)
 {
-    Q_UNUSED(cb);
-    Q_UNUSED(ctx);
     crashTest(control);
+    fakeLatency("AAL_MOCK_QUERY_LATENCY");
+    cb(ctx, 3264, 2448);
+    cb(ctx, 1920, 1080);
+}
+
+void android_camera_enumerate_supported_thumbnail_sizes(CameraControl* control, size_callback cb, void* ctx)
+{
+    crashTest(control);
+    fakeLatency("AAL_MOCK_QUERY_LATENCY");
+    cb(ctx, 128, 96);
+}
+
+void android_camera_enumerate_supported_video_sizes(CameraControl* control, size_callback cb, void* ctx)
+{
+    crashTest(control);
+    fakeLatency("AAL_MOCK_QUERY_LATENCY");
+    cb(ctx, 1920, 1080);
+    cb(ctx, 1280, 720);
 }
 
 void android_camera_get_preview_size(CameraControl* control, int* width, int* height)
@@ -207,6 +254,7 @@ void android_camera_set_preview_size(CameraControl* control, int width, int heig
     Q_UNUSED(width);
     Q_UNUSED(height);
     crashTest(control);
+    fakeLatency("AAL_MOCK_PARAMETER_LATENCY");
 }
 
 void android_camera_get_picture_size(CameraControl* control, int* width, int* height)
@@ -221,6 +269,15 @@ void android_camera_set_picture_size(CameraControl* control, int width, int heig
     Q_UNUSED(width);
     Q_UNUSED(height);
     crashTest(control);
+    fakeLatency("AAL_MOCK_PARAMETER_LATENCY");
+}
+
+void android_camera_set_thumbnail_size(CameraControl* control, int width, int height)
+{
+    Q_UNUSED(width);
+    Q_UNUSED(height);
+    crashTest(control);
+    fakeLatency("AAL_MOCK_PARAMETER_LATENCY");
 }
 
 void android_camera_get_current_zoom(CameraControl* control, int* zoom)
@@ -261,11 +318,18 @@ void android_camera_set_preview_texture(CameraControl* control, int texture_id)
 void android_camera_start_preview(CameraControl* control)
 {
     crashTest(control);
+    fakeLatency("AAL_MOCK_START_PREVIEW_LATENCY");
+
+    // Deliver a first frame, like the HAL does once the preview runs
+    CameraControlListener* listener = control->listener;
+    if (listener && listener->on_preview_texture_needs_update_cb)
+        listener->on_preview_texture_needs_update_cb(listener->context);
 }
 
 void android_camera_stop_preview(CameraControl* control)
 {
     crashTest(control);
+    fakeLatency("AAL_MOCK_STOP_PREVIEW_LATENCY");
 }
 
 void android_camera_start_autofocus(CameraControl* control)
@@ -79,6 +79,10 @@ extern "C" {
 
     // Initializes a connection to the camera, returns NULL on error.
     CameraControl* android_camera_connect_to(CameraType camera_type, CameraControlListener* listener);
+    CameraControl* android_camera_connect_by_id(int32_t camera_id, CameraControlListener* listener);
+
+    // Gets the facing and the orientation of a camera device, returns 0 on success
+    int android_camera_get_device_info(int32_t camera_id, int* facing, int* orientation);
 
     // Disconnects the camera and deletes the pointer
     void android_camera_disconnect(CameraControl* control);
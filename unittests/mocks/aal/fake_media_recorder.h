@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FAKE_MEDIA_RECORDER_H
+#define FAKE_MEDIA_RECORDER_H
+
+#include <QByteArray>
+
+// What the fake media recorder saw during the last recording
+struct FakeRecorderStats
+{
+    qint64 bytesWritten;
+    int framesWritten;
+    int writeStalls;        // frames written later than their frame interval
+    qint64 maximumWriteTime; // ns
+    int audioBuffers;
+    int audioUnderruns;     // periods with less than a full buffer in the pipe
+};
+
+// By default the mock recorder only returns success; once enabled, it writes
+// a stream to the output file and reads the microphone FIFO while recording
+void setFakeRecorderEnabled(bool enabled);
+
+FakeRecorderStats fakeRecorderStats();
+
+// The FIFO the fake recorder reads microphone data from, instead of
+// /dev/socket/micshm; set AAL_MOCK_MIC_PIPE to change it
+QByteArray fakeMicPipePath();
+
+#endif // FAKE_MEDIA_RECORDER_H
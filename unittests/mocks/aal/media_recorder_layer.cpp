@@ -17,8 +17,215 @@
 
 #include "media_recorder_layer.h"
 #include "camera_control.h"
+#include "fake_media_recorder.h"
 
 #include <qglobal.h>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace {
+
+QMutex statsMutex;
+FakeRecorderStats lastStats;
+bool fakeRecorderEnabled = false;
+
+/*
+ * Writes a synthetic H.264 Annex B stream to the output file at the
+ * configured bitrate and frame rate, one frame per frame interval, like the
+ * encoder of a real recorder would. A time-lapse gets one frame per capture
+ * interval instead.
+ */
+class BitstreamWriter : public QThread
+{
+public:
+    BitstreamWriter(int fd, int bitrate, int frameRate, double captureRate)
+        : m_fd(fd), m_bitrate(bitrate), m_frameRate(frameRate), m_captureRate(captureRate), m_stop(false) {}
+
+    void stop() { m_stop = true; }
+
+    qint64 bytesWritten;
+    int framesWritten;
+    int writeStalls;
+    qint64 maximumWriteTime;
+
+protected:
+    void run()
+    {
+        bytesWritten = 0;
+        framesWritten = 0;
+        writeStalls = 0;
+        maximumWriteTime = 0;
+
+        const qint64 interval = 1000000000LL / (m_captureRate > 0 ? m_captureRate : m_frameRate);
+        QByteArray frame(qMax(5, m_bitrate / 8 / m_frameRate), 0);
+        quint32 seed = 1;
+
+        QElapsedTimer clock;
+        clock.start();
+        qint64 deadline = 0;
+        while (!m_stop) {
+            // Start code, then an IDR slice once per second and P slices otherwise
+            frame[3] = 1;
+            frame[4] = (framesWritten % m_frameRate == 0) ? 0x65 : 0x41;
+            for (int i = 5; i < frame.size(); ++i) {
+                seed = seed * 1103515245 + 12345;
+                frame[i] = char(seed >> 24);
+            }
+
+            QElapsedTimer writeTimer;
+            writeTimer.start();
+            const char *data = frame.constData();
+            int left = frame.size();
+            while (left > 0) {
+                ssize_t written = ::write(m_fd, data, left);
+                if (written < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    qWarning("Fake recorder: write failed: %s", strerror(errno));
+                    return;
+                }
+                data += written;
+                left -= written;
+            }
+            const qint64 writeTime = writeTimer.nsecsElapsed();
+            maximumWriteTime = qMax(maximumWriteTime, writeTime);
+            bytesWritten += frame.size();
+            ++framesWritten;
+
+            deadline += interval;
+            const qint64 now = clock.nsecsElapsed();
+            if (now > deadline) {
+                ++writeStalls;
+                deadline = now;
+            } else {
+                QThread::usleep((deadline - now) / 1000);
+            }
+        }
+    }
+
+private:
+    int m_fd;
+    int m_bitrate;
+    int m_frameRate;
+    double m_captureRate;
+    volatile bool m_stop;
+};
+
+/*
+ * Reads the microphone pipe one buffer per buffer period (48 kHz mono, 16 bit),
+ * like the audio source of a real recorder, and counts the periods for which
+ * the writer did not provide a full buffer
+ */
+class MicReader : public QThread
+{
+public:
+    MicReader(on_recorder_read_audio callback, void *context)
+        : m_callback(callback), m_context(context), m_stop(false) {}
+
+    void stop() { m_stop = true; }
+
+    int audioBuffers;
+    int audioUnderruns;
+
+protected:
+    void run()
+    {
+        audioBuffers = 0;
+        audioUnderruns = 0;
+
+        const QByteArray path = fakeMicPipePath();
+        ::unlink(path.constData());
+        if (::mkfifo(path.constData(), 0600) < 0) {
+            qWarning("Fake recorder: cannot create %s: %s", path.constData(), strerror(errno));
+            return;
+        }
+        int fd = ::open(path.constData(), O_RDONLY | O_NONBLOCK);
+        if (fd < 0) {
+            qWarning("Fake recorder: cannot open %s: %s", path.constData(), strerror(errno));
+            ::unlink(path.constData());
+            return;
+        }
+
+        // The reader side of the pipe is ready, the client can start writing
+        m_callback(m_context);
+
+        const qint64 period = 1000000000LL * MIC_READ_BUF_SIZE / 48000;
+        char buffer[MIC_READ_BUF_SIZE * sizeof(int16_t)];
+        int filled = 0;
+        bool started = false;
+
+        QElapsedTimer clock;
+        clock.start();
+        qint64 deadline = period;
+        while (!m_stop) {
+            qint64 now = clock.nsecsElapsed();
+            if (now < deadline && filled < int(sizeof(buffer))) {
+                struct pollfd pfd = { fd, POLLIN, 0 };
+                ::poll(&pfd, 1, qMax(qint64(1), (deadline - now) / 1000000));
+                ssize_t count = ::read(fd, buffer + filled, sizeof(buffer) - filled);
+                if (count > 0) {
+                    filled += count;
+                    started = true;
+                } else if (count == 0) {
+                    // No writer on the pipe, poll() does not wait then
+                    QThread::usleep(1000);
+                }
+                continue;
+            }
+            if (now < deadline) {
+                QThread::usleep((deadline - now) / 1000);
+                continue;
+            }
+
+            if (filled == int(sizeof(buffer))) {
+                ++audioBuffers;
+                filled = 0;
+            } else if (started) {
+                ++audioUnderruns;
+            }
+            deadline += period;
+        }
+
+        ::close(fd);
+        ::unlink(path.constData());
+    }
+
+private:
+    on_recorder_read_audio m_callback;
+    void *m_context;
+    volatile bool m_stop;
+};
+
+}
+
+void setFakeRecorderEnabled(bool enabled)
+{
+    QMutexLocker locker(&statsMutex);
+    fakeRecorderEnabled = enabled;
+}
+
+FakeRecorderStats fakeRecorderStats()
+{
+    QMutexLocker locker(&statsMutex);
+    return lastStats;
+}
+
+QByteArray fakeMicPipePath()
+{
+    QByteArray path = qgetenv("AAL_MOCK_MIC_PIPE");
+    if (path.isEmpty())
+        path = QDir::temp().filePath("aal-mock-micshm").toLocal8Bit();
+    return path;
+}
 
 class MediaRecorderListenerWrapper
 {
@@ -32,8 +239,59 @@ struct MediaRecorderWrapper
 {
 public:
     MediaRecorderWrapper()
+        : fd(-1),
+          hasAudio(false),
+          bitrate(0),
+          frameRate(30),
+          timeLapse(false),
+          captureRate(0),
+          readAudioCallback(0),
+          readAudioContext(0),
+          writer(0),
+          reader(0)
     {
     }
+
+    void stop()
+    {
+        if (!writer && !reader)
+            return;
+
+        FakeRecorderStats stats;
+        memset(&stats, 0, sizeof(stats));
+        if (writer) {
+            writer->stop();
+            writer->wait();
+            stats.bytesWritten = writer->bytesWritten;
+            stats.framesWritten = writer->framesWritten;
+            stats.writeStalls = writer->writeStalls;
+            stats.maximumWriteTime = writer->maximumWriteTime;
+            delete writer;
+            writer = 0;
+        }
+        if (reader) {
+            reader->stop();
+            reader->wait();
+            stats.audioBuffers = reader->audioBuffers;
+            stats.audioUnderruns = reader->audioUnderruns;
+            delete reader;
+            reader = 0;
+        }
+
+        QMutexLocker locker(&statsMutex);
+        lastStats = stats;
+    }
+
+    int fd;
+    bool hasAudio;
+    int bitrate;
+    int frameRate;
+    bool timeLapse;
+    double captureRate;
+    on_recorder_read_audio readAudioCallback;
+    void *readAudioContext;
+    BitstreamWriter *writer;
+    MicReader *reader;
 };
 
 void android_recorder_set_error_cb(MediaRecorderWrapper *mr, on_recorder_msg_error cb,
@@ -44,6 +302,13 @@ void android_recorder_set_error_cb(MediaRecorderWrapper *mr, on_recorder_msg_err
     Q_UNUSED(context);
 }
 
+void android_recorder_set_audio_read_cb(MediaRecorderWrapper *mr, on_recorder_read_audio cb,
+                                        void *context)
+{
+    mr->readAudioCallback = cb;
+    mr->readAudioContext = context;
+}
+
 MediaRecorderWrapper *android_media_new_recorder()
 {
     MediaRecorderWrapper *mr = new MediaRecorderWrapper;
@@ -72,8 +337,8 @@ int android_recorder_setVideoSource(MediaRecorderWrapper *mr, VideoSource vs)
 
 int android_recorder_setAudioSource(MediaRecorderWrapper *mr, AudioSource as)
 {
-    Q_UNUSED(mr);
     Q_UNUSED(as);
+    mr->hasAudio = true;
     return 0;
 }
 
@@ -100,8 +365,7 @@ int android_recorder_setAudioEncoder(MediaRecorderWrapper *mr, AudioEncoder ae)
 
 int android_recorder_setOutputFile(MediaRecorderWrapper *mr, int fd)
 {
-    Q_UNUSED(mr);
-    Q_UNUSED(fd);
+    mr->fd = fd;
     return 0;
 }
 
@@ -115,27 +379,53 @@ int android_recorder_setVideoSize(MediaRecorderWrapper *mr, int width, int heigh
 
 int android_recorder_setVideoFrameRate(MediaRecorderWrapper *mr, int frames_per_second)
 {
-    Q_UNUSED(mr);
-    Q_UNUSED(frames_per_second);
+    if (frames_per_second > 0)
+        mr->frameRate = frames_per_second;
     return 0;
 }
 
 int android_recorder_setParameters(MediaRecorderWrapper *mr, const char* parameters)
 {
-    Q_UNUSED(mr);
-    Q_UNUSED(parameters);
+    QByteArray parameter(parameters);
+    if (parameter.startsWith("video-param-encoding-bitrate="))
+        mr->bitrate = parameter.mid(parameter.indexOf('=') + 1).toInt();
+    else if (parameter.startsWith("time-lapse-enable="))
+        mr->timeLapse = parameter.mid(parameter.indexOf('=') + 1).toInt() != 0;
+    else if (parameter.startsWith("time-lapse-fps="))
+        mr->captureRate = parameter.mid(parameter.indexOf('=') + 1).toDouble();
     return 0;
 }
 
+// Only writes and reads anything once enabled with setFakeRecorderEnabled();
+// AAL_MOCK_RECORDER_BITRATE (bit/s) overrides the bitrate set by the client
 int android_recorder_start(MediaRecorderWrapper *mr)
 {
-    Q_UNUSED(mr);
+    if (mr->fd < 0)
+        return -1;
+
+    {
+        QMutexLocker locker(&statsMutex);
+        if (!fakeRecorderEnabled)
+            return 0;
+    }
+
+    bool ok;
+    int bitrate = qgetenv("AAL_MOCK_RECORDER_BITRATE").toInt(&ok);
+    if (!ok || bitrate <= 0)
+        bitrate = mr->bitrate > 0 ? mr->bitrate : 12000000;
+
+    mr->writer = new BitstreamWriter(mr->fd, bitrate, mr->frameRate, mr->timeLapse ? mr->captureRate : 0);
+    mr->writer->start();
+    if (mr->hasAudio && mr->readAudioCallback) {
+        mr->reader = new MicReader(mr->readAudioCallback, mr->readAudioContext);
+        mr->reader->start();
+    }
     return 0;
 }
 
 int android_recorder_stop(MediaRecorderWrapper *mr)
 {
-    Q_UNUSED(mr);
+    mr->stop();
     return 0;
 }
 
@@ -147,7 +437,9 @@ int android_recorder_prepare(MediaRecorderWrapper *mr)
 
 int android_recorder_reset(MediaRecorderWrapper *mr)
 {
-    Q_UNUSED(mr);
+    mr->stop();
+    mr->fd = -1;
+    mr->hasAudio = false;
     return 0;
 }
 
@@ -159,6 +451,7 @@ int android_recorder_close(MediaRecorderWrapper *mr)
 
 int android_recorder_release(MediaRecorderWrapper *mr)
 {
-    Q_UNUSED(mr);
+    mr->stop();
+    delete mr;
     return 0;
 }
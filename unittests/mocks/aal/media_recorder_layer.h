@@ -90,12 +90,18 @@ extern "C" {
         ANDROID_AUDIO_ENCODER_AAC_ELD = 5
     } AudioEncoder;
 
+    // Number of samples the recorder reads from the microphone pipe at a time
+    #define MIC_READ_BUF_SIZE 960
+
     // Callback types
     typedef void (*on_recorder_msg_error)(void *context);
+    typedef void (*on_recorder_read_audio)(void *context);
 
     // Callback setters
     void android_recorder_set_error_cb(MediaRecorderWrapper *mr, on_recorder_msg_error cb,
                                        void *context);
+    void android_recorder_set_audio_read_cb(MediaRecorderWrapper *mr, on_recorder_read_audio cb,
+                                            void *context);
 
     // Main recorder control API
     MediaRecorderWrapper *android_media_new_recorder();
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "audiocapture.h"
+#include "fake_media_recorder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QThread>
+
+/*
+ * Stands in for the PulseAudio reader: writes silence to the microphone pipe
+ * of the fake recorder at the pace a 48 kHz mono microphone delivers it. The
+ * latency is how late each buffer is written.
+ */
+
+AudioCapture::AudioCapture(MediaRecorderWrapper *mediaRecorder)
+    : m_mainloop(NULL),
+      m_context(NULL),
+      m_stream(NULL),
+      m_fragmentTime(0),
+      m_audioPipe(-1),
+      m_flagExit(false),
+      m_mediaRecorder(mediaRecorder),
+      m_latency(0),
+      m_maximumLatency(0),
+      m_underruns(0)
+{
+}
+
+AudioCapture::~AudioCapture()
+{
+    android_recorder_set_audio_read_cb(m_mediaRecorder, NULL, NULL);
+
+    if (m_audioPipe >= 0)
+        close(m_audioPipe);
+}
+
+bool AudioCapture::init(RecorderReadAudioCallback callback, void *context)
+{
+    android_recorder_set_audio_read_cb(m_mediaRecorder, callback, context);
+    return true;
+}
+
+int AudioCapture::setupMicrophoneStream(int sampleRate, int channelCount)
+{
+    Q_UNUSED(sampleRate);
+    Q_UNUSED(channelCount);
+    return 0;
+}
+
+void AudioCapture::stopCapture()
+{
+    m_flagExit = true;
+}
+
+void AudioCapture::run()
+{
+    m_flagExit = false;
+
+    m_audioPipe = open(fakeMicPipePath().constData(), O_WRONLY);
+    if (m_audioPipe < 0) {
+        qWarning() << "Failed to open the fake microphone pipe:" << strerror(errno);
+        return;
+    }
+
+    const qint64 period = 1000000000LL * MIC_READ_BUF_SIZE / 48000;
+    const QByteArray silence(MIC_READ_BUF_SIZE * sizeof(int16_t), 0);
+    QElapsedTimer clock;
+    clock.start();
+    qint64 deadline = 0;
+    while (!m_flagExit) {
+        if (write(m_audioPipe, silence.constData(), silence.size()) != silence.size())
+            break;
+
+        const qint64 now = clock.nsecsElapsed();
+        {
+            QMutexLocker locker(&m_latencyMutex);
+            m_latency = qMax(qint64(0), now - deadline) / 1000;
+            m_maximumLatency = qMax(m_maximumLatency, m_latency);
+        }
+
+        deadline += period;
+        if (now < deadline)
+            QThread::usleep((deadline - now) / 1000);
+    }
+}
+
+qint64 AudioCapture::latency() const
+{
+    QMutexLocker locker(&m_latencyMutex);
+    return m_latency;
+}
+
+qint64 AudioCapture::maximumLatency() const
+{
+    QMutexLocker locker(&m_latencyMutex);
+    return m_maximumLatency;
+}
+
+int AudioCapture::underruns() const
+{
+    QMutexLocker locker(&m_latencyMutex);
+    return m_underruns;
+}
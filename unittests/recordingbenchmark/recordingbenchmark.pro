@@ -0,0 +1,51 @@
+include(../../coverage.pri)
+
+TARGET = tst_recordingbenchmark
+
+QT += testlib concurrent multimedia opengl sensors
+
+LIBS += -L../mocks/aal -laal
+INCLUDEPATH += ../../src
+INCLUDEPATH += ../mocks/aal
+
+HEADERS += ../../src/aalmediarecordercontrol.h \
+    ../../src/aalaudioencodersettingscontrol.h \
+    ../../src/aalcameraservice.h \
+    ../../src/aalcameracontrol.h \
+    ../../src/cameraworker.h \
+    ../../src/halstatistics.h \
+    ../../src/startuptimeline.h \
+    ../../src/aalvideoencodersettingscontrol.h \
+    ../../src/aalmetadatawritercontrol.h \
+    ../../src/audiocapture.h \
+    ../../src/storagemanager.h \
+    ../../src/rotationhandler.h \
+    ../../src/tracebuffer.h \
+    ../../src/recordingwriter.h \
+    ../../src/segmentring.h \
+    ../../src/streamrelay.h \
+    ../../src/recordingtelemetry.h
+
+SOURCES += tst_recordingbenchmark.cpp \
+    audiocapture.cpp \
+    ../../src/aalmediarecordercontrol.cpp \
+    ../../src/aalaudioencodersettingscontrol.cpp \
+    ../../src/tracebuffer.cpp \
+    ../../src/recordingwriter.cpp \
+    ../../src/segmentring.cpp \
+    ../../src/streamrelay.cpp \
+    ../../src/recordingtelemetry.cpp \
+    ../stubs/aalcameraservice_stub.cpp \
+    ../stubs/aalcameracontrol_stub.cpp \
+    ../../src/cameraworker.cpp \
+    ../../src/halstatistics.cpp \
+    ../../src/startuptimeline.cpp \
+    ../stubs/aalvideoencodersettingscontrol_stub.cpp \
+    ../stubs/aalmetadatawritercontrol_stub.cpp \
+    ../stubs/storagemanager_stub.cpp \
+    ../stubs/rotationhandler_stub.cpp \
+    ../stubs/cameraproperties_stub.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QUrl>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include "aalcameraservice.h"
+#include "fake_media_recorder.h"
+
+#define private public
+#include "aalmediarecordercontrol.h"
+
+/*!
+ * \brief The LoadThread class keeps a core busy, or the disk, while recording
+ */
+class LoadThread : public QThread
+{
+public:
+    enum Kind { Cpu, Io };
+
+    LoadThread(Kind kind, const QString &fileName) : m_kind(kind), m_fileName(fileName), m_stop(false) {}
+
+    void stop() { m_stop = true; }
+
+protected:
+    void run()
+    {
+        if (m_kind == Cpu) {
+            volatile quint64 value = 1;
+            while (!m_stop)
+                value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+            return;
+        }
+
+        QFile file(m_fileName);
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+        const QByteArray chunk(1024 * 1024, 'x');
+        while (!m_stop) {
+            file.write(chunk);
+            file.flush();
+            fsync(file.handle());
+            if (file.size() > 64 * 1024 * 1024)
+                file.seek(0);
+        }
+    }
+
+private:
+    Kind m_kind;
+    QString m_fileName;
+    volatile bool m_stop;
+};
+
+class tst_RecordingBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void recording_data();
+    void recording();
+
+private:
+    QTemporaryDir m_directory;
+};
+
+void tst_RecordingBenchmark::initTestCase()
+{
+    // Loading the machine for several seconds does not belong in a normal test run
+    if (qEnvironmentVariableIsEmpty("AAL_RUN_BENCHMARKS"))
+        QSKIP("Set AAL_RUN_BENCHMARKS to run the recording benchmark");
+
+    QVERIFY(m_directory.isValid());
+    setFakeRecorderEnabled(true);
+
+    // The recorder stops reading the microphone pipe before the writer stops
+    signal(SIGPIPE, SIG_IGN);
+
+    if (qEnvironmentVariableIsEmpty("AAL_MOCK_MIC_PIPE"))
+        qputenv("AAL_MOCK_MIC_PIPE", m_directory.filePath("micshm").toLocal8Bit());
+}
+
+void tst_RecordingBenchmark::recording_data()
+{
+    QTest::addColumn<int>("kind");
+    QTest::addColumn<int>("threads");
+    QTest::addColumn<bool>("prewarm");
+
+    QTest::newRow("idle") << int(LoadThread::Cpu) << 0 << false;
+    QTest::newRow("cpu load") << int(LoadThread::Cpu) << QThread::idealThreadCount() * 2 << false;
+    QTest::newRow("io load") << int(LoadThread::Io) << 2 << false;
+    QTest::newRow("idle, pre-warmed") << int(LoadThread::Cpu) << 0 << true;
+    QTest::newRow("cpu load, pre-warmed") << int(LoadThread::Cpu) << QThread::idealThreadCount() * 2 << true;
+}
+
+/*!
+ * \brief tst_RecordingBenchmark::recording records for AAL_BENCHMARK_RECORDING_TIME
+ * ms (2000 by default) under load. It fails if starting and stopping the
+ * recording blocked the caller for more than AAL_BENCHMARK_LATENCY_BUDGET ms
+ * (200 by default), or if more than a tenth of the fake recorder's writes or
+ * of the microphone buffers fell behind.
+ */
+void tst_RecordingBenchmark::recording()
+{
+    QFETCH(int, kind);
+    QFETCH(int, threads);
+    QFETCH(bool, prewarm);
+
+    bool ok;
+    int recordingTime = qgetenv("AAL_BENCHMARK_RECORDING_TIME").toInt(&ok);
+    if (!ok || recordingTime <= 0)
+        recordingTime = 2000;
+    int latencyBudget = qgetenv("AAL_BENCHMARK_LATENCY_BUDGET").toInt(&ok);
+    if (!ok || latencyBudget <= 0)
+        latencyBudget = 200;
+
+    QList<LoadThread*> load;
+    for (int i = 0; i < threads; ++i) {
+        load << new LoadThread(LoadThread::Kind(kind), m_directory.filePath(QString("load%1").arg(i)));
+        load.last()->start();
+    }
+
+    AalCameraService service;
+    AalMediaRecorderControl recorder(&service);
+    service.connectCamera();
+    service.cameraControl()->setCaptureMode(QCamera::CaptureVideo);
+
+    QString fileName = m_directory.filePath("recording.mp4");
+    QFile::remove(fileName);
+    recorder.setOutputLocation(QUrl::fromLocalFile(fileName));
+    if (prewarm) {
+        recorder.m_prewarmEnabled = true;
+        recorder.prewarm();
+        QTRY_VERIFY(recorder.m_prewarmed);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    recorder.setState(QMediaRecorder::RecordingState);
+    const qint64 startLatency = timer.nsecsElapsed() / 1000;
+    QCOMPARE(recorder.status(), QMediaRecorder::RecordingStatus);
+
+    QTest::qWait(recordingTime);
+    const qint64 audioLatency = recorder.audioLatency();
+
+    timer.restart();
+    recorder.setState(QMediaRecorder::StoppedState);
+    const qint64 stopLatency = timer.nsecsElapsed() / 1000;
+    QTRY_COMPARE(recorder.status(), QMediaRecorder::UnloadedStatus);
+    const qint64 finalizeTime = timer.nsecsElapsed() / 1000;
+    recorder.releasePrewarmed();
+
+    Q_FOREACH (LoadThread *thread, load) {
+        thread->stop();
+        thread->wait();
+    }
+    qDeleteAll(load);
+
+    FakeRecorderStats stats = fakeRecorderStats();
+    qDebug().nospace() << "start " << startLatency << " us, stop " << stopLatency << " us (finalized after "
+                       << finalizeTime << " us), "
+                       << stats.framesWritten << " frames, " << stats.writeStalls << " write stalls (max write "
+                       << stats.maximumWriteTime / 1000 << " us), " << stats.audioBuffers << " audio buffers, "
+                       << stats.audioUnderruns << " audio underruns, audio latency " << audioLatency << " us";
+
+    QVERIFY(stats.framesWritten > 0);
+    QCOMPARE(QFileInfo(fileName).size(), stats.bytesWritten);
+    QVERIFY(stats.audioBuffers > 0);
+
+    QVERIFY2((startLatency + stopLatency) / 1000 <= latencyBudget,
+             qPrintable(QString("Starting and stopping blocked for %1 ms, the budget is %2 ms")
+                        .arg((startLatency + stopLatency) / 1000).arg(latencyBudget)));
+    QVERIFY2(stats.writeStalls * 10 <= stats.framesWritten,
+             qPrintable(QString("%1 of %2 frames were written late")
+                        .arg(stats.writeStalls).arg(stats.framesWritten)));
+    QVERIFY2(stats.audioUnderruns * 10 <= stats.audioBuffers,
+             qPrintable(QString("%1 of %2 audio buffers ran short")
+                        .arg(stats.audioUnderruns).arg(stats.audioBuffers)));
+
+    QTest::setBenchmarkResult((startLatency + stopLatency) / 1000.0, QTest::WalltimeMilliseconds);
+}
+
+QTEST_GUILESS_MAIN(tst_RecordingBenchmark)
+
+#include "tst_recordingbenchmark.moc"
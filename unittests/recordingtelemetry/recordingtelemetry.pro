@@ -0,0 +1,16 @@
+include(../../coverage.pri)
+
+TARGET = tst_recordingtelemetry
+
+QT += testlib
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/recordingtelemetry.h
+
+SOURCES += tst_recordingtelemetry.cpp \
+    ../../src/recordingtelemetry.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
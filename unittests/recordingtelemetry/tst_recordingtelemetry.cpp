@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+
+#include "recordingtelemetry.h"
+
+class tst_RecordingTelemetry : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void bitRate();
+    void audioShare();
+    void stall();
+    void restart();
+};
+
+void tst_RecordingTelemetry::bitRate()
+{
+    RecordingTelemetry telemetry;
+    telemetry.start(0, 0);
+    QCOMPARE(telemetry.bitRate(), 0);
+
+    telemetry.update(1000, 1000000);
+    QCOMPARE(telemetry.bytesWritten(), qint64(1000000));
+    QCOMPARE(telemetry.bitRate(), 8000000);
+    QCOMPARE(telemetry.videoBitRate(), 8000000);
+
+    // A late update does not inflate the bit rate
+    telemetry.update(3000, 2000000);
+    QCOMPARE(telemetry.bitRate(), 4000000);
+}
+
+void tst_RecordingTelemetry::audioShare()
+{
+    RecordingTelemetry telemetry;
+    telemetry.start(0, 48000);
+
+    telemetry.update(1000, 125000);
+    QCOMPARE(telemetry.bitRate(), 1000000);
+    QCOMPARE(telemetry.audioBitRate(), 48000);
+    QCOMPARE(telemetry.videoBitRate(), 952000);
+
+    // Nothing written, no bit rate for either
+    telemetry.update(2000, 125000);
+    QCOMPARE(telemetry.audioBitRate(), 0);
+    QCOMPARE(telemetry.videoBitRate(), 0);
+}
+
+void tst_RecordingTelemetry::stall()
+{
+    RecordingTelemetry telemetry;
+    telemetry.start(0, 0);
+
+    telemetry.update(1000, 1000);
+    QCOMPARE(telemetry.timeSinceLastWrite(), qint64(0));
+    telemetry.update(2000, 1000);
+    telemetry.update(3000, 1000);
+    QCOMPARE(telemetry.timeSinceLastWrite(), qint64(2000));
+
+    // The time of the last write is used when it is known
+    telemetry.update(4000, 1000, 2500);
+    QCOMPARE(telemetry.timeSinceLastWrite(), qint64(2500));
+}
+
+void tst_RecordingTelemetry::restart()
+{
+    RecordingTelemetry telemetry;
+    telemetry.start(0, 0);
+    telemetry.update(1000, 5000);
+
+    // A new loop recording segment starts from scratch
+    telemetry.start(60000, 0);
+    QCOMPARE(telemetry.bytesWritten(), qint64(0));
+    telemetry.update(61000, 1000);
+    QCOMPARE(telemetry.bitRate(), 8000);
+    QCOMPARE(telemetry.timeSinceLastWrite(), qint64(0));
+}
+
+QTEST_GUILESS_MAIN(tst_RecordingTelemetry)
+
+#include "tst_recordingtelemetry.moc"
@@ -0,0 +1,19 @@
+include(../../coverage.pri)
+
+TARGET = tst_recordingwriter
+
+QT += testlib
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/recordingwriter.h \
+    ../../src/tracebuffer.h
+
+SOURCES += tst_recordingwriter.cpp \
+    ../../src/recordingwriter.cpp \
+    ../../src/tracebuffer.cpp \
+    ../stubs/cameraproperties_stub.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
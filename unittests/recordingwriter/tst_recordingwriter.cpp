@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QTemporaryFile>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "recordingwriter.h"
+
+namespace {
+const qint64 CHUNK_SIZE = 64 * 1024;
+const qint64 PREALLOCATION = 1024 * 1024;
+}
+
+class tst_RecordingWriter : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void writeBack();
+    void preallocation();
+
+private:
+    qint64 allocatedBytes(int fd);
+    void write(int fd, qint64 size);
+};
+
+qint64 tst_RecordingWriter::allocatedBytes(int fd)
+{
+    struct stat info;
+    if (fstat(fd, &info) < 0)
+        return -1;
+    return qint64(info.st_blocks) * 512;
+}
+
+void tst_RecordingWriter::write(int fd, qint64 size)
+{
+    QByteArray data(4096, 'x');
+    for (qint64 written = 0; written < size; written += data.size())
+        QCOMPARE(::write(fd, data.constData(), data.size()), ssize_t(data.size()));
+}
+
+void tst_RecordingWriter::writeBack()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    RecordingWriter writer(file.handle(), CHUNK_SIZE, 0);
+    writer.start();
+
+    for (int i = 0; i < 8; ++i) {
+        write(file.handle(), 4 * CHUNK_SIZE);
+        QTest::qWait(60);
+    }
+    QTRY_COMPARE(writer.fileSize(), 32 * CHUNK_SIZE);
+    QVERIFY(writer.bufferedBytes() <= 2 * CHUNK_SIZE);
+
+    writer.finish();
+    QCOMPARE(writer.fileSize(), 32 * CHUNK_SIZE);
+    QCOMPARE(writer.bufferedBytes(), qint64(0));
+    QVERIFY(writer.maximumBufferedBytes() > 0);
+    QVERIFY(writer.stallTime() >= writer.maximumStall());
+    QCOMPARE(writer.preallocatedBytes(), qint64(0));
+
+    // Finishing twice is harmless
+    writer.finish();
+    QCOMPARE(file.size(), 32 * CHUNK_SIZE);
+}
+
+void tst_RecordingWriter::preallocation()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    RecordingWriter writer(file.handle(), CHUNK_SIZE, PREALLOCATION);
+    writer.start();
+
+    write(file.handle(), CHUNK_SIZE);
+    QTest::qWait(200);
+    if (writer.preallocatedBytes() == 0)
+        QSKIP("The file system does not support reserving space");
+
+    QVERIFY(writer.preallocatedBytes() >= PREALLOCATION / 2);
+    QVERIFY(allocatedBytes(file.handle()) >= CHUNK_SIZE + PREALLOCATION / 2);
+    // The reserved space is not part of the file
+    QCOMPARE(file.size(), CHUNK_SIZE);
+
+    writer.finish();
+    QCOMPARE(writer.preallocatedBytes(), qint64(0));
+    QCOMPARE(file.size(), CHUNK_SIZE);
+    QVERIFY(allocatedBytes(file.handle()) < CHUNK_SIZE + PREALLOCATION / 2);
+}
+
+QTEST_GUILESS_MAIN(tst_RecordingWriter)
+
+#include "tst_recordingwriter.moc"
@@ -0,0 +1,16 @@
+include(../../coverage.pri)
+
+TARGET = tst_segmentring
+
+QT += testlib
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/segmentring.h
+
+SOURCES += tst_segmentring.cpp \
+    ../../src/segmentring.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "segmentring.h"
+
+class tst_SegmentRing : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void names();
+    void continueNumbering();
+    void maxSegments();
+    void budget();
+    void discard();
+    void gaps();
+
+private:
+    QString addSegment(SegmentRing *ring, qint64 size, qint64 *freedSize = 0);
+};
+
+QString tst_SegmentRing::addSegment(SegmentRing *ring, qint64 size, qint64 *freedSize)
+{
+    qint64 freed;
+    QString segment = ring->nextSegment(&freed);
+    if (freedSize)
+        *freedSize = freed;
+
+    QFile file(segment);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        file.write(QByteArray(size, 'x'));
+    return segment;
+}
+
+void tst_SegmentRing::names()
+{
+    QTemporaryDir directory;
+    SegmentRing ring(directory.path() + "/video.mp4", 10, 0);
+
+    QCOMPARE(addSegment(&ring, 1), directory.path() + "/video_0001.mp4");
+    QCOMPARE(addSegment(&ring, 1), directory.path() + "/video_0002.mp4");
+    QCOMPARE(ring.segments().size(), 2);
+}
+
+void tst_SegmentRing::continueNumbering()
+{
+    QTemporaryDir directory;
+    QFile earlier(directory.path() + "/video_0007.mp4");
+    QVERIFY(earlier.open(QIODevice::WriteOnly));
+    earlier.write("earlier");
+    earlier.close();
+
+    // A new loop recording to the same place keeps the earlier segments
+    SegmentRing ring(directory.path() + "/video.mp4", 10, 0);
+    QCOMPARE(addSegment(&ring, 1), directory.path() + "/video_0008.mp4");
+    QCOMPARE(earlier.size(), qint64(7));
+    QCOMPARE(ring.segments().size(), 1);
+}
+
+void tst_SegmentRing::maxSegments()
+{
+    QTemporaryDir directory;
+    SegmentRing ring(directory.path() + "/video.mp4", 4, 0);
+
+    QStringList added;
+    for (int i = 0; i < 4; ++i)
+        added << addSegment(&ring, 1000);
+    QCOMPARE(ring.segments(), added);
+
+    // The oldest segment makes room for the new one
+    qint64 freedSize;
+    QString segment = addSegment(&ring, 10, &freedSize);
+    QCOMPARE(freedSize, qint64(1000));
+    QVERIFY(!QFile::exists(added.first()));
+    QCOMPARE(ring.segments(), added.mid(1) << segment);
+
+    // No fewer than MINIMUM_SEGMENTS are kept
+    SegmentRing small(directory.path() + "/small.mp4", 1, 0);
+    for (int i = 0; i < 5; ++i)
+        addSegment(&small, 1);
+    QCOMPARE(small.segments().size(), int(SegmentRing::MINIMUM_SEGMENTS));
+}
+
+void tst_SegmentRing::budget()
+{
+    QTemporaryDir directory;
+    SegmentRing ring(directory.path() + "/video.mp4", 100, 3500);
+
+    QString first = addSegment(&ring, 1000);
+    addSegment(&ring, 1000);
+    addSegment(&ring, 1000);
+    QCOMPARE(ring.segments().size(), 3);
+
+    // Another segment as large as the largest one would not fit
+    qint64 freedSize;
+    addSegment(&ring, 1000, &freedSize);
+    QCOMPARE(ring.segments().size(), 3);
+    QCOMPARE(freedSize, qint64(1000));
+    QVERIFY(!QFile::exists(first));
+    QVERIFY(ring.totalSize() <= 3500);
+}
+
+void tst_SegmentRing::discard()
+{
+    QTemporaryDir directory;
+    SegmentRing ring(directory.path() + "/video.mp4", 10, 0);
+
+    addSegment(&ring, 10);
+    QString segment = addSegment(&ring, 10);
+    ring.discard(segment);
+    QCOMPARE(ring.segments().size(), 1);
+    QVERIFY(!QFile::exists(segment));
+    QCOMPARE(ring.totalSize(), qint64(10));
+}
+
+void tst_SegmentRing::gaps()
+{
+    SegmentRing ring("/tmp/video.mp4", 10, 0);
+    QCOMPARE(ring.gapCount(), 0);
+    QCOMPARE(ring.averageGap(), qint64(0));
+
+    ring.recordGap(1000);
+    ring.recordGap(3000);
+    QCOMPARE(ring.gapCount(), 2);
+    QCOMPARE(ring.lastGap(), qint64(3000));
+    QCOMPARE(ring.maximumGap(), qint64(3000));
+    QCOMPARE(ring.averageGap(), qint64(2000));
+}
+
+QTEST_GUILESS_MAIN(tst_SegmentRing)
+
+#include "tst_segmentring.moc"
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QAbstractVideoSurface>
+#include <QCameraControl>
+#include <QMediaRecorderControl>
+#include <QMediaService>
+#include <QStandardPaths>
+#include <QVideoRendererControl>
+
+#include <qtubuntu_media_signals.h>
+
+#include "aalcameraservice.h"
+#include "aalcameraserviceplugin.h"
+#include "cameracapabilitycache.h"
+#include "startuptimeline.h"
+
+/*!
+ * \brief The FakeSurface class stands in for the QML video output: it creates
+ * a texture for the first frame, as qtvideo-node does
+ */
+class FakeSurface : public QAbstractVideoSurface
+{
+public:
+    QList<QVideoFrame::PixelFormat> supportedPixelFormats(QAbstractVideoBuffer::HandleType type) const
+    {
+        Q_UNUSED(type);
+        return QList<QVideoFrame::PixelFormat>() << QVideoFrame::Format_RGB32;
+    }
+
+    bool present(const QVideoFrame &frame)
+    {
+        if (frame.handle().toUInt() == 0) {
+            Q_EMIT SharedSignal::instance()->textureCreated(1);
+        }
+        return true;
+    }
+};
+
+class tst_StartupBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void coldStart();
+    void warmStart();
+    void lazyControls();
+
+private:
+    void startCamera();
+    void checkStartupTime();
+
+    qint64 m_startupTime;
+    qint64 m_startupBudget;
+};
+
+void tst_StartupBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    // Latencies in ms of a typical device HAL, unless given in the environment
+    if (qEnvironmentVariableIsEmpty("AAL_MOCK_CONNECT_LATENCY"))
+        qputenv("AAL_MOCK_CONNECT_LATENCY", "150");
+    if (qEnvironmentVariableIsEmpty("AAL_MOCK_QUERY_LATENCY"))
+        qputenv("AAL_MOCK_QUERY_LATENCY", "10");
+    if (qEnvironmentVariableIsEmpty("AAL_MOCK_PARAMETER_LATENCY"))
+        qputenv("AAL_MOCK_PARAMETER_LATENCY", "2");
+    if (qEnvironmentVariableIsEmpty("AAL_MOCK_START_PREVIEW_LATENCY"))
+        qputenv("AAL_MOCK_START_PREVIEW_LATENCY", "100");
+
+    // With these latencies a start takes about 400 ms, leave room for a
+    // loaded machine but catch anything that is serialized again
+    m_startupBudget = 1000;
+    if (!qEnvironmentVariableIsEmpty("AAL_STARTUP_BUDGET"))
+        m_startupBudget = qgetenv("AAL_STARTUP_BUDGET").toLongLong();
+}
+
+/*!
+ * \brief tst_StartupBenchmark::startCamera goes from creating the service to
+ * the first presented viewfinder frame
+ */
+void tst_StartupBenchmark::startCamera()
+{
+    m_startupTime = 0;
+    AalServicePlugin plugin;
+    FakeSurface surface;
+
+    QMediaService *service = plugin.create(Q_MEDIASERVICE_CAMERA);
+    QVideoRendererControl *renderer =
+        qobject_cast<QVideoRendererControl*>(service->requestControl(QVideoRendererControl_iid));
+    QCameraControl *camera =
+        qobject_cast<QCameraControl*>(service->requestControl(QCameraControl_iid));
+    renderer->setSurface(&surface);
+    camera->setState(QCamera::ActiveState);
+
+    QTRY_VERIFY_WITH_TIMEOUT(!StartupTimeline::isRunning(), 10000);
+    m_startupTime = StartupTimeline::totalTime() / 1000000;
+    qDebug().noquote() << StartupTimeline::report();
+
+    camera->setState(QCamera::UnloadedState);
+    plugin.release(service);
+}
+
+/*!
+ * \brief tst_StartupBenchmark::checkStartupTime fails if the last start took
+ * longer than the budget, in ms, given in AAL_STARTUP_BUDGET
+ */
+void tst_StartupBenchmark::checkStartupTime()
+{
+    QVERIFY(m_startupTime > 0);
+    QVERIFY2(m_startupTime <= m_startupBudget,
+             qPrintable(QString("The camera took %1 ms to start, the budget is %2 ms")
+                        .arg(m_startupTime).arg(m_startupBudget)));
+    QTest::setBenchmarkResult(m_startupTime, QTest::WalltimeMilliseconds);
+}
+
+void tst_StartupBenchmark::coldStart()
+{
+    CameraCapabilityCache cache;
+    cache.clear();
+
+    startCamera();
+    checkStartupTime();
+}
+
+void tst_StartupBenchmark::warmStart()
+{
+    startCamera();
+    checkStartupTime();
+}
+
+void tst_StartupBenchmark::lazyControls()
+{
+    AalCameraService service;
+    QCOMPARE(service.constructionTime(QMediaRecorderControl_iid), qint64(-1));
+
+    QMediaControl *control = service.requestControl(QMediaRecorderControl_iid);
+    QVERIFY(control != 0);
+    QVERIFY(service.constructionTime(QMediaRecorderControl_iid) >= 0);
+    QCOMPARE(service.requestControl(QMediaRecorderControl_iid), control);
+}
+
+QTEST_MAIN(tst_StartupBenchmark)
+
+#include "tst_startupbenchmark.moc"
@@ -7,10 +7,13 @@ QT += testlib
 CONFIG += link_pkgconfig
 PKGCONFIG += exiv2
 
-HEADERS += ../../src/storagemanager.h
+HEADERS += ../../src/storagemanager.h \
+    ../../src/tracebuffer.h
 
 SOURCES += tst_storagemanager.cpp \
-    ../../src/storagemanager.cpp
+    ../../src/storagemanager.cpp \
+    ../../src/tracebuffer.cpp \
+    ../stubs/cameraproperties_stub.cpp
 
 INCLUDEPATH += ../../src
 
@@ -0,0 +1,19 @@
+include(../../coverage.pri)
+
+TARGET = tst_streamrelay
+
+QT += testlib
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/streamrelay.h \
+    ../../src/tracebuffer.h
+
+SOURCES += tst_streamrelay.cpp \
+    ../../src/streamrelay.cpp \
+    ../../src/tracebuffer.cpp \
+    ../stubs/cameraproperties_stub.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "streamrelay.h"
+
+namespace {
+
+// TS packets with the sync byte, and a counter to tell them apart
+QByteArray packets(int count)
+{
+    QByteArray data;
+    for (int i = 0; i < count; ++i) {
+        QByteArray packet(StreamRelay::PACKET_SIZE, char(i));
+        packet[0] = 0x47;
+        data += packet;
+    }
+    return data;
+}
+
+bool writeAll(int fd, const QByteArray &data)
+{
+    const char *bytes = data.constData();
+    int left = data.size();
+    while (left > 0) {
+        ssize_t written = ::write(fd, bytes, left);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        bytes += written;
+        left -= written;
+    }
+    return true;
+}
+
+QByteArray readAvailable(int fd)
+{
+    QByteArray data;
+    char buffer[4096];
+    ssize_t size;
+    while ((size = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+        data.append(buffer, size);
+    return data;
+}
+
+void setNonBlocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+}
+
+class tst_StreamRelay : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void forward();
+    void dropWhenConsumerStalls();
+    void dropWhenTeeStalls();
+    void consumerGone();
+    void readerProcess();
+};
+
+void tst_StreamRelay::forward()
+{
+    int input[2];
+    int output[2];
+    QVERIFY(pipe(input) == 0);
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, output) == 0);
+    setNonBlocking(output[0]);
+    QTemporaryFile tee;
+    QVERIFY(tee.open());
+
+    StreamRelay *relay = new StreamRelay(input[0], output[0], dup(tee.handle()), 64 * 1024);
+    relay->start();
+
+    QByteArray data = packets(100);
+    QVERIFY(writeAll(input[1], data));
+    close(input[1]);
+    relay->wait();
+
+    QCOMPARE(relay->bytesReceived(), qint64(data.size()));
+    QCOMPARE(relay->bytesForwarded(), qint64(data.size()));
+    QCOMPARE(relay->bytesDropped(), qint64(0));
+    QCOMPARE(relay->dropEvents(), 0);
+    delete relay;
+
+    QCOMPARE(readAvailable(output[1]), data);
+    QCOMPARE(tee.readAll(), data);
+    close(output[1]);
+}
+
+void tst_StreamRelay::dropWhenConsumerStalls()
+{
+    int input[2];
+    int output[2];
+    QVERIFY(pipe(input) == 0);
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, output) == 0);
+    setNonBlocking(output[0]);
+    QTemporaryFile tee;
+    QVERIFY(tee.open());
+
+    StreamRelay *relay = new StreamRelay(input[0], output[0], dup(tee.handle()),
+                                         10 * StreamRelay::PACKET_SIZE);
+    relay->start();
+
+    // The consumer does not read; the writer must not be held up for long
+    QByteArray data = packets(20000);
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(writeAll(input[1], data));
+    close(input[1]);
+    relay->wait();
+    QVERIFY(timer.elapsed() < 5000);
+
+    QCOMPARE(relay->bytesReceived(), qint64(data.size()));
+    QVERIFY(relay->bytesDropped() > 0);
+    QVERIFY(relay->dropEvents() > 0);
+    QCOMPARE(relay->bytesForwarded() + relay->bytesDropped(), qint64(data.size()));
+    const qint64 forwarded = relay->bytesForwarded();
+    delete relay;
+
+    // The consumer gets whole packets only, in order
+    QByteArray received = readAvailable(output[1]);
+    QCOMPARE(qint64(received.size()), forwarded);
+    QCOMPARE(received.size() % StreamRelay::PACKET_SIZE, 0);
+    for (int i = 0; i < received.size(); i += StreamRelay::PACKET_SIZE)
+        QCOMPARE(received.at(i), char(0x47));
+
+    // The file gets everything
+    QCOMPARE(tee.readAll(), data);
+    close(output[1]);
+}
+
+void tst_StreamRelay::dropWhenTeeStalls()
+{
+    int input[2];
+    int output[2];
+    int tee[2];
+    QVERIFY(pipe(input) == 0);
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, output) == 0);
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, tee) == 0);
+    setNonBlocking(output[0]);
+
+    StreamRelay *relay = new StreamRelay(input[0], output[0], tee[0], 64 * 1024);
+    relay->start();
+
+    // Nothing reads the file side; the consumer must still get the stream
+    QByteArray data = packets(2 * StreamRelay::TEE_BUFFER_SIZE / StreamRelay::PACKET_SIZE);
+    QByteArray received;
+    const char *bytes = data.constData();
+    for (int left = data.size(); left > 0; ) {
+        const int size = qMin(left, 16 * StreamRelay::PACKET_SIZE);
+        QVERIFY(writeAll(input[1], QByteArray::fromRawData(bytes, size)));
+        bytes += size;
+        left -= size;
+        received += readAvailable(output[1]);
+    }
+    close(input[1]);
+
+    // Reading the file side lets the relay finish
+    QByteArray teed;
+    while (!relay->wait(10))
+        teed += readAvailable(tee[1]);
+    teed += readAvailable(tee[1]);
+    received += readAvailable(output[1]);
+
+    QVERIFY(relay->teeBytesDropped() > 0);
+    QCOMPARE(qint64(teed.size()) + relay->teeBytesDropped(), qint64(data.size()));
+    QCOMPARE(teed.size() % StreamRelay::PACKET_SIZE, 0);
+    for (int i = 0; i < teed.size(); i += StreamRelay::PACKET_SIZE)
+        QCOMPARE(teed.at(i), char(0x47));
+    QCOMPARE(qint64(received.size()), relay->bytesForwarded());
+    QCOMPARE(relay->bytesDropped(), qint64(0));
+    delete relay;
+
+    close(output[1]);
+    close(tee[1]);
+}
+
+void tst_StreamRelay::consumerGone()
+{
+    int input[2];
+    int output[2];
+    QVERIFY(pipe(input) == 0);
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, output) == 0);
+    setNonBlocking(output[0]);
+    close(output[1]);
+
+    StreamRelay relay(input[0], output[0], -1, 64 * 1024);
+    relay.start();
+
+    QByteArray data = packets(100);
+    QVERIFY(writeAll(input[1], data));
+    close(input[1]);
+    relay.wait();
+
+    QVERIFY(relay.consumerGone());
+    QCOMPARE(relay.bytesDropped(), qint64(data.size()));
+}
+
+void tst_StreamRelay::readerProcess()
+{
+    QTemporaryDir directory;
+    QByteArray fifo = QFile::encodeName(directory.path() + "/stream");
+    QVERIFY(mkfifo(fifo.constData(), 0600) == 0);
+
+    QProcess reader;
+    reader.start("cat", QStringList() << QFile::decodeName(fifo));
+    QVERIFY(reader.waitForStarted());
+
+    int output = open(fifo.constData(), O_WRONLY);
+    QVERIFY(output >= 0);
+    setNonBlocking(output);
+
+    int input[2];
+    QVERIFY(pipe(input) == 0);
+    StreamRelay *relay = new StreamRelay(input[0], output, -1, 1024 * 1024);
+    relay->start();
+
+    QByteArray data = packets(200);
+    QVERIFY(writeAll(input[1], data));
+    close(input[1]);
+    relay->wait();
+    QCOMPARE(relay->bytesDropped(), qint64(0));
+    // Closes the write end of the FIFO, the reader sees the end of the stream
+    delete relay;
+
+    QVERIFY(reader.waitForFinished());
+    QCOMPARE(reader.readAllStandardOutput(), data);
+}
+
+QTEST_GUILESS_MAIN(tst_StreamRelay)
+
+#include "tst_streamrelay.moc"
@@ -73,6 +73,10 @@ bool AalCameraControl::canChangeProperty(QCameraControl::PropertyChangeType chan
     return true;
 }
 
+void AalCameraControl::reconnect()
+{
+}
+
 void AalCameraControl::init(CameraControl *control, CameraControlListener *listener)
 {
     Q_UNUSED(control);
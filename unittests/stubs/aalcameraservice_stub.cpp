@@ -15,29 +15,43 @@
  */
 
 #include "aalcameraservice.h"
+#include "aalaudioencodersettingscontrol.h"
+#include "aalcameracontrol.h"
 #include "aalvideoencodersettingscontrol.h"
 #include "storagemanager.h"
 #include "rotationhandler.h"
+#include "cameraworker.h"
 
 #include "camera_control.h"
 
-AalCameraService *AalCameraService::m_service = 0;
-
 AalCameraService::AalCameraService(QObject *parent) :
     QMediaService(parent),
+    m_mediaRecorderControl(0),
     m_metadataWriter(0),
     m_androidControl(0),
     m_androidListener(0)
 {
+    m_cameraControl = new AalCameraControl(this);
     m_storageManager = new StorageManager;
+    m_audioEncoderControl = new AalAudioEncoderSettingsControl(this);
     m_videoEncoderControl = new AalVideoEncoderSettingsControl(this);
     m_rotationHandler = new RotationHandler(this);
+
+    m_cameraWorker = new CameraWorker;
+    m_cameraWorker->moveToThread(&m_cameraThread);
+    m_cameraThread.start();
 }
 
 AalCameraService::~AalCameraService()
 {
+    m_cameraWorker->waitForIdle();
+    m_cameraThread.quit();
+    m_cameraThread.wait();
+    delete m_cameraWorker;
+    delete m_cameraControl;
     delete m_storageManager;
     delete m_androidControl;
+    delete m_audioEncoderControl;
     delete m_videoEncoderControl;
     delete m_rotationHandler;
 }
@@ -53,6 +67,26 @@ void AalCameraService::releaseControl(QMediaControl *control)
     Q_UNUSED(control);
 }
 
+AalMediaRecorderControl *AalCameraService::mediaRecorderControl()
+{
+    return m_mediaRecorderControl;
+}
+
+AalMetaDataWriterControl *AalCameraService::metadataWriterControl()
+{
+    return m_metadataWriter;
+}
+
+AalAudioEncoderSettingsControl *AalCameraService::audioEncoderControl()
+{
+    return m_audioEncoderControl;
+}
+
+AalVideoEncoderSettingsControl *AalCameraService::videoEncoderControl()
+{
+    return m_videoEncoderControl;
+}
+
 CameraControl *AalCameraService::androidControl()
 {
     return m_androidControl;
@@ -94,6 +128,10 @@ bool AalCameraService::isBackCameraUsed() const
     return true;
 }
 
+void AalCameraService::ensureDeferredInit()
+{
+}
+
 void AalCameraService::updateCaptureReady()
 {
 }
@@ -72,3 +72,9 @@ float AalVideoEncoderSettingsControl::getAspectRatio() const
 void AalVideoEncoderSettingsControl::resetAllSettings()
 {
 }
+
+void AalVideoEncoderSettingsControl::lockViewfinderFrameRate(bool lock, qreal captureRate)
+{
+    Q_UNUSED(lock);
+    Q_UNUSED(captureRate);
+}
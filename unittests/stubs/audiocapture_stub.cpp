@@ -40,15 +40,28 @@ void AudioCapture::stopCapture()
 {
 }
 
-int AudioCapture::setupMicrophoneStream()
+int AudioCapture::setupMicrophoneStream(int sampleRate, int channelCount)
 {
+    Q_UNUSED(sampleRate);
+    Q_UNUSED(channelCount);
+    return 0;
 }
 
 void AudioCapture::run()
 {
 }
 
-int AudioCapture::readMicrophone()
+qint64 AudioCapture::latency() const
+{
+    return 0;
+}
+
+qint64 AudioCapture::maximumLatency() const
+{
+    return 0;
+}
+
+int AudioCapture::underruns() const
 {
     return 0;
 }
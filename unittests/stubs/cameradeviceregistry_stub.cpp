@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cameradeviceregistry.h"
+#include "qcamerainfodata.h"
+
+int CameraDeviceRegistry::count()
+{
+    return QCameraInfoData::availableDevices.size();
+}
+
+int CameraDeviceRegistry::indexOf(const QByteArray &deviceName)
+{
+    for (int i = 0; i < count(); ++i) {
+        if (QCameraInfoData::availableDevices.at(i).deviceID == QString::fromLatin1(deviceName))
+            return i;
+    }
+    return -1;
+}
+
+QByteArray CameraDeviceRegistry::deviceName(int index)
+{
+    return QCameraInfoData::availableDevices.value(index).deviceID.toLatin1();
+}
+
+QString CameraDeviceRegistry::description(int index)
+{
+    return QCameraInfoData::availableDevices.value(index).description;
+}
+
+QCamera::Position CameraDeviceRegistry::position(int index)
+{
+    return QCameraInfoData::availableDevices.value(index).position;
+}
+
+int CameraDeviceRegistry::orientation(int index)
+{
+    return QCameraInfoData::availableDevices.value(index).orientation;
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAMERAPROPERTIESDATA_H
+#define CAMERAPROPERTIESDATA_H
+
+#include <QHash>
+#include <QString>
+
+/*!
+ * \brief CameraPropertiesData holds the properties returned by the
+ * CameraProperties stub; properties not set there get their default value
+ */
+class CameraPropertiesData
+{
+public:
+    static QHash<QString, QString> values;
+};
+
+#endif // CAMERAPROPERTIESDATA_H
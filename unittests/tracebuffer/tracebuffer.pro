@@ -0,0 +1,17 @@
+include(../../coverage.pri)
+
+TARGET = tst_tracebuffer
+
+QT += testlib
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/tracebuffer.h
+
+SOURCES += tst_tracebuffer.cpp \
+    ../../src/tracebuffer.cpp \
+    ../stubs/cameraproperties_stub.cpp
+
+check.depends = $${TARGET}
+check.commands = ./$${TARGET}
+QMAKE_EXTRA_TARGETS += check
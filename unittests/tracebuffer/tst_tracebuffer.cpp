@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 UBports Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include "tracebuffer.h"
+
+class Worker : public QThread
+{
+public:
+    Worker(int count) : m_count(count) { setObjectName("worker"); }
+
+protected:
+    void run()
+    {
+        for (int i = 0; i < m_count; ++i) {
+            TraceScope trace("worker: step");
+        }
+    }
+
+private:
+    int m_count;
+};
+
+class tst_TraceBuffer : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void disabled();
+    void events();
+    void threads();
+    void wrapsAround();
+
+private:
+    QJsonArray dump(const QString &name);
+};
+
+QJsonArray tst_TraceBuffer::dump(const QString &name)
+{
+    QJsonDocument document = QJsonDocument::fromJson(TraceBuffer::toJson());
+    QJsonArray events;
+    Q_FOREACH (const QJsonValue &value, document.object().value("traceEvents").toArray()) {
+        if (value.toObject().value("name").toString() == name)
+            events.append(value);
+    }
+    return events;
+}
+
+void tst_TraceBuffer::init()
+{
+    TraceBuffer::clear();
+    TraceBuffer::setEnabled(true);
+}
+
+void tst_TraceBuffer::cleanup()
+{
+    TraceBuffer::setEnabled(false);
+}
+
+void tst_TraceBuffer::disabled()
+{
+    TraceBuffer::setEnabled(false);
+    TraceBuffer::instant("test: disabled");
+
+    QVERIFY(dump("test: disabled").isEmpty());
+}
+
+void tst_TraceBuffer::events()
+{
+    {
+        TraceScope trace("test: scope");
+        TraceBuffer::instant("test: instant");
+    }
+
+    QJsonArray scope = dump("test: scope");
+    QCOMPARE(scope.count(), 2);
+    QCOMPARE(scope.at(0).toObject().value("ph").toString(), QString("B"));
+    QCOMPARE(scope.at(1).toObject().value("ph").toString(), QString("E"));
+    QVERIFY(scope.at(0).toObject().value("ts").toDouble() <= scope.at(1).toObject().value("ts").toDouble());
+
+    QJsonArray instant = dump("test: instant");
+    QCOMPARE(instant.count(), 1);
+    QCOMPARE(instant.at(0).toObject().value("ph").toString(), QString("i"));
+    QCOMPARE(instant.at(0).toObject().value("tid"), scope.at(0).toObject().value("tid"));
+
+    TraceBuffer::clear();
+    QVERIFY(dump("test: scope").isEmpty());
+}
+
+void tst_TraceBuffer::threads()
+{
+    Worker worker(10);
+    worker.start();
+    worker.wait();
+    TraceBuffer::instant("test: main");
+
+    QJsonArray steps = dump("worker: step");
+    QCOMPARE(steps.count(), 20);
+    QJsonValue workerId = steps.at(0).toObject().value("tid");
+    QVERIFY(workerId != dump("test: main").at(0).toObject().value("tid"));
+
+    bool named = false;
+    Q_FOREACH (const QJsonValue &value, dump("thread_name")) {
+        QJsonObject object = value.toObject();
+        if (object.value("tid") == workerId)
+            named = object.value("args").toObject().value("name").toString() == "worker";
+    }
+    QVERIFY(named);
+}
+
+void tst_TraceBuffer::wrapsAround()
+{
+    // The stubbed properties keep the default of 8192 events per thread
+    for (int i = 0; i < 10000; ++i)
+        TraceBuffer::instant("test: wrap");
+
+    QCOMPARE(dump("test: wrap").count(), 8192);
+}
+
+QTEST_GUILESS_MAIN(tst_TraceBuffer)
+
+#include "tst_tracebuffer.moc"
@@ -2,12 +2,27 @@ include(../coverage.pri)
 TEMPLATE = subdirs
 SUBDIRS += \
     mocks \
+    aalaudioencodersettingscontrol \
     aalcameracontrol \
     aalcameraexposurecontrol \
     aalcameraflashcontrol \
     aalcamerafocuscontrol \
+    aalcameraservice \
     aalcamerazoomcontrol \
     aalmediarecordercontrol \
     aalvideodeviceselectorcontrol \
     aalviewfindersettingscontrol \
-    storagemanager
+    cameracapabilitycache \
+    cameradeviceregistry \
+    cameraworker \
+    framerategovernor \
+    haleventqueue \
+    halstatistics \
+    recordingbenchmark \
+    recordingtelemetry \
+    recordingwriter \
+    segmentring \
+    startupbenchmark \
+    storagemanager \
+    streamrelay \
+    tracebuffer